@@ -0,0 +1,78 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+// PuLP: Multi-Objective Multi-Constraint Partitioning Using Label Propagation
+//              Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions?  Contact  George M. Slota   (gmslota@sandia.gov)
+//                      Siva Rajamanickam (srajama@sandia.gov)
+//
+// *****************************************************************************
+//@HEADER
+*/
+#ifndef __csr_h__
+#define __csr_h__
+
+#include <stdint.h>
+
+// Binary CSR container written by graph2csr and read by pulp and xtrapulp.
+// All values are little-endian, every section starts on a CSR_ALIGN byte
+// boundary, and a start offset of 0 means the section is absent:
+//   offsets      (n+1) x uint64_t
+//   adjacencies  m x uint32_t or uint64_t (adj_bytes), 0-indexed
+//   vert weights n x num_vert_weights x int32_t, row-major per vertex
+//   edge weights m x int32_t
+// m counts adjacency entries, so each undirected edge is stored twice.
+// xtrapulp/0.3/io_pp.h repeats this header (88 bytes) and checks its size,
+// so change both together and bump CSR_VERSION.
+#define CSR_MAGIC "PULPCSR"
+#define CSR_VERSION 1
+#define CSR_ALIGN 64
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t adj_bytes;
+  uint64_t n;
+  uint64_t m;
+  uint64_t num_vert_weights;
+  uint64_t num_edge_weights;
+  uint64_t offsets_start;
+  uint64_t adjs_start;
+  uint64_t vert_weights_start;
+  uint64_t edge_weights_start;
+  uint64_t file_size;
+} csr_header_t;
+
+#endif
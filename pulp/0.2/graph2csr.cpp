@@ -0,0 +1,360 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+// PuLP: Multi-Objective Multi-Constraint Partitioning Using Label Propagation
+//              Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions?  Contact  George M. Slota   (gmslota@sandia.gov)
+//                      Siva Rajamanickam (srajama@sandia.gov)
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+
+using namespace std;
+
+#include <cstdlib>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <limits>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "csr.h"
+
+void print_usage(char** argv)
+{
+  printf("To run: %s [graphfile] [outfile] [-x]\n\n", argv[0]);
+  printf("Converts an adjacency list (METIS) graph of format 0, 1, 10, or 11\n");
+  printf("into the binary CSR container read by pulp and xtrapulp\n");
+  printf("Weights are stored as pulp reads them, the integer part of each\n");
+  printf("value; -x applies xtrapulp's text reader scaling instead\n");
+  exit(0);
+}
+
+void convert_err(const char* msg)
+{
+  fprintf(stderr, "Error: %s\n", msg);
+  exit(1);
+}
+
+inline bool is_blank(char c)
+{
+  return (c == ' ' || c == '\t' || c == '\r');
+}
+
+inline bool next_token(const char*& p, const char* end)
+{
+  while (p < end && is_blank(*p))
+    ++p;
+
+  return (p < end && *p != '\n');
+}
+
+inline void skip_token(const char*& p, const char* end)
+{
+  while (p < end && !is_blank(*p) && *p != '\n')
+    ++p;
+}
+
+inline uint64_t parse_uint(const char*& p, const char* end)
+{
+  uint64_t val = 0;
+  while (p < end && (uint8_t)(*p - '0') < 10)
+    val = val*10 + (uint64_t)(*p++ - '0');
+  skip_token(p, end);
+
+  return val;
+}
+
+// atoi() semantics, as pulp's text reader: optional sign, leading digits
+inline int32_t parse_int(const char*& p, const char* end)
+{
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  int64_t val = 0;
+  while (p < end && (uint8_t)(*p - '0') < 10)
+    val = val*10 + (int64_t)(*p++ - '0');
+  skip_token(p, end);
+
+  return (int32_t)(negative ? -val : val);
+}
+
+inline float parse_float(const char*& p, const char* end)
+{
+  char tok[64];
+  uint64_t len = 0;
+  while (p < end && !is_blank(*p) && *p != '\n' && len < 63)
+    tok[len++] = *p++;
+  tok[len] = '\0';
+  skip_token(p, end);
+
+  return (float)strtod(tok, NULL);
+}
+
+// With -x, the integer conversion xtrapulp applies to text input: integral
+// weights are kept as they are, anything else is scaled so the sum fits in
+// an int
+void scale_weights(uint64_t n, uint64_t num_weights,
+                   float* weights_in, int32_t* weights_out)
+{
+  const double INT_EPSILON = 1e-5;
+  const double max_weight_sum = double(numeric_limits<int>::max() / 8);
+
+  for (uint64_t j = 0; j < num_weights; ++j)
+  {
+    bool nonint = false;
+    double sum_weights = 0.0;
+    double max_weights = 0.0;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+      float fw = weights_in[i*num_weights + j];
+      if (!nonint && fabs((float)(int32_t)floor(fw + 0.5) - fw) > INT_EPSILON)
+        nonint = true;
+      sum_weights += fw;
+      if (fw > max_weights)
+        max_weights = fw;
+    }
+
+    double scale = 1.0;
+    if (nonint || max_weights <= INT_EPSILON || sum_weights > max_weight_sum)
+      if (sum_weights != 0.0)
+        scale = max_weight_sum / sum_weights;
+
+    for (uint64_t i = 0; i < n; ++i)
+      weights_out[i*num_weights + j] = 
+        (int32_t)ceil((double)weights_in[i*num_weights + j] * scale);
+  }
+}
+
+uint64_t align_up(uint64_t offset)
+{
+  return (offset + CSR_ALIGN - 1) / CSR_ALIGN * CSR_ALIGN;
+}
+
+void write_section(FILE* outfile, uint64_t start, const void* data, 
+                   uint64_t size)
+{
+  if (size == 0)
+    return;
+  if (fseeko(outfile, (off_t)start, SEEK_SET) != 0 ||
+      fwrite(data, 1, size, outfile) != size)
+    convert_err("unable to write output file");
+}
+
+int main(int argc, char** argv)
+{
+  setbuf(stdout, NULL);
+  if (argc < 3)
+    print_usage(argv);
+  bool xtrapulp_weights = (argc > 3 && strcmp(argv[3], "-x") == 0);
+
+  int fd = open(argv[1], O_RDONLY);
+  if (fd < 0)
+    convert_err("unable to open input file");
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+    convert_err("unable to stat input file");
+  uint64_t file_size = (uint64_t)st.st_size;
+  const char* buf = (const char*)mmap(NULL, file_size, PROT_READ, 
+                                      MAP_PRIVATE, fd, 0);
+  if (buf == MAP_FAILED)
+    convert_err("unable to map input file");
+  madvise((void*)buf, file_size, MADV_SEQUENTIAL);
+  close(fd);
+
+  const char* p = buf;
+  const char* end = buf + file_size;
+  const char* line_end = (const char*)memchr(p, '\n', file_size);
+  if (line_end == NULL)
+    line_end = end;
+
+  uint64_t n = 0;
+  uint64_t m_header = 0;
+  uint64_t format = 0;
+  uint64_t ncon = 0;
+  uint64_t* header_vals[4] = {&n, &m_header, &format, &ncon};
+  for (int i = 0; i < 4 && next_token(p, line_end); ++i)
+    *header_vals[i] = parse_uint(p, line_end);
+  p = line_end < end ? line_end + 1 : end;
+  printf("%lu %lu %lu %lu\n", n, m_header, format, ncon);
+
+  uint64_t num_vert_weights = 0;
+  uint64_t num_edge_weights = 0;
+  switch (format)
+  {
+    case  0: break;
+    case  1: num_edge_weights = 1; break;
+    case 10: num_vert_weights = ncon > 0 ? ncon : 1; break;
+    case 11: num_vert_weights = ncon > 0 ? ncon : 1; 
+             num_edge_weights = 1; break;
+    default:
+      fprintf(stderr, "Unknown format specification: '%lu'\n", format);
+      abort();
+  }
+
+  vector<uint64_t> offsets;
+  vector<uint64_t> adjs;
+  vector<int32_t> vert_weights;
+  vector<int32_t> edge_weights;
+  vector<float> edge_weights_in;
+  offsets.reserve(n+1);
+  adjs.reserve(m_header*2);
+  vert_weights.reserve(n*num_vert_weights);
+  if (xtrapulp_weights)
+    edge_weights_in.reserve(num_edge_weights > 0 ? m_header*2 : 0);
+  else
+    edge_weights.reserve(num_edge_weights > 0 ? m_header*2 : 0);
+
+  printf("Reading in %s ... ", argv[1]);
+  offsets.push_back(0);
+  while (p < end)
+  {
+    for (uint64_t w = 0; w < num_vert_weights; ++w)
+    {
+      int32_t weight = 0;
+      if (next_token(p, end))
+        weight = xtrapulp_weights ? (int32_t)parse_float(p, end) : 
+                                    parse_int(p, end);
+      vert_weights.push_back(weight);
+    }
+
+    while (next_token(p, end))
+    {
+      uint64_t dst = parse_uint(p, end);
+      if (dst == 0 || dst > n)
+        convert_err("adjacency out of range, vertex ids must be 1-indexed");
+      adjs.push_back(dst - 1);
+
+      if (num_edge_weights > 0 && xtrapulp_weights)
+        edge_weights_in.push_back(next_token(p, end) ? 
+                                  parse_float(p, end) : 1.0);
+      else if (num_edge_weights > 0)
+        edge_weights.push_back(next_token(p, end) ? parse_int(p, end) : 1);
+    }
+
+    offsets.push_back(adjs.size());
+    if (p < end)
+      ++p;
+  }
+  munmap((void*)buf, file_size);
+
+  uint64_t m = adjs.size();
+  if (offsets.size() != n+1)
+    convert_err("number of lines does not match the header vertex count");
+  if (m != m_header*2)
+    printf("(header m %lu, read %lu adjacencies) ", m_header, m);
+  printf("Done\n");
+
+  csr_header_t header;
+  memset(&header, 0, sizeof(csr_header_t));
+  memcpy(header.magic, CSR_MAGIC, sizeof(header.magic));
+  header.version = CSR_VERSION;
+  header.adj_bytes = n <= (uint64_t)UINT32_MAX ? 4 : 8;
+  header.n = n;
+  header.m = m;
+  header.num_vert_weights = num_vert_weights;
+  header.num_edge_weights = num_edge_weights;
+  header.offsets_start = align_up(sizeof(csr_header_t));
+  header.adjs_start = align_up(header.offsets_start + (n+1)*sizeof(uint64_t));
+  uint64_t next_start = align_up(header.adjs_start + m*header.adj_bytes);
+  if (num_vert_weights > 0)
+  {
+    header.vert_weights_start = next_start;
+    next_start = align_up(next_start + n*num_vert_weights*sizeof(int32_t));
+  }
+  if (num_edge_weights > 0)
+  {
+    header.edge_weights_start = next_start;
+    next_start = align_up(next_start + m*sizeof(int32_t));
+  }
+  header.file_size = next_start;
+
+  printf("Writing %s ... ", argv[2]);
+  FILE* outfile = fopen(argv[2], "wb");
+  if (outfile == NULL)
+    convert_err("unable to open output file");
+
+  write_section(outfile, 0, &header, sizeof(csr_header_t));
+  write_section(outfile, header.offsets_start, offsets.data(), 
+                (n+1)*sizeof(uint64_t));
+  vector<uint64_t>().swap(offsets);
+
+  if (header.adj_bytes == 4)
+  {
+    vector<uint32_t> adjs_32(adjs.begin(), adjs.end());
+    write_section(outfile, header.adjs_start, adjs_32.data(), 
+                  m*sizeof(uint32_t));
+  }
+  else
+    write_section(outfile, header.adjs_start, adjs.data(), m*sizeof(uint64_t));
+  vector<uint64_t>().swap(adjs);
+
+  if (num_vert_weights > 0 && xtrapulp_weights)
+  {
+    vector<float> weights_in(vert_weights.begin(), vert_weights.end());
+    scale_weights(n, num_vert_weights, weights_in.data(), vert_weights.data());
+  }
+  if (num_edge_weights > 0 && xtrapulp_weights)
+  {
+    edge_weights.resize(m);
+    scale_weights(m, 1, edge_weights_in.data(), edge_weights.data());
+  }
+  if (num_vert_weights > 0)
+    write_section(outfile, header.vert_weights_start, vert_weights.data(),
+                  n*num_vert_weights*sizeof(int32_t));
+  if (num_edge_weights > 0)
+    write_section(outfile, header.edge_weights_start, edge_weights.data(),
+                  m*sizeof(int32_t));
+
+  // pad out the last section so file_size matches the header
+  if (fflush(outfile) != 0 || 
+      ftruncate(fileno(outfile), (off_t)header.file_size) != 0)
+    convert_err("unable to write output file");
+  fclose(outfile);
+  printf("Done\n");
+  printf("n: %lu, m: %lu, vert weights: %lu, edge weights: %lu\n",
+         n, m, num_vert_weights, num_edge_weights);
+
+  return 0;
+}
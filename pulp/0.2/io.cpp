@@ -1,12 +1,85 @@
+// Reads the integer token at p with atoi semantics (optional sign, value of
+// the leading digits), skipping leading blanks but never past the end of the
+// line; returns the position after the whole token, so "1.5" reads as 1
+inline const char* parse_int(const char* p, const char* end, long& val)
+{
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  val = 0;
+  unsigned digit;
+  while (p < end && (digit = (unsigned)(*p - '0')) < 10)
+  {
+    val = val*10 + digit;
+    ++p;
+  }
+  if (negative)
+    val = -val;
+
+  while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+    ++p;
+
+  return p;
+}
+
+// Number of blank separated tokens in [p, end)
+inline long count_tokens(const char* p, const char* end)
+{
+  long count = 0;
+  bool in_token = false;
+  for (; p < end; ++p)
+  {
+    bool is_blank = (*p == ' ' || *p == '\t' || *p == '\r');
+    count += (!is_blank && !in_token);
+    in_token = !is_blank;
+  }
+
+  return count;
+}
 
+inline const char* line_end(const char* p, const char* end)
+{
+  const char* nl = (const char*)memchr(p, '\n', end - p);
+  return (nl == NULL) ? end : nl;
+}
+
+// Parses the adjacency lines of a METIS file in two parallel passes over a
+// private mapping: threads take byte ranges cut at line starts, count each
+// vertex's degree, and after a prefix sum fill the arrays in place
 void read_adj(char* filename, int& n, long& m,
   int*& out_array, long*& out_degree_list,
   bool has_vert_weights, bool has_edge_weights,
   int*& vertex_weights, int*& edge_weights, long& vertex_weights_sum)
 {
-  ifstream infile;
-  string line;
-  string val;
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+  {
+    fprintf(stderr, "Unable to open '%s'\n", filename);
+    abort();
+  }
+  struct stat st;
+  fstat(fd, &st);
+  size_t file_size = (size_t)st.st_size;
+
+  char* file_map = (char*)mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (file_map == MAP_FAILED)
+  {
+    fprintf(stderr, "Unable to map '%s'\n", filename);
+    abort();
+  }
+  madvise(file_map, file_size, MADV_SEQUENTIAL);
+
+  const char* file_end = file_map + file_size;
+  const char* body = line_end(file_map, file_end);
+  if (body < file_end) ++body;
 
   out_array = new int[m];
   out_degree_list = new long[n+1];
@@ -16,62 +89,138 @@ void read_adj(char* filename, int& n, long& m,
   else edge_weights = NULL;
   vertex_weights_sum = 0;
 
-#pragma omp parallel for
-  for (int i = 0; i < n+1; ++i)
-    out_degree_list[i] = 0;
+  int num_threads = omp_get_max_threads();
+  const char** chunk_starts = new const char*[num_threads+1];
+  long* thread_verts = new long[num_threads+1];
+  long* thread_edges = new long[num_threads+1];
+  long sum_weights = 0;
+  bool valid = true;
 
-  long count = 0;
-  int cur_vert = 0;
+#pragma omp parallel num_threads(num_threads) reduction(+:sum_weights)
+{
+  int tid = omp_get_thread_num();
+  size_t body_size = (size_t)(file_end - body);
+  const char* begin = body + (body_size * tid) / num_threads;
+  if (tid > 0 && begin < file_end && *(begin-1) != '\n')
+  {
+    begin = line_end(begin, file_end);
+    if (begin < file_end) ++begin;
+  }
+  chunk_starts[tid] = begin;
+  if (tid == 0)
+    chunk_starts[num_threads] = file_end;
 
-  infile.open(filename);
-  getline(infile, line);
+#pragma omp barrier
+
+  // Each thread owns the lines that start in its range
+  const char* end = chunk_starts[tid+1];
+  long num_lines = 0;
+  for (const char* p = begin; p < end; ++num_lines)
+  {
+    p = line_end(p, end);
+    if (p < end) ++p;
+  }
+  thread_verts[tid+1] = num_lines;
+
+#pragma omp barrier
+#pragma omp single
+{
+  thread_verts[0] = 0;
+  for (int t = 0; t < num_threads; ++t)
+    thread_verts[t+1] += thread_verts[t];
+  if (thread_verts[num_threads] != (long)n)
+    valid = false;
+}
 
-  while (getline(infile, line))
+  long vert_begin = thread_verts[tid];
+  long num_edges = 0;
+  if (valid)
   {
-    stringstream ss(line);
-    out_degree_list[cur_vert] = count;
-    if (has_vert_weights)
+    long v = vert_begin;
+    for (const char* p = begin; p < end; ++v)
     {
-      getline(ss, val, ' ');
-      vertex_weights[cur_vert] = atoi(val.c_str());
-      vertex_weights_sum += vertex_weights[cur_vert];
+      const char* eol = line_end(p, end);
+      long degree = count_tokens(p, eol);
+      if (has_vert_weights && degree > 0) --degree;
+      if (has_edge_weights) degree /= 2;
+      out_degree_list[v] = degree;
+      num_edges += degree;
+      p = (eol < end) ? eol + 1 : eol;
     }
-    else if (has_edge_weights)
+  }
+  thread_edges[tid+1] = num_edges;
+
+#pragma omp barrier
+#pragma omp single
+{
+  thread_edges[0] = 0;
+  for (int t = 0; t < num_threads; ++t)
+    thread_edges[t+1] += thread_edges[t];
+  if (thread_edges[num_threads] != m)
+    valid = false;
+  out_degree_list[n] = thread_edges[num_threads];
+}
+
+  if (valid)
+  {
+    long count = thread_edges[tid];
+    long vert_end = thread_verts[tid+1];
+    for (long v = vert_begin; v < vert_end; ++v)
     {
-      vertex_weights[cur_vert] = 1;
-      vertex_weights_sum += vertex_weights[cur_vert];
+      long degree = out_degree_list[v];
+      out_degree_list[v] = count;
+      count += degree;
     }
-    /*else
-    {
-      vertex_weights[cur_vert] = rand() % 10;
-      vertex_weights_sum += vertex_weights[cur_vert];
-    }*/
-    ++cur_vert;
 
-    while (getline(ss, val, ' '))
+    long v = vert_begin;
+    long e = thread_edges[tid];
+    long val = 0;
+    for (const char* p = begin; p < end; ++v)
     {
-      out_array[count] = atoi(val.c_str())-1;
-      if (has_edge_weights)
+      const char* eol = line_end(p, end);
+      long degree = (v+1 < vert_end ? out_degree_list[v+1] : 
+                     thread_edges[tid+1]) - out_degree_list[v];
+      if (has_vert_weights)
       {
-        getline(ss, val, ' ');
-        edge_weights[count] = atoi(val.c_str());
+        p = parse_int(p, eol, val);
+        vertex_weights[v] = (int)val;
+        sum_weights += val;
       }
-      else if (has_vert_weights)
+      else if (has_edge_weights)
       {
-        edge_weights[count] = 1;
+        vertex_weights[v] = 1;
+        sum_weights += 1;
       }
-      /*else
+
+      for (long i = 0; i < degree; ++i, ++e)
       {
-        edge_weights[count] = rand() % 10;
-      }*/
-      ++count;
+        p = parse_int(p, eol, val);
+        out_array[e] = (int)val - 1;
+        if (has_edge_weights)
+        {
+          p = parse_int(p, eol, val);
+          edge_weights[e] = (int)val;
+        }
+        else if (has_vert_weights)
+          edge_weights[e] = 1;
+      }
+      p = (eol < end) ? eol + 1 : eol;
     }
   }
-  out_degree_list[cur_vert] = count;
-  assert(cur_vert == n);
-  assert(count == m);
+} // end parallel
 
-  infile.close();  
+  munmap(file_map, file_size);
+  delete [] chunk_starts;
+  delete [] thread_verts;
+  delete [] thread_edges;
+
+  if (!valid)
+  {
+    fprintf(stderr, "Vertex or edge counts in '%s' do not match its header\n",
+      filename);
+    abort();
+  }
+  vertex_weights_sum = sum_weights;
 }
 
 void read_graph(char* filename, int& n, long& m,
@@ -107,6 +256,110 @@ void read_graph(char* filename, int& n, long& m,
 }
 
 
+bool is_csr_graph(char* filename)
+{
+  char magic[8];
+  memset(magic, 0, sizeof(magic));
+
+  FILE* infile = fopen(filename, "rb");
+  if (infile == NULL)
+    return false;
+  size_t count = fread(magic, 1, sizeof(magic), infile);
+  fclose(infile);
+
+  return (count == sizeof(magic) && 
+          memcmp(magic, CSR_MAGIC, sizeof(magic)) == 0);
+}
+
+// Maps a graph2csr container and points the graph arrays straight into the
+// mapping; only missing unit weights are allocated. Release with munmap on
+// csr_map rather than delete [] on out_array/out_degree_list.
+void read_csr(char* filename, int& n, long& m,
+  int*& out_array, long*& out_degree_list,
+  int*& vertex_weights, int*& edge_weights, long& vertex_weights_sum,
+  char*& csr_map, size_t& csr_map_size)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+  {
+    fprintf(stderr, "Unable to open '%s'\n", filename);
+    abort();
+  }
+  struct stat st;
+  fstat(fd, &st);
+  csr_map_size = (size_t)st.st_size;
+
+  csr_map = (char*)mmap(NULL, csr_map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (csr_map == MAP_FAILED || csr_map_size < sizeof(csr_header_t))
+  {
+    fprintf(stderr, "Unable to map '%s'\n", filename);
+    abort();
+  }
+  madvise(csr_map, csr_map_size, MADV_WILLNEED);
+
+  csr_header_t* header = (csr_header_t*)csr_map;
+  printf("%lu %lu %lu %lu\n", header->n, header->m, 
+    header->num_vert_weights, header->num_edge_weights);
+  if (header->version != CSR_VERSION || header->file_size > csr_map_size)
+  {
+    fprintf(stderr, "Unsupported or truncated CSR file version %u\n", 
+      header->version);
+    abort();
+  }
+  if (header->adj_bytes != sizeof(int) || sizeof(long) != sizeof(uint64_t) ||
+      header->n > (uint64_t)INT_MAX)
+  {
+    fprintf(stderr, "CSR file exceeds the 32-bit pulp graph storage\n");
+    abort();
+  }
+  if (header->num_vert_weights > 1 || header->num_edge_weights > 1)
+  {
+    fprintf(stderr, "Multiple vertex and edge weights are not supported\n");
+    abort();
+  }
+
+  n = (int)header->n;
+  m = (long)header->m;
+  out_degree_list = (long*)(csr_map + header->offsets_start);
+  out_array = (int*)(csr_map + header->adjs_start);
+
+  // Same unit weight rules as read_adj for formats 001 and 010
+  bool has_vert_weights = (header->vert_weights_start > 0);
+  bool has_edge_weights = (header->edge_weights_start > 0);
+  vertex_weights = NULL;
+  edge_weights = NULL;
+  vertex_weights_sum = 0;
+  if (has_vert_weights)
+    vertex_weights = (int*)(csr_map + header->vert_weights_start);
+  else if (has_edge_weights)
+  {
+    vertex_weights = new int[n];
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+      vertex_weights[i] = 1;
+  }
+  if (has_edge_weights)
+    edge_weights = (int*)(csr_map + header->edge_weights_start);
+  else if (has_vert_weights)
+  {
+    edge_weights = new int[m];
+#pragma omp parallel for
+    for (long i = 0; i < m; ++i)
+      edge_weights[i] = 1;
+  }
+
+  if (vertex_weights != NULL)
+  {
+    long sum = 0;
+#pragma omp parallel for reduction(+:sum)
+    for (int i = 0; i < n; ++i)
+      sum += vertex_weights[i];
+    vertex_weights_sum = sum;
+  }
+}
+
+
 void read_parts(char* filename, int num_verts, int* parts)
 {
   ifstream infile;
@@ -53,8 +53,15 @@ using namespace std;
 #include <string.h>
 #include <omp.h>
 #include <math.h>
+#include <limits.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "pulp.h"
+#include "csr.h"
 #include "io.cpp"
 
 void print_usage_full(char** argv)
@@ -107,6 +114,8 @@ int main(int argc, char** argv)
   int* vertex_weights = NULL;
   long vertex_weights_sum = 0;
   int* edge_weights;
+  char* csr_map = NULL;
+  size_t csr_map_size = 0;
   char* graph_name = strdup(argv[1]);
   char* num_parts_str = strdup(argv[2]);
   int num_parts = atoi(num_parts_str);
@@ -178,8 +187,13 @@ int main(int argc, char** argv)
 
   printf("Reading in %s ... ", graph_name);
   elt = timer();
-  read_graph(graph_name, n, m, out_array, out_degree_list, 
-             vertex_weights, edge_weights, vertex_weights_sum);
+  if (is_csr_graph(graph_name))
+    read_csr(graph_name, n, m, out_array, out_degree_list, 
+             vertex_weights, edge_weights, vertex_weights_sum,
+             csr_map, csr_map_size);
+  else
+    read_graph(graph_name, n, m, out_array, out_degree_list, 
+               vertex_weights, edge_weights, vertex_weights_sum);
   pulp_graph_t g = {n, m, out_array, out_degree_list, 
                     vertex_weights, edge_weights, vertex_weights_sum};
   elt = timer() - elt;
@@ -240,8 +254,13 @@ int main(int argc, char** argv)
   }
 
   delete [] parts;
-  delete [] out_array;
-  delete [] out_degree_list;
+  if (csr_map != NULL)
+    munmap(csr_map, csr_map_size);
+  else
+  {
+    delete [] out_array;
+    delete [] out_degree_list;
+  }
 
   return 0;
 }
@@ -48,8 +48,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 
 #include "comms.h"
+#include "fast_map.h"
 #include "util.h"
 
 extern int procid, nprocs;
@@ -61,8 +63,8 @@ void init_queue_data(dist_graph_t* g, queue_data_t* q)
 
   uint64_t queue_size = g->n_local + g->n_ghost;
   //q->queue = (uint64_t*)malloc(queue_size*sizeof(uint64_t));
-  q->queue_next = (uint64_t*)malloc(queue_size*sizeof(uint64_t));
-  q->queue_send = (uint64_t*)malloc(queue_size*sizeof(uint64_t));
+  q->queue_next = (lid_t*)malloc(queue_size*sizeof(lid_t));
+  q->queue_send = (lid_t*)malloc(queue_size*sizeof(lid_t));
   if (q->queue_next == NULL || q->queue_send == NULL)
     throw_err("init_queue_data(), unable to allocate resources\n", procid);
 
@@ -95,15 +97,54 @@ void init_comm_data(mpi_data_t* comm)
   comm->rdispls = (int32_t*)malloc(nprocs*sizeof(int32_t));
   comm->sdispls_cpy = (int32_t*)malloc(nprocs*sizeof(int32_t));
   comm->sdispls_temp = (uint64_t*)malloc(nprocs*sizeof(int64_t));
+  comm->rdispls_temp = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+  comm->sdispls_cpy_temp = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
 
   if (comm->sendcounts == NULL || comm->sendcounts_temp == NULL ||
       comm->recvcounts == NULL || comm->sdispls == NULL || 
-      comm->rdispls == NULL || comm->sdispls_cpy == NULL)
+      comm->rdispls == NULL || comm->sdispls_cpy == NULL ||
+      comm->recvcounts_temp == NULL || comm->sdispls_temp == NULL ||
+      comm->rdispls_temp == NULL || comm->sdispls_cpy_temp == NULL)
     throw_err("init_comm_data(), unable to allocate resources\n", procid);
 
   comm->total_recv = 0;
   comm->total_send = 0;
+  comm->wire_index_bytes = 8;
+  comm->wire_data_bytes = 4;
   comm->global_queue_size = 0;
+  comm->send_pool.data = NULL;
+  comm->send_pool.capacity = 0;
+  comm->recv_pool.data = NULL;
+  comm->recv_pool.capacity = 0;
+
+  comm->neighbor_comm = MPI_COMM_NULL;
+  comm->num_sources = 0;
+  comm->num_dests = 0;
+  comm->sources = NULL;
+  comm->dests = NULL;
+  comm->neighbor_sendcounts = NULL;
+  comm->boundary_offsets = NULL;
+  comm->boundary_tasks = NULL;
+  comm->boundary_slots = NULL;
+  comm->num_pending = 0;
+  comm->overlap = false;
+  comm->num_boundary = 0;
+  comm->sweep_verts = NULL;
+  comm->node_exchange = false;
+  comm->node_comm = MPI_COMM_NULL;
+  comm->leader_comm = MPI_COMM_NULL;
+  comm->task_nodes = NULL;
+  comm->node_segments = NULL;
+  comm->node_out_caps = NULL;
+  comm->node_cursors = NULL;
+  comm->node_send_pool.data = NULL;
+  comm->node_send_pool.capacity = 0;
+  comm->node_recv_pool.data = NULL;
+  comm->node_recv_pool.capacity = 0;
+  comm->rma_exchange = false;
+  comm->rma_win = MPI_WIN_NULL;
+  comm->rma_round = 0;
+  comm->rma_dest_info = NULL;
 
   if (debug) { printf("Task %d init_comm_data() success\n", procid); }
 }
@@ -120,6 +161,40 @@ void clear_comm_data(mpi_data_t* comm)
   free(comm->rdispls);
   free(comm->sdispls_cpy);
   free(comm->sdispls_temp);
+  free(comm->rdispls_temp);
+  free(comm->sdispls_cpy_temp);
+  clear_pool_buffer(&comm->send_pool);
+  clear_pool_buffer(&comm->recv_pool);
+
+  if (comm->neighbor_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&comm->neighbor_comm);
+  free(comm->sources);
+  free(comm->dests);
+  free(comm->neighbor_sendcounts);
+  free(comm->boundary_offsets);
+  free(comm->boundary_tasks);
+  free(comm->boundary_slots);
+  free(comm->sweep_verts);
+  if (comm->node_comm != MPI_COMM_NULL)
+  {
+    MPI_Win_unlock_all(comm->node_win);
+    MPI_Win_free(&comm->node_win);
+    MPI_Comm_free(&comm->node_comm);
+  }
+  if (comm->leader_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&comm->leader_comm);
+  free(comm->task_nodes);
+  free(comm->node_segments);
+  free(comm->node_out_caps);
+  free(comm->node_cursors);
+  clear_pool_buffer(&comm->node_send_pool);
+  clear_pool_buffer(&comm->node_recv_pool);
+  if (comm->rma_win != MPI_WIN_NULL)
+  {
+    MPI_Win_unlock_all(comm->rma_win);
+    MPI_Win_free(&comm->rma_win);
+  }
+  free(comm->rma_dest_info);
 
   if (debug) { printf("Task %d clear_comm_data() success\n", procid); }
 }
@@ -133,17 +208,103 @@ void clear_thread_queue_comm_data(mpi_data_t* comm)
   free(comm->sdispls_cpy);
 }
 
+void* reserve_pool_buffer(pool_buffer_t* pool, uint64_t size)
+{
+  if (size <= pool->capacity)
+    return pool->data;
+
+  uint64_t capacity = 2*pool->capacity;
+  if (capacity < size)
+    capacity = size;
+
+  free(pool->data);
+  pool->data = malloc(capacity);
+  if (pool->data == NULL)
+    throw_err("reserve_pool_buffer(), unable to allocate resources\n", procid);
+  pool->capacity = capacity;
+
+  return pool->data;
+}
+
+void clear_pool_buffer(pool_buffer_t* pool)
+{
+  free(pool->data);
+  pool->data = NULL;
+  pool->capacity = 0;
+}
+
+// Per-thread queue and comm buffers, kept between parallel regions from
+// init_comm_pools() to clear_comm_pools() and filled in by each
+// thread on its first use
+struct thread_buffers_t {
+  lid_t* thread_queue;
+  lid_t* thread_send;
+  uint64_t* sendcounts_thread;
+  uint64_t* sendbuf_vert_thread;
+  int32_t* sendbuf_data_thread;
+  int32_t* sendbuf_rank_thread;
+  uint64_t* thread_starts;
+};
+
+thread_buffers_t* thread_buffers = NULL;
+int32_t num_thread_buffers = 0;
+
+void init_comm_pools()
+{
+  num_thread_buffers = omp_get_max_threads();
+  thread_buffers = 
+    (thread_buffers_t*)calloc(num_thread_buffers, sizeof(thread_buffers_t));
+  if (thread_buffers == NULL)
+    throw_err("init_comm_pools(), unable to allocate resources\n", procid);
+}
+
+void clear_comm_pools(mpi_data_t* comm)
+{
+  for (int32_t t = 0; t < num_thread_buffers; ++t)
+  {
+    free(thread_buffers[t].thread_queue);
+    free(thread_buffers[t].thread_send);
+    free(thread_buffers[t].sendcounts_thread);
+    free(thread_buffers[t].sendbuf_vert_thread);
+    free(thread_buffers[t].sendbuf_data_thread);
+    free(thread_buffers[t].sendbuf_rank_thread);
+    free(thread_buffers[t].thread_starts);
+  }
+  free(thread_buffers);
+  thread_buffers = NULL;
+  num_thread_buffers = 0;
+
+  clear_pool_buffer(&comm->send_pool);
+  clear_pool_buffer(&comm->recv_pool);
+  clear_pool_buffer(&comm->node_send_pool);
+  clear_pool_buffer(&comm->node_recv_pool);
+}
+
 void init_thread_queue(thread_queue_t* tq)
 {
   //if (debug) { printf("Task %d init_thread_queue() start\n", procid); }
 
   tq->tid = omp_get_thread_num();
-  tq->thread_queue = (uint64_t*)malloc(THREAD_QUEUE_SIZE*sizeof(uint64_t));
-  tq->thread_send = (uint64_t*)malloc(THREAD_QUEUE_SIZE*sizeof(uint64_t));
+  tq->pooled = (tq->tid < num_thread_buffers);
+  if (tq->pooled)
+  {
+    thread_buffers_t* tb = &thread_buffers[tq->tid];
+    if (tb->thread_queue == NULL)
+    {
+      tb->thread_queue = (lid_t*)malloc(THREAD_QUEUE_SIZE*sizeof(lid_t));
+      tb->thread_send = (lid_t*)malloc(THREAD_QUEUE_SIZE*sizeof(lid_t));
+    }
+    tq->thread_queue = tb->thread_queue;
+    tq->thread_send = tb->thread_send;
+  }
+  else
+  {
+    tq->thread_queue = (lid_t*)malloc(THREAD_QUEUE_SIZE*sizeof(lid_t));
+    tq->thread_send = (lid_t*)malloc(THREAD_QUEUE_SIZE*sizeof(lid_t));
+  }
   if (tq->thread_queue == NULL || tq->thread_send == NULL)
     throw_err("init_thread_queue(), unable to allocate resources\n", procid, tq->tid);
 
-  tq->tid = omp_get_thread_num();
   tq->thread_queue_size = 0;
   tq->thread_send_size = 0;
 
@@ -152,6 +313,9 @@ void init_thread_queue(thread_queue_t* tq)
 
 void clear_thread_queue(thread_queue_t* tq)
 {  
+  if (tq->pooled)
+    return;
+
   free(tq->thread_queue);
   free(tq->thread_send);
 }
@@ -161,15 +325,39 @@ void init_thread_comm(thread_comm_t* tc)
   //if (debug2) { printf("Task %d init_thread_comm() start\n", procid); }
 
   tc->tid = omp_get_thread_num();
-  tc->v_to_rank = (bool*)malloc(nprocs*sizeof(bool));
-  tc->sendcounts_thread = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
-  tc->sendbuf_vert_thread = 
-    (uint64_t*)malloc(THREAD_QUEUE_SIZE*sizeof(uint64_t));
-  tc->sendbuf_data_thread = 
-    (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
-  tc->sendbuf_rank_thread = (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
-  tc->thread_starts = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
-  if (tc->v_to_rank == NULL || tc->sendcounts_thread == NULL || 
+  tc->pooled = (tc->tid < num_thread_buffers);
+  if (tc->pooled)
+  {
+    thread_buffers_t* tb = &thread_buffers[tc->tid];
+    if (tb->sendcounts_thread == NULL)
+    {
+      tb->sendcounts_thread = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+      tb->sendbuf_vert_thread = 
+        (uint64_t*)malloc(THREAD_QUEUE_SIZE*sizeof(uint64_t));
+      tb->sendbuf_data_thread = 
+        (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
+      tb->sendbuf_rank_thread = 
+        (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
+      tb->thread_starts = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+    }
+    tc->sendcounts_thread = tb->sendcounts_thread;
+    tc->sendbuf_vert_thread = tb->sendbuf_vert_thread;
+    tc->sendbuf_data_thread = tb->sendbuf_data_thread;
+    tc->sendbuf_rank_thread = tb->sendbuf_rank_thread;
+    tc->thread_starts = tb->thread_starts;
+  }
+  else
+  {
+    tc->sendcounts_thread = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+    tc->sendbuf_vert_thread = 
+      (uint64_t*)malloc(THREAD_QUEUE_SIZE*sizeof(uint64_t));
+    tc->sendbuf_data_thread = 
+      (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
+    tc->sendbuf_rank_thread = 
+      (int32_t*)malloc(THREAD_QUEUE_SIZE*sizeof(int32_t));
+    tc->thread_starts = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+  }
+  if (tc->sendcounts_thread == NULL || 
       tc->sendbuf_vert_thread == NULL || tc->sendbuf_data_thread == NULL || 
       tc->sendbuf_rank_thread == NULL || tc->thread_starts == NULL)
     throw_err("init_thread_comm(), unable to allocate resources\n", procid, tc->tid);
@@ -184,7 +372,9 @@ void init_thread_comm(thread_comm_t* tc)
 
 void clear_thread_comm(thread_comm_t* tc)
 {
-  free(tc->v_to_rank);
+  if (tc->pooled)
+    return;
+
   free(tc->sendcounts_thread);
   free(tc->sendbuf_vert_thread);
   free(tc->sendbuf_data_thread);
@@ -192,31 +382,924 @@ void clear_thread_comm(thread_comm_t* tc)
   free(tc->thread_starts);
 }
 
+// Only the plan's destinations are ever sent to, so counts and displacements
+// are kept for them alone
 void init_sendbuf_vid_data(mpi_data_t* comm)
 {
-  comm->sdispls_temp[0] = 0;
-  comm->total_send = comm->sendcounts_temp[0];
-  for (int32_t i = 1; i < nprocs; ++i)
+  comm->total_send = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
   {
-    comm->sdispls_temp[i] = comm->sdispls_temp[i-1] + comm->sendcounts_temp[i-1];
+    int32_t i = comm->dests[n];
+    comm->sdispls_temp[i] = comm->total_send;
     comm->total_send += comm->sendcounts_temp[i];
   }
 
   if (debug) printf("Task %d total_send %lu\n", procid, comm->total_send);
 
-  comm->sendbuf_vert = (uint64_t*)malloc(comm->total_send*sizeof(uint64_t));
-  comm->sendbuf_data = (int32_t*)malloc(comm->total_send*sizeof(int32_t));
-  if (comm->sendbuf_vert == NULL || comm->sendbuf_data == NULL)
-    throw_err("init_sendbuf_vid_data(), unable to allocate resources\n", procid);
+  comm->sendbuf_wire = (uint8_t*)reserve_pool_buffer(&comm->send_pool,
+    (comm->total_send+1)*wire_record_bytes(comm));
 }
 
 void clear_recvbuf_vid_data(mpi_data_t* comm)
 {
-  free(comm->recvbuf_vert);
-  free(comm->recvbuf_data);
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
+}
+
+// Element count of type as one derived datatype placed disp elements into
+// the buffer, built from 2^30 element blocks so no int count overflows
+MPI_Datatype large_type(uint64_t count, uint64_t disp, MPI_Datatype type)
+{
+  const uint64_t block_size = 1073741824;
+
+  MPI_Aint lb, extent;
+  MPI_Type_get_extent(type, &lb, &extent);
+
+  uint64_t num_blocks = count / block_size;
+  uint64_t remainder = count % block_size;
+
+  MPI_Datatype block_type, blocks_type, remainder_type, body_type;
+  MPI_Type_contiguous((int)block_size, type, &block_type);
+  MPI_Type_contiguous((int)num_blocks, block_type, &blocks_type);
+  MPI_Type_contiguous((int)remainder, type, &remainder_type);
+
+  int lengths[2] = {1, 1};
+  MPI_Aint displs[2] = {0, (MPI_Aint)(num_blocks*block_size)*extent};
+  MPI_Datatype types[2] = {blocks_type, remainder_type};
+  MPI_Type_create_struct(2, lengths, displs, types, &body_type);
+
+  MPI_Datatype placed_type;
+  MPI_Aint placed_disp = (MPI_Aint)disp*extent;
+  int placed_length = 1;
+  MPI_Type_create_struct(1, &placed_length, &placed_disp, &body_type, 
+                         &placed_type);
+  MPI_Type_commit(&placed_type);
+
+  MPI_Type_free(&block_type);
+  MPI_Type_free(&blocks_type);
+  MPI_Type_free(&remainder_type);
+  MPI_Type_free(&body_type);
+
+  return placed_type;
+}
+
+// For packed buffers, where no displacement exceeds the task's total count
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type)
+{
+  uint64_t task_size = 0;
+  for (int32_t i = 0; i < nprocs; ++i)
+    task_size += sendcounts[i] + recvcounts[i];
+
+  uint64_t global_size = 0;
+  MPI_Allreduce(&task_size, &global_size, 1, 
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+  return alltoallv_large(sendbuf, sendcounts, sdispls, 
+                         recvbuf, recvcounts, rdispls, type, global_size);
+}
+
+// global_size is any bound, the same on every task, on the counts and
+// displacements of all tasks; it decides which path all tasks take
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type, uint64_t global_size)
+{
+  return alltoallv_large(sendbuf, sendcounts, sdispls, 
+                         recvbuf, recvcounts, rdispls, type, global_size,
+                         MPI_COMM_WORLD);
+}
+
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type, uint64_t global_size, 
+                    MPI_Comm mpi_comm)
+{
+  int nprocs;
+  MPI_Comm_size(mpi_comm, &nprocs);
+
+  if (global_size <= (uint64_t)INT_MAX)
+  {
+    int* counts = (int*)malloc(4*nprocs*sizeof(int));
+    if (counts == NULL)
+      throw_err("alltoallv_large(), unable to allocate counts", procid);
+    int* sdispls_int = counts + nprocs;
+    int* recvcounts_int = counts + 2*nprocs;
+    int* rdispls_int = counts + 3*nprocs;
+    for (int32_t i = 0; i < nprocs; ++i)
+    {
+      counts[i] = (int)sendcounts[i];
+      sdispls_int[i] = (int)sdispls[i];
+      recvcounts_int[i] = (int)recvcounts[i];
+      rdispls_int[i] = (int)rdispls[i];
+    }
+
+    MPI_Alltoallv(sendbuf, counts, sdispls_int, type, 
+                  recvbuf, recvcounts_int, rdispls_int, type, 
+                  mpi_comm);
+    free(counts);
+
+    return 0;
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Count* counts = (MPI_Count*)malloc(2*nprocs*sizeof(MPI_Count));
+  MPI_Aint* displs = (MPI_Aint*)malloc(2*nprocs*sizeof(MPI_Aint));
+  if (counts == NULL || displs == NULL)
+    throw_err("alltoallv_large(), unable to allocate counts", procid);
+  for (int32_t i = 0; i < nprocs; ++i)
+  {
+    counts[i] = (MPI_Count)sendcounts[i];
+    counts[nprocs+i] = (MPI_Count)recvcounts[i];
+    displs[i] = (MPI_Aint)sdispls[i];
+    displs[nprocs+i] = (MPI_Aint)rdispls[i];
+  }
+
+  MPI_Alltoallv_c(sendbuf, counts, displs, type, 
+                  recvbuf, counts+nprocs, displs+nprocs, type, 
+                  mpi_comm);
+  free(counts);
+  free(displs);
+#else
+  // Without large-count collectives each peer's block becomes one derived
+  // datatype that carries its own 64-bit byte offset
+  int* ones = (int*)malloc(2*nprocs*sizeof(int));
+  int* zeros = ones + nprocs;
+  MPI_Datatype* types = (MPI_Datatype*)malloc(2*nprocs*sizeof(MPI_Datatype));
+  if (ones == NULL || types == NULL)
+    throw_err("alltoallv_large(), unable to allocate datatypes", procid);
+  for (int32_t i = 0; i < nprocs; ++i)
+  {
+    ones[i] = 1;
+    zeros[i] = 0;
+    types[i] = large_type(sendcounts[i], sdispls[i], type);
+    types[nprocs+i] = large_type(recvcounts[i], rdispls[i], type);
+  }
+
+  MPI_Alltoallw(sendbuf, ones, zeros, types, 
+                recvbuf, ones, zeros, types+nprocs, mpi_comm);
+
+  for (int32_t i = 0; i < 2*nprocs; ++i)
+    MPI_Type_free(&types[i]);
+  free(ones);
+  free(types);
+#endif
+
+  return 0;
+}
+
+// Neighbors are the tasks owning a vertex this task ghosts or ghosting one
+// of its vertices, found with one all-task exchange. Both directions use
+// the same list, so any ghost exchange can run over the topology.
+void init_neighbor_comm(dist_graph_t* g, mpi_data_t* comm)
+{
+  if (comm->neighbor_comm != MPI_COMM_NULL)
+    return;
+
+  if (debug) { printf("Task %d init_neighbor_comm() start\n", procid); }
 
+  int32_t* is_owner = (int32_t*)calloc(nprocs, sizeof(int32_t));
+  int32_t* is_ghoster = (int32_t*)malloc(nprocs*sizeof(int32_t));
+  if (is_owner == NULL || is_ghoster == NULL)
+    throw_err("init_neighbor_comm(), unable to allocate flags", procid);
+
+  for (uint64_t i = 0; i < g->n_ghost; ++i)
+    is_owner[g->ghost_tasks[i]] = 1;
+
+  MPI_Alltoall(is_owner, 1, MPI_INT32_T, 
+               is_ghoster, 1, MPI_INT32_T, MPI_COMM_WORLD);
+
+  int32_t num_neighbors = 0;
+  for (int32_t i = 0; i < nprocs; ++i)
+    if (is_owner[i] || is_ghoster[i])
+      ++num_neighbors;
+  comm->num_sources = num_neighbors;
+  comm->num_dests = num_neighbors;
+
+  // Sized at least one so no degree-zero list is passed as NULL
+  comm->sources = (int32_t*)malloc((num_neighbors+1)*sizeof(int32_t));
+  comm->dests = (int32_t*)malloc((num_neighbors+1)*sizeof(int32_t));
+  comm->neighbor_sendcounts = 
+    (uint64_t*)malloc((4*num_neighbors+1)*sizeof(uint64_t));
+  if (comm->sources == NULL || comm->dests == NULL || 
+      comm->neighbor_sendcounts == NULL)
+    throw_err("init_neighbor_comm(), unable to allocate neighbors", procid);
+  comm->neighbor_sdispls = comm->neighbor_sendcounts + num_neighbors;
+  comm->neighbor_recvcounts = comm->neighbor_sdispls + num_neighbors;
+  comm->neighbor_rdispls = comm->neighbor_recvcounts + num_neighbors;
+
+  num_neighbors = 0;
   for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts[i] = 0;
+  {
+    if (is_owner[i] || is_ghoster[i])
+    {
+      comm->sources[num_neighbors] = i;
+      comm->dests[num_neighbors++] = i;
+    }
+  }
+  free(is_owner);
+  free(is_ghoster);
+
+  MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD, 
+    comm->num_sources, comm->sources, MPI_UNWEIGHTED, 
+    comm->num_dests, comm->dests, MPI_UNWEIGHTED, 
+    MPI_INFO_NULL, 0, &comm->neighbor_comm);
+
+  init_exchange_plan(g, comm);
+
+  if (debug) 
+    printf("Task %d init_neighbor_comm() success, %d neighbors\n", 
+           procid, comm->num_dests);
+}
+
+// Every task sends each owner the (global id, ghost index) pairs of the
+// ghosts it holds for that owner. The owner resolves the ids once and keeps,
+// per local vertex, who to send its updates to and at which ghost index, so
+// later exchanges neither scan adjacencies for ranks nor hash on receipt.
+void init_exchange_plan(dist_graph_t* g, mpi_data_t* comm)
+{
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+    comm->sendcounts_temp[comm->dests[i]] = 0;
+  for (uint64_t i = 0; i < g->n_ghost; ++i)
+    comm->sendcounts_temp[g->ghost_tasks[i]] += 2;
+
+  uint64_t sum_send = 0;
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    comm->sdispls_temp[task] = sum_send;
+    comm->sdispls_cpy_temp[task] = sum_send;
+    sum_send += comm->sendcounts_temp[task];
+  }
+
+  uint64_t* requests = (uint64_t*)malloc((sum_send+1)*sizeof(uint64_t));
+  if (requests == NULL)
+    throw_err("init_exchange_plan(), unable to allocate requests", procid);
+  for (uint64_t i = 0; i < g->n_ghost; ++i)
+  {
+    uint64_t task = g->ghost_tasks[i];
+    requests[comm->sdispls_cpy_temp[task]++] = g->ghost_unmap[i];
+    requests[comm->sdispls_cpy_temp[task]++] = i;
+  }
+
+  uint64_t num_recv = exchange_neighbor_counts(comm);
+  uint64_t* recvbuf = (uint64_t*)malloc((num_recv+1)*sizeof(uint64_t));
+  if (recvbuf == NULL)
+    throw_err("init_exchange_plan(), unable to allocate requests", procid);
+
+  uint64_t global_size = sum_send;
+  MPI_Allreduce(MPI_IN_PLACE, &global_size, 1, 
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  neighbor_alltoallv_large(requests, recvbuf, 
+                           MPI_UINT64_T, global_size, comm);
+  free(requests);
+
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+    comm->sendcounts_temp[comm->dests[i]] = 0;
+
+  uint64_t num_entries = num_recv / 2;
+  comm->boundary_offsets = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
+  comm->boundary_tasks = (int32_t*)malloc((num_entries+1)*sizeof(int32_t));
+  comm->boundary_slots = (uint64_t*)malloc((num_entries+1)*sizeof(uint64_t));
+  uint64_t* cursor = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
+  if (comm->boundary_offsets == NULL || comm->boundary_tasks == NULL || 
+      comm->boundary_slots == NULL || cursor == NULL)
+    throw_err("init_exchange_plan(), unable to allocate plan", procid);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < g->n_local+1; ++i)
+    comm->boundary_offsets[i] = 0;
+
+  // Ids are replaced by local indexes in place, so they're resolved once
+#pragma omp parallel for
+  for (uint64_t i = 0; i < num_recv; i += 2)
+  {
+    if (i + 2*MAP_PREFETCH_DISTANCE < num_recv)
+      prefetch_value(g->map, recvbuf[i + 2*MAP_PREFETCH_DISTANCE]);
+    uint64_t index = get_value(g->map, recvbuf[i]);
+    assert(index < g->n_local);
+    recvbuf[i] = index;
+#pragma omp atomic
+    ++comm->boundary_offsets[index+1];
+  }
+
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    comm->boundary_offsets[i+1] += comm->boundary_offsets[i];
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    cursor[i] = comm->boundary_offsets[i];
+
+  for (int32_t n = 0; n < comm->num_sources; ++n)
+  {
+    uint64_t begin = comm->neighbor_rdispls[n];
+    uint64_t end = begin + comm->neighbor_recvcounts[n];
+    for (uint64_t i = begin; i < end; i += 2)
+    {
+      uint64_t entry = cursor[recvbuf[i]]++;
+      comm->boundary_tasks[entry] = comm->sources[n];
+      comm->boundary_slots[entry] = recvbuf[i+1];
+    }
+  }
+
+  free(recvbuf);
+  free(cursor);
+
+  // Ghost indexes go out in 32 bits unless some task has more ghosts
+  uint64_t max_ghosts = g->n_ghost;
+  MPI_Allreduce(MPI_IN_PLACE, &max_ghosts, 1, 
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+  comm->wire_index_bytes = (max_ghosts <= (uint64_t)UINT32_MAX) ? 4 : 8;
+}
+
+// Orders the local vertices boundary first for the overlapped sweeps, so
+// the boundary updates can be in flight while the interior is processed
+void init_sweep_order(dist_graph_t* g, mpi_data_t* comm)
+{
+  if (comm->sweep_verts != NULL)
+    return;
+
+  if (debug) { printf("Task %d init_sweep_order() start\n", procid); }
+
+  if (comm->neighbor_comm == MPI_COMM_NULL)
+    init_neighbor_comm(g, comm);
+
+  comm->sweep_verts = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
+  if (comm->sweep_verts == NULL)
+    throw_err("init_sweep_order(), unable to allocate order", procid);
+
+  uint64_t num_boundary = 0;
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    if (comm->boundary_offsets[i+1] > comm->boundary_offsets[i])
+      comm->sweep_verts[num_boundary++] = i;
+
+  uint64_t num_interior = num_boundary;
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    if (comm->boundary_offsets[i+1] == comm->boundary_offsets[i])
+      comm->sweep_verts[num_interior++] = i;
+
+  comm->num_boundary = num_boundary;
+
+  if (debug) 
+    printf("Task %d init_sweep_order() success, %lu boundary of %lu\n", 
+           procid, num_boundary, g->n_local);
+}
+
+// Gathers the destination counts and displacements from the per-task
+// sendcounts_temp and sdispls_temp, trades counts with the neighbors, and
+// returns the total to be received
+uint64_t exchange_neighbor_counts(mpi_data_t* comm)
+{
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    comm->neighbor_sendcounts[i] = comm->sendcounts_temp[comm->dests[i]];
+    comm->neighbor_sdispls[i] = comm->sdispls_temp[comm->dests[i]];
+  }
+
+  MPI_Neighbor_alltoall(comm->neighbor_sendcounts, 1, MPI_UINT64_T, 
+                        comm->neighbor_recvcounts, 1, MPI_UINT64_T, 
+                        comm->neighbor_comm);
+
+  uint64_t total_recv = 0;
+  for (int32_t i = 0; i < comm->num_sources; ++i)
+  {
+    comm->neighbor_rdispls[i] = total_recv;
+    total_recv += comm->neighbor_recvcounts[i];
+  }
+
+  return total_recv;
+}
+
+// Same paths as alltoallv_large(), over the neighbor topology with the
+// counts set up by exchange_neighbor_counts()
+int neighbor_alltoallv_large(void* sendbuf, void* recvbuf, 
+                             MPI_Datatype type, uint64_t global_size,
+                             mpi_data_t* comm)
+{
+  ineighbor_alltoallv_large(sendbuf, recvbuf, type, global_size, comm);
+  wait_neighbor_alltoallv(comm);
+
+  return 0;
+}
+
+// Nonblocking version, the count arrays are kept with the request in comm
+// until wait_neighbor_alltoallv() completes it
+int ineighbor_alltoallv_large(void* sendbuf, void* recvbuf, 
+                              MPI_Datatype type, uint64_t global_size,
+                              mpi_data_t* comm)
+{
+  if (comm->num_pending == MAX_PENDING_EXCHANGES)
+    throw_err("ineighbor_alltoallv_large(), too many pending exchanges", 
+              procid);
+
+  int32_t num_sources = comm->num_sources;
+  int32_t num_dests = comm->num_dests;
+  MPI_Request* request = &comm->pending_requests[comm->num_pending];
+
+  if (global_size <= (uint64_t)INT_MAX)
+  {
+    int* counts = (int*)malloc(2*(num_sources+num_dests+1)*sizeof(int));
+    if (counts == NULL)
+      throw_err("ineighbor_alltoallv_large(), unable to allocate counts", 
+                procid);
+    int* sdispls_int = counts + num_dests;
+    int* recvcounts_int = sdispls_int + num_dests;
+    int* rdispls_int = recvcounts_int + num_sources;
+    for (int32_t i = 0; i < num_dests; ++i)
+    {
+      counts[i] = (int)comm->neighbor_sendcounts[i];
+      sdispls_int[i] = (int)comm->neighbor_sdispls[i];
+    }
+    for (int32_t i = 0; i < num_sources; ++i)
+    {
+      recvcounts_int[i] = (int)comm->neighbor_recvcounts[i];
+      rdispls_int[i] = (int)comm->neighbor_rdispls[i];
+    }
+
+    MPI_Ineighbor_alltoallv(sendbuf, counts, sdispls_int, type, 
+                            recvbuf, recvcounts_int, rdispls_int, type, 
+                            comm->neighbor_comm, request);
+    comm->pending_counts[comm->num_pending++] = counts;
+
+    return 0;
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Count* counts = (MPI_Count*)malloc(
+    (num_sources+num_dests+1)*(sizeof(MPI_Count)+sizeof(MPI_Aint)));
+  if (counts == NULL)
+    throw_err("ineighbor_alltoallv_large(), unable to allocate counts", 
+              procid);
+  MPI_Aint* displs = (MPI_Aint*)(counts + num_sources+num_dests+1);
+  for (int32_t i = 0; i < num_dests; ++i)
+  {
+    counts[i] = (MPI_Count)comm->neighbor_sendcounts[i];
+    displs[i] = (MPI_Aint)comm->neighbor_sdispls[i];
+  }
+  for (int32_t i = 0; i < num_sources; ++i)
+  {
+    counts[num_dests+i] = (MPI_Count)comm->neighbor_recvcounts[i];
+    displs[num_dests+i] = (MPI_Aint)comm->neighbor_rdispls[i];
+  }
+
+  MPI_Ineighbor_alltoallv_c(sendbuf, counts, displs, type, 
+                            recvbuf, counts+num_dests, displs+num_dests, type,
+                            comm->neighbor_comm, request);
+  comm->pending_counts[comm->num_pending++] = counts;
+#else
+  MPI_Aint* zeros = (MPI_Aint*)malloc((num_sources+num_dests+1)*
+    (sizeof(MPI_Aint)+sizeof(MPI_Datatype)+sizeof(int)));
+  if (zeros == NULL)
+    throw_err("ineighbor_alltoallv_large(), unable to allocate datatypes", 
+              procid);
+  MPI_Datatype* types = (MPI_Datatype*)(zeros + num_sources+num_dests+1);
+  int* ones = (int*)(types + num_sources+num_dests+1);
+  for (int32_t i = 0; i < num_sources+num_dests; ++i)
+  {
+    ones[i] = 1;
+    zeros[i] = 0;
+  }
+  for (int32_t i = 0; i < num_dests; ++i)
+    types[i] = large_type(comm->neighbor_sendcounts[i], 
+                          comm->neighbor_sdispls[i], type);
+  for (int32_t i = 0; i < num_sources; ++i)
+    types[num_dests+i] = large_type(comm->neighbor_recvcounts[i], 
+                                    comm->neighbor_rdispls[i], type);
+
+  MPI_Ineighbor_alltoallw(sendbuf, ones, zeros, types, 
+                          recvbuf, ones+num_dests, zeros+num_dests, 
+                          types+num_dests, comm->neighbor_comm, request);
+
+  // Freed types stay valid for the pending operation
+  for (int32_t i = 0; i < num_sources+num_dests; ++i)
+    MPI_Type_free(&types[i]);
+  comm->pending_counts[comm->num_pending++] = zeros;
+#endif
+
+  return 0;
+}
+
+void wait_neighbor_alltoallv(mpi_data_t* comm)
+{
+  MPI_Waitall(comm->num_pending, comm->pending_requests, MPI_STATUSES_IGNORE);
+  for (int32_t i = 0; i < comm->num_pending; ++i)
+    free(comm->pending_counts[i]);
+  comm->num_pending = 0;
+}
+
+// Tasks sharing a node exchange ghost updates through one shared window.
+// Each task's segment holds a header of counts and displacements, an outbox
+// with the updates it sends, on-node ones first then off-node ones grouped
+// by destination node, and an inbox the node leader fills with the
+// off-node updates addressed to it. Each vertex is sent at most once per
+// exchange, so the plan entries bound the outbox and the ghosts the inbox.
+void init_node_comm(dist_graph_t* g, mpi_data_t* comm)
+{
+  if (comm->node_comm != MPI_COMM_NULL)
+    return;
+
+  if (debug) { printf("Task %d init_node_comm() start\n", procid); }
+
+  if (comm->neighbor_comm == MPI_COMM_NULL)
+    init_neighbor_comm(g, comm);
+
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, procid, 
+                      MPI_INFO_NULL, &comm->node_comm);
+  MPI_Comm_rank(comm->node_comm, &comm->node_rank);
+  MPI_Comm_size(comm->node_comm, &comm->node_size);
+  MPI_Comm_split(MPI_COMM_WORLD, comm->node_rank == 0 ? 0 : MPI_UNDEFINED, 
+                 procid, &comm->leader_comm);
+
+  int32_t node_info[2] = {0, 0};
+  if (comm->node_rank == 0)
+  {
+    MPI_Comm_rank(comm->leader_comm, &node_info[0]);
+    MPI_Comm_size(comm->leader_comm, &node_info[1]);
+  }
+  MPI_Bcast(node_info, 2, MPI_INT32_T, 0, comm->node_comm);
+  comm->node_id = node_info[0];
+  comm->num_nodes = node_info[1];
+
+  comm->task_nodes = (int32_t*)malloc(2*nprocs*sizeof(int32_t));
+  comm->node_segments = (uint64_t**)malloc(2*comm->node_size*sizeof(uint64_t*));
+  uint64_t* node_caps = (uint64_t*)malloc(2*comm->node_size*sizeof(uint64_t));
+  if (comm->task_nodes == NULL || comm->node_segments == NULL || 
+      node_caps == NULL)
+    throw_err("init_node_comm(), unable to allocate node data", procid);
+  comm->task_node_ranks = comm->task_nodes + nprocs;
+  comm->node_inboxes = comm->node_segments + comm->node_size;
+  comm->node_in_caps = node_caps + comm->node_size;
+
+  int32_t task_info[2] = {comm->node_id, comm->node_rank};
+  int32_t* all_info = (int32_t*)malloc(2*nprocs*sizeof(int32_t));
+  if (all_info == NULL)
+    throw_err("init_node_comm(), unable to allocate node data", procid);
+  MPI_Allgather(task_info, 2, MPI_INT32_T, 
+                all_info, 2, MPI_INT32_T, MPI_COMM_WORLD);
   for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  {
+    comm->task_nodes[i] = all_info[2*i];
+    comm->task_node_ranks[i] = all_info[2*i+1];
+  }
+  free(all_info);
+
+  uint64_t caps[2] = {comm->boundary_offsets[g->n_local], g->n_ghost};
+  uint64_t* all_caps = (uint64_t*)malloc(2*comm->node_size*sizeof(uint64_t));
+  if (all_caps == NULL)
+    throw_err("init_node_comm(), unable to allocate node data", procid);
+  MPI_Allgather(caps, 2, MPI_UINT64_T, 
+                all_caps, 2, MPI_UINT64_T, comm->node_comm);
+
+  comm->node_header_size = 2*(uint64_t)comm->node_size + 
+                           2*(uint64_t)comm->num_nodes + 1;
+  uint64_t segment_size = comm->node_header_size + 2*caps[0] + 2*caps[1];
+  uint64_t* segment = NULL;
+  MPI_Win_allocate_shared((MPI_Aint)(segment_size*sizeof(uint64_t)), 
+                          sizeof(uint64_t), MPI_INFO_NULL, comm->node_comm, 
+                          &segment, &comm->node_win);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, comm->node_win);
+
+  for (int32_t r = 0; r < comm->node_size; ++r)
+  {
+    MPI_Aint size;
+    int disp_unit;
+    MPI_Win_shared_query(comm->node_win, r, &size, &disp_unit, 
+                         &comm->node_segments[r]);
+    comm->node_inboxes[r] = comm->node_segments[r] + 
+      comm->node_header_size + 2*all_caps[2*r];
+    node_caps[r] = all_caps[2*r];
+    comm->node_in_caps[r] = all_caps[2*r+1];
+  }
+  comm->node_out_caps = node_caps;
+  free(all_caps);
+
+  comm->node_cursors = (uint64_t*)malloc(
+    (2*(uint64_t)comm->node_size + 5*(uint64_t)comm->num_nodes + 3)*
+    sizeof(uint64_t));
+  if (comm->node_cursors == NULL)
+    throw_err("init_node_comm(), unable to allocate node data", procid);
+  comm->node_counts = comm->node_cursors + comm->node_size+comm->num_nodes+1;
+  comm->node_inbox_counts = comm->node_counts + 4*comm->num_nodes+1;
+
+  if (debug) 
+    printf("Task %d init_node_comm() success, node %d of %d, rank %d of %d\n",
+           procid, comm->node_id, comm->num_nodes, 
+           comm->node_rank, comm->node_size);
+}
+
+// Makes stores to the shared window visible across the node
+void node_sync(mpi_data_t* comm)
+{
+  MPI_Win_sync(comm->node_win);
+  MPI_Barrier(comm->node_comm);
+  MPI_Win_sync(comm->node_win);
+}
+
+// Two-level version of the neighbor exchange for the packed send buffers.
+// On-node updates are read straight from the sender's outbox, off-node
+// ones are aggregated by the node leaders into one exchange among leaders.
+// Updates are stored as (ghost index, destination task << 32 | data).
+void exchange_vert_data_node(mpi_data_t* comm)
+{
+  int32_t node_size = comm->node_size;
+  int32_t num_nodes = comm->num_nodes;
+  uint64_t* header = comm->node_segments[comm->node_rank];
+  uint64_t* on_counts = header;
+  uint64_t* on_displs = on_counts + node_size;
+  uint64_t* off_counts = on_displs + node_size;
+  uint64_t* off_displs = off_counts + num_nodes;
+  uint64_t* outbox = header + comm->node_header_size;
+  uint64_t* cursors = comm->node_cursors;
+
+  // Readers of the previous exchange are done with this segment
+  node_sync(comm);
+
+  for (int32_t r = 0; r < node_size; ++r)
+    on_counts[r] = 0;
+  for (int32_t n = 0; n < num_nodes; ++n)
+    off_counts[n] = 0;
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    if (comm->task_nodes[task] == comm->node_id)
+      on_counts[comm->task_node_ranks[task]] += comm->sendcounts_temp[task];
+    else
+      off_counts[comm->task_nodes[task]] += comm->sendcounts_temp[task];
+  }
+
+  uint64_t num_out = 0;
+  for (int32_t r = 0; r < node_size; ++r)
+  {
+    on_displs[r] = num_out;
+    cursors[r] = num_out;
+    num_out += on_counts[r];
+  }
+  for (int32_t n = 0; n < num_nodes; ++n)
+  {
+    off_displs[n] = num_out;
+    cursors[node_size+n] = num_out;
+    num_out += off_counts[n];
+  }
+  if (num_out > comm->node_out_caps[comm->node_rank])
+    throw_err("exchange_vert_data_node(), outbox overflow", procid);
+
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    uint64_t* cursor = (comm->task_nodes[task] == comm->node_id) ?
+      &cursors[comm->task_node_ranks[task]] : 
+      &cursors[node_size+comm->task_nodes[task]];
+    uint64_t begin = comm->sdispls_temp[task];
+    uint64_t end = begin + comm->sendcounts_temp[task];
+    for (uint64_t j = begin; j < end; ++j)
+    {
+      uint64_t slot = (*cursor)++;
+      outbox[2*slot] = unpack_slot(comm, comm->sendbuf_wire, j);
+      outbox[2*slot+1] = ((uint64_t)task << 32) | 
+        (uint64_t)(uint32_t)unpack_data(comm, comm->sendbuf_wire, j);
+    }
+  }
+
+  node_sync(comm);
+  if (comm->node_rank == 0)
+    aggregate_node_updates(comm);
+  node_sync(comm);
+
+  uint64_t* inbox_count = off_displs + num_nodes;
+  comm->total_recv = *inbox_count;
+  for (int32_t r = 0; r < node_size; ++r)
+    comm->total_recv += comm->node_segments[r][comm->node_rank];
+
+  comm->recvbuf_wire = (uint8_t*)reserve_pool_buffer(&comm->recv_pool,
+    (comm->total_recv+1)*wire_record_bytes(comm));
+
+  uint64_t num_recv = 0;
+  for (int32_t r = 0; r < node_size; ++r)
+  {
+    uint64_t* peer = comm->node_segments[r];
+    uint64_t* peer_outbox = peer + comm->node_header_size;
+    uint64_t begin = peer[node_size + comm->node_rank];
+    uint64_t end = begin + peer[comm->node_rank];
+    for (uint64_t j = begin; j < end; ++j)
+      pack_update(comm, comm->recvbuf_wire, num_recv++, 
+                  peer_outbox[2*j], (int32_t)(uint32_t)peer_outbox[2*j+1]);
+  }
+
+  uint64_t* inbox = comm->node_inboxes[comm->node_rank];
+  for (uint64_t j = 0; j < *inbox_count; ++j)
+    pack_update(comm, comm->recvbuf_wire, num_recv++, 
+                inbox[2*j], (int32_t)(uint32_t)inbox[2*j+1]);
+}
+
+// Leader side, gathers the node's off-node updates from the outboxes by
+// destination node, trades them with the other leaders, and files the
+// received ones into the inboxes of their destination tasks
+void aggregate_node_updates(mpi_data_t* comm)
+{
+  int32_t node_size = comm->node_size;
+  int32_t num_nodes = comm->num_nodes;
+
+  uint64_t* counts = comm->node_counts;
+  uint64_t* inbox_counts = comm->node_inbox_counts;
+  uint64_t* displs = counts + num_nodes;
+  uint64_t* recv_counts = displs + num_nodes;
+  uint64_t* recv_displs = recv_counts + num_nodes;
+
+  // Counts are in uint64 units, two per update
+  uint64_t num_send = 0;
+  for (int32_t n = 0; n < num_nodes; ++n)
+  {
+    counts[n] = 0;
+    for (int32_t r = 0; r < node_size; ++r)
+      counts[n] += 2*comm->node_segments[r][2*node_size + n];
+    displs[n] = num_send;
+    num_send += counts[n];
+  }
+
+  uint64_t* sendbuf = (uint64_t*)reserve_pool_buffer(&comm->node_send_pool,
+    (num_send+1)*sizeof(uint64_t));
+  for (int32_t n = 0; n < num_nodes; ++n)
+  {
+    uint64_t offset = displs[n];
+    for (int32_t r = 0; r < node_size; ++r)
+    {
+      uint64_t* peer = comm->node_segments[r];
+      uint64_t* peer_outbox = peer + comm->node_header_size;
+      uint64_t begin = 2*peer[2*node_size + num_nodes + n];
+      uint64_t end = begin + 2*peer[2*node_size + n];
+      for (uint64_t j = begin; j < end; ++j)
+        sendbuf[offset++] = peer_outbox[j];
+    }
+  }
+
+  MPI_Alltoall(counts, 1, MPI_UINT64_T, 
+               recv_counts, 1, MPI_UINT64_T, comm->leader_comm);
+  uint64_t num_recv = 0;
+  for (int32_t n = 0; n < num_nodes; ++n)
+  {
+    recv_displs[n] = num_recv;
+    num_recv += recv_counts[n];
+  }
+
+  uint64_t* recvbuf = (uint64_t*)reserve_pool_buffer(&comm->node_recv_pool,
+    (num_recv+1)*sizeof(uint64_t));
+
+  uint64_t global_size = num_send + num_recv;
+  MPI_Allreduce(MPI_IN_PLACE, &global_size, 1, 
+                MPI_UINT64_T, MPI_MAX, comm->leader_comm);
+  alltoallv_large(sendbuf, counts, displs, recvbuf, recv_counts, recv_displs,
+                  MPI_UINT64_T, global_size, comm->leader_comm);
+
+  for (int32_t r = 0; r < node_size; ++r)
+    inbox_counts[r] = 0;
+  for (uint64_t j = 0; j < num_recv; j += 2)
+  {
+    int32_t task = (int32_t)(recvbuf[j+1] >> 32);
+    int32_t r = comm->task_node_ranks[task];
+    uint64_t slot = inbox_counts[r]++;
+    if (slot >= comm->node_in_caps[r])
+      throw_err("aggregate_node_updates(), inbox overflow", procid);
+    comm->node_inboxes[r][2*slot] = recvbuf[j];
+    comm->node_inboxes[r][2*slot+1] = recvbuf[j+1];
+  }
+  for (int32_t r = 0; r < node_size; ++r)
+    comm->node_segments[r][2*node_size + 2*num_nodes] = inbox_counts[r];
+}
+
+// Each task exposes a window of two inbox counts, one done counter per
+// source, and two inboxes of packed update records, used on alternate
+// rounds. Senders reserve inbox space with a fetch-and-add, put their
+// updates, and bump their done counter at the receiver; a task waits only
+// on its own sources, so no exchange needs a collective. A source can be at
+// most one round ahead, which the two inboxes absorb. Each vertex is sent
+// at most once per exchange, so an inbox holds at most n_ghost records.
+// Displacements are in bytes.
+void init_rma_comm(dist_graph_t* g, mpi_data_t* comm)
+{
+  if (comm->rma_win != MPI_WIN_NULL)
+    return;
+
+  if (debug) { printf("Task %d init_rma_comm() start\n", procid); }
+
+  if (comm->neighbor_comm == MPI_COMM_NULL)
+    init_neighbor_comm(g, comm);
+
+  int32_t num_sources = comm->num_sources;
+  int32_t num_dests = comm->num_dests;
+  comm->rma_capacity = g->n_ghost;
+  uint64_t window_size = (2 + num_sources)*sizeof(uint64_t) + 
+                         2*comm->rma_capacity*RMA_MAX_RECORD_BYTES;
+  MPI_Win_allocate((MPI_Aint)window_size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, 
+                   &comm->rma_base, &comm->rma_win);
+  for (uint64_t i = 0; i < 2 + (uint64_t)num_sources; ++i)
+    comm->rma_base[i] = 0;
+
+  // Every dest needs our capacity, source count, and its index among our
+  // sources; the topology is symmetric so sources and dests line up
+  uint64_t* info = (uint64_t*)malloc(3*(num_sources+1)*sizeof(uint64_t));
+  comm->rma_dest_info = (uint64_t*)malloc(4*(num_dests+1)*sizeof(uint64_t));
+  if (info == NULL || comm->rma_dest_info == NULL)
+    throw_err("init_rma_comm(), unable to allocate info", procid);
+  comm->rma_offsets = comm->rma_dest_info + 3*num_dests;
+  for (int32_t i = 0; i < num_sources; ++i)
+  {
+    info[3*i] = g->n_ghost;
+    info[3*i+1] = (uint64_t)num_sources;
+    info[3*i+2] = (uint64_t)i;
+  }
+  MPI_Neighbor_alltoall(info, 3, MPI_UINT64_T, 
+                        comm->rma_dest_info, 3, MPI_UINT64_T, 
+                        comm->neighbor_comm);
+  free(info);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Win_lock_all(0, comm->rma_win);
+
+  if (debug) { printf("Task %d init_rma_comm() success\n", procid); }
+}
+
+// Reserves space at each dest and puts the packed records straight from
+// the send buffer, leaving them in flight until exchange_vert_data_rma_end()
+void exchange_vert_data_rma_begin(mpi_data_t* comm)
+{
+  const uint64_t max_put = 1073741824;
+  uint64_t parity = (++comm->rma_round) & 1;
+  uint64_t record_bytes = wire_record_bytes(comm);
+
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    uint64_t count = comm->sendcounts_temp[task];
+    comm->rma_offsets[i] = 0;
+    if (count > 0)
+      MPI_Fetch_and_op(&count, &comm->rma_offsets[i], MPI_UINT64_T, task, 
+                       (MPI_Aint)(parity*sizeof(uint64_t)), MPI_SUM, 
+                       comm->rma_win);
+  }
+  MPI_Win_flush_all(comm->rma_win);
+
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    uint64_t count = comm->sendcounts_temp[task];
+    uint64_t* dest_info = &comm->rma_dest_info[3*i];
+    if (comm->rma_offsets[i] + count > dest_info[0])
+      throw_err("exchange_vert_data_rma_begin(), inbox overflow", procid);
+
+    uint8_t* records = 
+      comm->sendbuf_wire + comm->sdispls_temp[task]*record_bytes;
+    uint64_t disp = (2 + dest_info[1])*sizeof(uint64_t) + 
+                    parity*dest_info[0]*RMA_MAX_RECORD_BYTES + 
+                    comm->rma_offsets[i]*record_bytes;
+    uint64_t num_bytes = count*record_bytes;
+    for (uint64_t j = 0; j < num_bytes; j += max_put)
+    {
+      uint64_t put_size = (num_bytes - j < max_put) ? num_bytes - j : max_put;
+      MPI_Put(records + j, (int)put_size, MPI_BYTE, task, 
+              (MPI_Aint)(disp + j), (int)put_size, MPI_BYTE, comm->rma_win);
+    }
+  }
+}
+
+// Completes our puts, tells each dest this round is done, and waits until
+// every source has done the same before reading the inbox
+void exchange_vert_data_rma_end(mpi_data_t* comm)
+{
+  uint64_t parity = comm->rma_round & 1;
+  uint64_t one = 1;
+  uint64_t zero = 0;
+
+  MPI_Win_flush_all(comm->rma_win);
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+    MPI_Accumulate(&one, 1, MPI_UINT64_T, comm->dests[i], 
+                   (MPI_Aint)((2 + comm->rma_dest_info[3*i+2])*sizeof(uint64_t)),
+                   1, MPI_UINT64_T, MPI_SUM, comm->rma_win);
+  MPI_Win_flush_all(comm->rma_win);
+
+  for (int32_t i = 0; i < comm->num_sources; ++i)
+  {
+    uint64_t done = 0;
+    while (done < comm->rma_round)
+    {
+      MPI_Fetch_and_op(NULL, &done, MPI_UINT64_T, procid, 
+                       (MPI_Aint)((2 + i)*sizeof(uint64_t)), MPI_NO_OP, 
+                       comm->rma_win);
+      MPI_Win_flush(procid, comm->rma_win);
+    }
+  }
+
+  MPI_Fetch_and_op(&zero, &comm->total_recv, MPI_UINT64_T, procid, 
+                   (MPI_Aint)(parity*sizeof(uint64_t)), MPI_REPLACE, 
+                   comm->rma_win);
+  MPI_Win_flush(procid, comm->rma_win);
+  MPI_Win_sync(comm->rma_win);
+
+  uint64_t record_bytes = wire_record_bytes(comm);
+  comm->recvbuf_wire = (uint8_t*)reserve_pool_buffer(&comm->recv_pool,
+    (comm->total_recv+1)*record_bytes);
+
+  uint8_t* inbox = (uint8_t*)(comm->rma_base + 2 + comm->num_sources) + 
+                   parity*comm->rma_capacity*RMA_MAX_RECORD_BYTES;
+  memcpy(comm->recvbuf_wire, inbox, comm->total_recv*record_bytes);
 }
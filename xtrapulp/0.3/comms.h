@@ -51,6 +51,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include "xtrapulp.h"
@@ -59,8 +60,16 @@
 extern int procid, nprocs;
 extern bool verbose, debug, verify;
 
-#define MAX_SEND_SIZE 2147483648
 #define THREAD_QUEUE_SIZE 1024
+#define MAX_PENDING_EXCHANGES 4
+#define RMA_MAX_RECORD_BYTES 12
+
+// Buffer kept across exchanges for a whole partitioning call, grown
+// geometrically by reserve_pool_buffer()
+struct pool_buffer_t {
+  void* data;
+  uint64_t capacity;
+};
 
 struct mpi_data_t {
   int32_t* sendcounts;
@@ -71,21 +80,90 @@ struct mpi_data_t {
   int32_t* rdispls;
   int32_t* sdispls_cpy;
   uint64_t* sdispls_temp;
+  uint64_t* rdispls_temp;
+  uint64_t* sdispls_cpy_temp;
 
   uint64_t* sendbuf_vert;
-  int32_t* sendbuf_data;
-  uint64_t* recvbuf_vert;
-  int32_t* recvbuf_data;
+  uint8_t* sendbuf_wire;
+  uint8_t* recvbuf_wire;
+  pool_buffer_t send_pool;
+  pool_buffer_t recv_pool;
+
+  // Ghost updates travel as packed records of the receiver's ghost index
+  // and a data value, narrowed to widths every task agrees on
+  int32_t wire_index_bytes;
+  int32_t wire_data_bytes;
 
   uint64_t total_recv;
   uint64_t total_send;
   uint64_t global_queue_size;
+
+  // Tasks sharing ghosts with this one, as a distributed graph topology
+  // built from ghost_tasks on the first exchange
+  MPI_Comm neighbor_comm;
+  int32_t num_sources;
+  int32_t num_dests;
+  int32_t* sources;
+  int32_t* dests;
+  uint64_t* neighbor_sendcounts;
+  uint64_t* neighbor_sdispls;
+  uint64_t* neighbor_recvcounts;
+  uint64_t* neighbor_rdispls;
+
+  // Exchange plan, the tasks ghosting each local vertex in CSR form and
+  // the ghost index each of them holds it at
+  uint64_t* boundary_offsets;
+  int32_t* boundary_tasks;
+  uint64_t* boundary_slots;
+
+  // Nonblocking neighbor exchanges in flight and the counts they use
+  MPI_Request pending_requests[MAX_PENDING_EXCHANGES];
+  void* pending_counts[MAX_PENDING_EXCHANGES];
+  int32_t num_pending;
+
+  // Overlapped mode, local vertices swept boundary first then interior
+  bool overlap;
+  uint64_t num_boundary;
+  uint64_t* sweep_verts;
+
+  // Node-aware mode, see init_node_comm()
+  bool node_exchange;
+  MPI_Comm node_comm;
+  MPI_Comm leader_comm;
+  int32_t node_rank;
+  int32_t node_size;
+  int32_t node_id;
+  int32_t num_nodes;
+  int32_t* task_nodes;
+  int32_t* task_node_ranks;
+  MPI_Win node_win;
+  uint64_t node_header_size;
+  uint64_t** node_segments;
+  uint64_t** node_inboxes;
+  uint64_t* node_out_caps;
+  uint64_t* node_in_caps;
+  // Counts and cursors sized once per node layout, and the leader's
+  // aggregation buffers, reused across exchanges
+  uint64_t* node_cursors;
+  uint64_t* node_counts;
+  uint64_t* node_inbox_counts;
+  pool_buffer_t node_send_pool;
+  pool_buffer_t node_recv_pool;
+
+  // One-sided mode, see init_rma_comm()
+  bool rma_exchange;
+  MPI_Win rma_win;
+  uint64_t* rma_base;
+  uint64_t rma_round;
+  uint64_t rma_capacity;
+  uint64_t* rma_dest_info;
+  uint64_t* rma_offsets;
 };
 
 struct queue_data_t {
-  uint64_t* queue;
-  uint64_t* queue_next;
-  uint64_t* queue_send;
+  lid_t* queue;
+  lid_t* queue_next;
+  lid_t* queue_send;
 
   uint64_t queue_size;
   uint64_t next_size;
@@ -94,21 +172,22 @@ struct queue_data_t {
 
 struct thread_queue_t {
   int32_t tid;
-  uint64_t* thread_queue;
-  uint64_t* thread_send;
+  lid_t* thread_queue;
+  lid_t* thread_send;
   uint64_t thread_queue_size;
   uint64_t thread_send_size;
+  bool pooled;
 } ;
 
 struct thread_comm_t {
   int32_t tid;
-  bool* v_to_rank;
   uint64_t* sendcounts_thread;
   uint64_t* sendbuf_vert_thread;
   int32_t* sendbuf_data_thread ;
   int32_t* sendbuf_rank_thread;
   uint64_t* thread_starts;
   uint64_t thread_queue_size;
+  bool pooled;
 };
 
 void init_queue_data(dist_graph_t* g, queue_data_t* q);
@@ -116,6 +195,11 @@ void clear_queue_data(queue_data_t* q);
 void init_comm_data(mpi_data_t* comm);
 void clear_comm_data(mpi_data_t* comm);
 
+void* reserve_pool_buffer(pool_buffer_t* pool, uint64_t size);
+void clear_pool_buffer(pool_buffer_t* pool);
+void init_comm_pools();
+void clear_comm_pools(mpi_data_t* comm);
+
 void init_thread_queue(thread_queue_t* tq);
 void clear_thread_queue(thread_queue_t* tq);
 void init_thread_comm(thread_comm_t* tc);
@@ -124,14 +208,65 @@ void clear_thread_comm(thread_comm_t* tc);
 void init_sendbuf_vid_data(mpi_data_t* comm);
 void clear_recvbuf_vid_data(mpi_data_t* comm);
 
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type);
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type, uint64_t global_size);
+int alltoallv_large(void* sendbuf, uint64_t* sendcounts, uint64_t* sdispls,
+                    void* recvbuf, uint64_t* recvcounts, uint64_t* rdispls,
+                    MPI_Datatype type, uint64_t global_size, 
+                    MPI_Comm mpi_comm);
+
+void init_neighbor_comm(dist_graph_t* g, mpi_data_t* comm);
+void init_exchange_plan(dist_graph_t* g, mpi_data_t* comm);
+uint64_t exchange_neighbor_counts(mpi_data_t* comm);
+int neighbor_alltoallv_large(void* sendbuf, void* recvbuf, 
+                             MPI_Datatype type, uint64_t global_size,
+                             mpi_data_t* comm);
+int ineighbor_alltoallv_large(void* sendbuf, void* recvbuf, 
+                              MPI_Datatype type, uint64_t global_size,
+                              mpi_data_t* comm);
+void wait_neighbor_alltoallv(mpi_data_t* comm);
+void init_sweep_order(dist_graph_t* g, mpi_data_t* comm);
+
+void init_node_comm(dist_graph_t* g, mpi_data_t* comm);
+void node_sync(mpi_data_t* comm);
+void exchange_vert_data_node(mpi_data_t* comm);
+void aggregate_node_updates(mpi_data_t* comm);
+
+void init_rma_comm(dist_graph_t* g, mpi_data_t* comm);
+void exchange_vert_data_rma_begin(mpi_data_t* comm);
+void exchange_vert_data_rma_end(mpi_data_t* comm);
+
 
 inline void exchange_verts(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q);
 inline void exchange_vert_data(dist_graph_t* g, mpi_data_t* comm, 
                                queue_data_t* q);
+inline void exchange_vert_data_begin(dist_graph_t* g, mpi_data_t* comm, 
+                                     queue_data_t* q);
+inline void exchange_vert_data_end(dist_graph_t* g, mpi_data_t* comm, 
+                                   queue_data_t* q);
+
+inline uint64_t wire_record_bytes(mpi_data_t* comm);
+inline void pack_update(mpi_data_t* comm, uint8_t* buf, uint64_t i, 
+                        uint64_t slot, int32_t data);
+inline uint64_t unpack_slot(mpi_data_t* comm, uint8_t* buf, uint64_t i);
+inline int32_t unpack_data(mpi_data_t* comm, uint8_t* buf, uint64_t i);
+inline uint64_t recv_vert(mpi_data_t* comm, uint64_t i);
+inline int32_t recv_data(mpi_data_t* comm, uint64_t i);
+inline void set_label_wire_format(mpi_data_t* comm, int32_t num_parts);
+
+inline int32_t num_sweeps(mpi_data_t* comm);
+inline uint64_t sweep_begin(dist_graph_t* g, mpi_data_t* comm, int32_t sweep);
+inline uint64_t sweep_end(dist_graph_t* g, mpi_data_t* comm, int32_t sweep);
+inline uint64_t sweep_vert(mpi_data_t* comm, uint64_t i);
 
 
 inline void update_sendcounts_thread(dist_graph_t* g, 
-                              thread_comm_t* tc, uint64_t vert_index);
+                              thread_comm_t* tc, mpi_data_t* comm,
+                              uint64_t vert_index);
 inline void update_vid_data_queues(dist_graph_t* g, 
                             thread_comm_t* tc, mpi_data_t* comm,
                             uint64_t vert_index, int32_t* data);
@@ -155,230 +290,286 @@ inline void empty_vid_data(thread_comm_t* tc, mpi_data_t* comm);
 
 inline void exchange_verts(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q)
 {
+  if (comm->neighbor_comm == MPI_COMM_NULL)
+    init_neighbor_comm(g, comm);
+
+  // A single task has no ghosts, so there is nothing to send or receive
+  if (nprocs == 1)
+  {
+    comm->global_queue_size = q->next_size;
+    q->queue_size = q->next_size;
+    q->next_size = 0;
+    q->send_size = 0;
+    lid_t* temp = q->queue;
+    q->queue = q->queue_next;
+    q->queue_next = temp;
+    return;
+  }
+
   comm->global_queue_size = 0;
   uint64_t task_queue_size = q->next_size + q->send_size;
   MPI_Allreduce(&task_queue_size, &comm->global_queue_size, 1, 
                 MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);      
-  
-  uint64_t num_comms = comm->global_queue_size / (uint64_t)MAX_SEND_SIZE + 1;
-  uint64_t sum_recv = 0;
-  for (uint64_t c = 0; c < num_comms; ++c)
-  {
-    uint64_t send_begin = (q->send_size * c) / num_comms;
-    uint64_t send_end = (q->send_size * (c + 1)) / num_comms;
-    if (c == (num_comms-1))
-      send_end = q->send_size;
-
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
-      comm->sendcounts[i] = 0;
-      comm->recvcounts[i] = 0;
-    }
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t ghost_index = q->queue_send[i] - g->n_local;
-      uint64_t ghost_task = g->ghost_tasks[ghost_index];
-      ++comm->sendcounts[ghost_task];
-    }
 
-    MPI_Alltoall(comm->sendcounts, 1, MPI_INT32_T, 
-                 comm->recvcounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
-
-    comm->sdispls[0] = 0;
-    comm->sdispls_cpy[0] = 0;
-    comm->rdispls[0] = 0;
-    for (int32_t i = 1; i < nprocs; ++i)
-    {
-      comm->sdispls[i] = comm->sdispls[i-1] + comm->sendcounts[i-1];
-      comm->rdispls[i] = comm->rdispls[i-1] + comm->recvcounts[i-1];
-      comm->sdispls_cpy[i] = comm->sdispls[i];
-    }
+  // Ghosts are only owned by neighbors, every other task's count stays zero
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+    comm->sendcounts_temp[comm->dests[i]] = 0;
+  for (uint64_t i = 0; i < q->send_size; ++i)
+  {
+    uint64_t ghost_index = q->queue_send[i] - g->n_local;
+    uint64_t ghost_task = g->ghost_tasks[ghost_index];
+    ++comm->sendcounts_temp[ghost_task];
+  }
 
-    int32_t cur_send = comm->sdispls[nprocs-1] + comm->sendcounts[nprocs-1];
-    int32_t cur_recv = comm->rdispls[nprocs-1] + comm->recvcounts[nprocs-1];
-    comm->sendbuf_vert = (uint64_t*)malloc((uint64_t)(cur_send+1)*sizeof(uint64_t));
-    if (comm->sendbuf_vert == NULL)
-      throw_err("exchange_verts(), unable to allocate comm buffers", procid);
+  uint64_t sum_send = 0;
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+  {
+    int32_t task = comm->dests[i];
+    comm->sdispls_temp[task] = sum_send;
+    comm->sdispls_cpy_temp[task] = sum_send;
+    sum_send += comm->sendcounts_temp[task];
+  }
 
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t ghost_index = q->queue_send[i] - g->n_local;
-      uint64_t ghost_task = g->ghost_tasks[ghost_index];
-      uint64_t vert = g->ghost_unmap[ghost_index];
-      comm->sendbuf_vert[comm->sdispls_cpy[ghost_task]++] = vert; 
-    }
+  uint64_t cur_recv = exchange_neighbor_counts(comm);
+  comm->sendbuf_vert = (uint64_t*)reserve_pool_buffer(&comm->send_pool,
+    (q->send_size+1)*sizeof(uint64_t));
 
-    MPI_Alltoallv(comm->sendbuf_vert, 
-                  comm->sendcounts, comm->sdispls, MPI_UINT64_T, 
-                  q->queue_next+q->next_size+sum_recv, 
-                  comm->recvcounts, comm->rdispls, MPI_UINT64_T, 
-                  MPI_COMM_WORLD);
-    free(comm->sendbuf_vert);
-    sum_recv += cur_recv;
+  for (uint64_t i = 0; i < q->send_size; ++i)
+  {
+    uint64_t ghost_index = q->queue_send[i] - g->n_local;
+    uint64_t ghost_task = g->ghost_tasks[ghost_index];
+    uint64_t vert = g->ghost_unmap[ghost_index];
+    comm->sendbuf_vert[comm->sdispls_cpy_temp[ghost_task]++] = vert; 
   }
 
-  q->queue_size = q->next_size + sum_recv;
+  // Received ids arrive as 64 bits and are narrowed into the queue
+  uint64_t* recvbuf_vert = (uint64_t*)reserve_pool_buffer(&comm->recv_pool,
+    (cur_recv+1)*sizeof(uint64_t));
+  neighbor_alltoallv_large(comm->sendbuf_vert, recvbuf_vert, 
+                           MPI_UINT64_T, comm->global_queue_size, comm);
+  for (uint64_t i = 0; i < cur_recv; ++i)
+    q->queue_next[q->next_size + i] = (lid_t)recvbuf_vert[i];
+
+  q->queue_size = q->next_size + cur_recv;
   q->next_size = 0;
   q->send_size = 0;
-  uint64_t* temp = q->queue;
+  lid_t* temp = q->queue;
   q->queue = q->queue_next;
   q->queue_next = temp;
 }
 
 
 
+// The global queue size is only needed by the init routines, which loop
+// until no task has anything left to send; the kernels skip its reduction
 inline void exchange_vert_data(dist_graph_t* g, mpi_data_t* comm, 
                                queue_data_t* q)
 {
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->recvcounts_temp[i] = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sdispls_temp[i] -= comm->sendcounts_temp[i];
+  uint64_t next_size = q->next_size;
+  exchange_vert_data_begin(g, comm, q);
+  exchange_vert_data_end(g, comm, q);
 
-  MPI_Alltoall(comm->sendcounts_temp, 1, MPI_UINT64_T, 
-               comm->recvcounts_temp, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+  comm->global_queue_size = 0;
+  uint64_t task_queue_size = comm->total_recv + next_size;
+  MPI_Allreduce(&task_queue_size, &comm->global_queue_size, 1, 
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);  
+}
 
-  comm->total_recv = 0;
-  for (int i = 0; i < nprocs; ++i)
-    comm->total_recv += comm->recvcounts_temp[i];
+// Posts the exchange of the packed send buffers without waiting on it
+inline void exchange_vert_data_begin(dist_graph_t* g, mpi_data_t* comm, 
+                                     queue_data_t* q)
+{
+  if (comm->neighbor_comm == MPI_COMM_NULL)
+    init_neighbor_comm(g, comm);
+
+  if (nprocs == 1)
+  {
+    comm->global_queue_size = 0;
+    comm->total_recv = 0;
+    return;
+  }
 
-  comm->recvbuf_vert = (uint64_t*)malloc(comm->total_recv*sizeof(uint64_t));
-  comm->recvbuf_data = (int32_t*)malloc(comm->total_recv*sizeof(uint32_t));
-  if (comm->recvbuf_vert == NULL || comm->sendbuf_vert == NULL)
-    throw_err("exchange_vert_data() unable to allocate comm buffers", procid);
+  for (int32_t i = 0; i < comm->num_dests; ++i)
+    comm->sdispls_temp[comm->dests[i]] -= 
+      comm->sendcounts_temp[comm->dests[i]];
 
+  if (comm->rma_exchange)
+  {
+    exchange_vert_data_rma_begin(comm);
+    return;
+  }
 
   comm->global_queue_size = 0;
   uint64_t task_queue_size = comm->total_send;
   MPI_Allreduce(&task_queue_size, &comm->global_queue_size, 1, 
                 MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
-  
-  uint64_t num_comms = comm->global_queue_size / (uint64_t)MAX_SEND_SIZE + 1;
-  uint64_t sum_recv = 0;
-  uint64_t sum_send = 0;
-  for (uint64_t c = 0; c < num_comms; ++c)
+
+  // The node-aware exchange completes here, end only cleans up
+  if (comm->node_exchange)
   {
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
-      uint64_t send_begin = (comm->sendcounts_temp[i] * c) / num_comms;
-      uint64_t send_end = (comm->sendcounts_temp[i] * (c + 1)) / num_comms;
-      if (c == (num_comms-1))
-        send_end = comm->sendcounts_temp[i];
-      comm->sendcounts[i] = (int32_t)(send_end - send_begin);
-      assert(comm->sendcounts[i] >= 0);
-    }
+    exchange_vert_data_node(comm);
+    return;
+  }
 
-    MPI_Alltoall(comm->sendcounts, 1, MPI_INT32_T, 
-                 comm->recvcounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
+  comm->total_recv = exchange_neighbor_counts(comm);
 
-    comm->sdispls[0] = 0;
-    comm->sdispls_cpy[0] = 0;
-    comm->rdispls[0] = 0;
-    for (int32_t i = 1; i < nprocs; ++i)
-    {
-      comm->sdispls[i] = comm->sdispls[i-1] + comm->sendcounts[i-1];
-      comm->rdispls[i] = comm->rdispls[i-1] + comm->recvcounts[i-1];
-      comm->sdispls_cpy[i] = comm->sdispls[i];
-    }
+  comm->recvbuf_wire = (uint8_t*)reserve_pool_buffer(&comm->recv_pool,
+    (comm->total_recv+1)*wire_record_bytes(comm));
 
-    int32_t cur_send = comm->sdispls[nprocs-1] + comm->sendcounts[nprocs-1];
-    int32_t cur_recv = comm->rdispls[nprocs-1] + comm->recvcounts[nprocs-1];
-    uint64_t* buf_v = (uint64_t*)malloc((uint64_t)(cur_send)*sizeof(uint64_t));
-    int32_t* buf_d = (int32_t*)malloc((int32_t)(cur_send)*sizeof(int32_t));
-    if (buf_v == NULL || buf_d == NULL)
-      throw_err("exchange_verts(), unable to allocate comm buffers", procid);
+  // The send buffer is already grouped by task, so it goes out as is, with
+  // counts in records
+  MPI_Datatype record_type;
+  MPI_Type_contiguous((int)wire_record_bytes(comm), MPI_BYTE, &record_type);
+  MPI_Type_commit(&record_type);
+  ineighbor_alltoallv_large(comm->sendbuf_wire, comm->recvbuf_wire, 
+                            record_type, comm->global_queue_size, comm);
+  MPI_Type_free(&record_type);
+}
 
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
-      uint64_t send_begin = (comm->sendcounts_temp[i] * c) / num_comms;
-      uint64_t send_end = (comm->sendcounts_temp[i] * (c + 1)) / num_comms;
-      if (c == (num_comms-1))
-        send_end = comm->sendcounts_temp[i];
-
-      for (uint64_t j = send_begin; j < send_end; ++j)
-      {
-        uint64_t vert = comm->sendbuf_vert[comm->sdispls_temp[i]+j];
-        int32_t data = comm->sendbuf_data[comm->sdispls_temp[i]+j];
-        buf_v[comm->sdispls_cpy[i]] = vert;
-        buf_d[comm->sdispls_cpy[i]++] = data;
-      }
-    }
+inline void exchange_vert_data_end(dist_graph_t* g, mpi_data_t* comm, 
+                                   queue_data_t* q)
+{
+  if (nprocs > 1 && comm->rma_exchange)
+    exchange_vert_data_rma_end(comm);
+  else if (nprocs > 1)
+    wait_neighbor_alltoallv(comm);
 
-    MPI_Alltoallv(buf_v, comm->sendcounts, 
-                  comm->sdispls, MPI_UINT64_T, 
-                  comm->recvbuf_vert+sum_recv, comm->recvcounts, 
-                  comm->rdispls, MPI_UINT64_T, MPI_COMM_WORLD);
-    MPI_Alltoallv(buf_d, comm->sendcounts, 
-                  comm->sdispls, MPI_INT32_T, 
-                  comm->recvbuf_data+sum_recv, comm->recvcounts, 
-                  comm->rdispls, MPI_INT32_T, MPI_COMM_WORLD);
-    free(buf_v);
-    free(buf_d);
-    sum_recv += cur_recv;
-    sum_send += cur_send;
-  }
-  free(comm->sendbuf_data);
-  free(comm->sendbuf_vert);
+  q->next_size = 0;
+  q->send_size = 0;
+}
 
-  assert(sum_recv == comm->total_recv);
-  assert(sum_send == comm->total_send);
+inline uint64_t wire_record_bytes(mpi_data_t* comm)
+{
+  return (uint64_t)(comm->wire_index_bytes + comm->wire_data_bytes);
+}
 
-  comm->global_queue_size = 0;
-  task_queue_size = comm->total_recv + q->next_size;
-  MPI_Allreduce(&task_queue_size, &comm->global_queue_size, 1, 
-                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);  
+inline void pack_update(mpi_data_t* comm, uint8_t* buf, uint64_t i, 
+                        uint64_t slot, int32_t data)
+{
+  uint8_t* record = buf + i*wire_record_bytes(comm);
+  if (comm->wire_index_bytes == 4)
+  {
+    uint32_t slot_32 = (uint32_t)slot;
+    memcpy(record, &slot_32, 4);
+  }
+  else
+    memcpy(record, &slot, 8);
 
-  q->next_size = 0;
-  q->send_size = 0;
+  record += comm->wire_index_bytes;
+  if (comm->wire_data_bytes == 1)
+  {
+    int8_t data_8 = (int8_t)data;
+    memcpy(record, &data_8, 1);
+  }
+  else if (comm->wire_data_bytes == 2)
+  {
+    int16_t data_16 = (int16_t)data;
+    memcpy(record, &data_16, 2);
+  }
+  else
+    memcpy(record, &data, 4);
 }
 
-inline void update_sendcounts_thread(dist_graph_t* g, 
-                                     thread_comm_t* tc, 
-                                     uint64_t vert_index)
+inline uint64_t unpack_slot(mpi_data_t* comm, uint8_t* buf, uint64_t i)
 {
-  for (int32_t i = 0; i < nprocs; ++i)
-    tc->v_to_rank[i] = false;
+  uint8_t* record = buf + i*wire_record_bytes(comm);
+  if (comm->wire_index_bytes == 4)
+  {
+    uint32_t slot_32;
+    memcpy(&slot_32, record, 4);
+    return (uint64_t)slot_32;
+  }
+
+  uint64_t slot;
+  memcpy(&slot, record, 8);
+  return slot;
+}
 
-  uint64_t out_degree = out_degree(g, vert_index);
-  uint64_t* outs = out_vertices(g, vert_index);
-  for (uint64_t j = 0; j < out_degree; ++j)
+inline int32_t unpack_data(mpi_data_t* comm, uint8_t* buf, uint64_t i)
+{
+  uint8_t* record = buf + i*wire_record_bytes(comm) + comm->wire_index_bytes;
+  if (comm->wire_data_bytes == 1)
   {
-    uint64_t out_index = outs[j];
-    if (out_index >= g->n_local)
-    {
-      int32_t out_rank = g->ghost_tasks[out_index-g->n_local];
-      if (!tc->v_to_rank[out_rank])
-      {
-        tc->v_to_rank[out_rank] = true;
-        ++tc->sendcounts_thread[out_rank];
-      }
-    }
+    int8_t data_8;
+    memcpy(&data_8, record, 1);
+    return (int32_t)data_8;
   }
+  else if (comm->wire_data_bytes == 2)
+  {
+    int16_t data_16;
+    memcpy(&data_16, record, 2);
+    return (int32_t)data_16;
+  }
+
+  int32_t data;
+  memcpy(&data, record, 4);
+  return data;
+}
+
+inline uint64_t recv_vert(mpi_data_t* comm, uint64_t i)
+{
+  return unpack_slot(comm, comm->recvbuf_wire, i);
+}
+
+inline int32_t recv_data(mpi_data_t* comm, uint64_t i)
+{
+  return unpack_data(comm, comm->recvbuf_wire, i);
+}
+
+// Part labels, -1 included, fit in the smallest signed width holding 
+// num_parts; any other data is sent at full width
+inline void set_label_wire_format(mpi_data_t* comm, int32_t num_parts)
+{
+  if (num_parts <= 0)
+    comm->wire_data_bytes = 4;
+  else if (num_parts <= INT8_MAX)
+    comm->wire_data_bytes = 1;
+  else if (num_parts <= INT16_MAX)
+    comm->wire_data_bytes = 2;
+  else
+    comm->wire_data_bytes = 4;
+}
+
+// A label propagation pass is one sweep over all local vertices, or in
+// overlapped mode a boundary sweep followed by an interior sweep
+inline int32_t num_sweeps(mpi_data_t* comm)
+{
+  return comm->overlap ? 2 : 1;
+}
+
+inline uint64_t sweep_begin(dist_graph_t* g, mpi_data_t* comm, int32_t sweep)
+{
+  return sweep == 0 ? 0 : comm->num_boundary;
+}
+
+inline uint64_t sweep_end(dist_graph_t* g, mpi_data_t* comm, int32_t sweep)
+{
+  return (comm->overlap && sweep == 0) ? comm->num_boundary : g->n_local;
+}
+
+inline uint64_t sweep_vert(mpi_data_t* comm, uint64_t i)
+{
+  return comm->overlap ? comm->sweep_verts[i] : i;
+}
+
+inline void update_sendcounts_thread(dist_graph_t* g, 
+                                     thread_comm_t* tc, mpi_data_t* comm,
+                                     uint64_t vert_index)
+{
+  for (uint64_t j = comm->boundary_offsets[vert_index];
+       j < comm->boundary_offsets[vert_index+1]; ++j)
+    ++tc->sendcounts_thread[comm->boundary_tasks[j]];
 }
 
 inline void update_vid_data_queues(dist_graph_t* g, 
                                    thread_comm_t* tc, mpi_data_t* comm,
                                    uint64_t vert_index, int32_t data)
 {
-  for (int32_t i = 0; i < nprocs; ++i)
-    tc->v_to_rank[i] = false;
-
-  uint64_t out_degree = out_degree(g, vert_index);
-  uint64_t* outs = out_vertices(g, vert_index);
-  for (uint64_t j = 0; j < out_degree; ++j)
-  {
-    uint64_t out_index = outs[j];
-    if (out_index >= g->n_local)
-    {
-      int32_t out_rank = g->ghost_tasks[out_index - g->n_local];
-      if (!tc->v_to_rank[out_rank])
-      {
-        tc->v_to_rank[out_rank] = true;
-        add_vid_data_to_send(tc, comm,
-          g->local_unmap[vert_index], data, out_rank);
-      }
-    }
-  }
+  // Updates are addressed by the receiver's ghost index, not the global id
+  for (uint64_t j = comm->boundary_offsets[vert_index];
+       j < comm->boundary_offsets[vert_index+1]; ++j)
+    add_vid_data_to_send(tc, comm, 
+      comm->boundary_slots[j], data, comm->boundary_tasks[j]);
 }
 
 inline void add_vid_to_queue(thread_queue_t* tq, queue_data_t* q, 
@@ -457,8 +648,9 @@ inline void add_vid_data_to_send(thread_comm_t* tc, mpi_data_t* comm,
 
   if (tc->thread_queue_size == THREAD_QUEUE_SIZE)
   {
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic capture
       tc->thread_starts[i] = comm->sdispls_temp[i] += tc->sendcounts_thread[i];
 
@@ -468,17 +660,15 @@ inline void add_vid_data_to_send(thread_comm_t* tc, mpi_data_t* comm,
     for (uint64_t i = 0; i < tc->thread_queue_size; ++i)
     {
       int32_t cur_rank = tc->sendbuf_rank_thread[i];
-      comm->sendbuf_vert[tc->thread_starts[cur_rank]] = 
-        tc->sendbuf_vert_thread[i];
-      comm->sendbuf_data[tc->thread_starts[cur_rank]] = 
-        tc->sendbuf_data_thread[i];
+      pack_update(comm, comm->sendbuf_wire, tc->thread_starts[cur_rank], 
+                  tc->sendbuf_vert_thread[i], tc->sendbuf_data_thread[i]);
       ++tc->thread_starts[cur_rank];
     }
     
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
-      tc->thread_starts[i] = 0;
-      tc->sendcounts_thread[i] = 0;
+      tc->thread_starts[comm->dests[n]] = 0;
+      tc->sendcounts_thread[comm->dests[n]] = 0;
     }
     tc->thread_queue_size = 0;
   }
@@ -486,8 +676,9 @@ inline void add_vid_data_to_send(thread_comm_t* tc, mpi_data_t* comm,
 
 inline void empty_vid_data(thread_comm_t* tc, mpi_data_t* comm)
 {
-  for (int32_t i = 0; i < nprocs; ++i)
+  for (int32_t n = 0; n < comm->num_dests; ++n)
   {
+    int32_t i = comm->dests[n];
 #pragma omp atomic capture
     tc->thread_starts[i] = comm->sdispls_temp[i] += tc->sendcounts_thread[i];
 
@@ -497,17 +688,15 @@ inline void empty_vid_data(thread_comm_t* tc, mpi_data_t* comm)
   for (uint64_t i = 0; i < tc->thread_queue_size; ++i)
   {
     int32_t cur_rank = tc->sendbuf_rank_thread[i];
-    comm->sendbuf_vert[tc->thread_starts[cur_rank]] = 
-      tc->sendbuf_vert_thread[i];
-    comm->sendbuf_data[tc->thread_starts[cur_rank]] = 
-      tc->sendbuf_data_thread[i];
+    pack_update(comm, comm->sendbuf_wire, tc->thread_starts[cur_rank], 
+                tc->sendbuf_vert_thread[i], tc->sendbuf_data_thread[i]);
     ++tc->thread_starts[cur_rank];
   }
   
-  for (int32_t i = 0; i < nprocs; ++i)
+  for (int32_t n = 0; n < comm->num_dests; ++n)
   {
-    tc->thread_starts[i] = 0;
-    tc->sendcounts_thread[i] = 0;
+    tc->thread_starts[comm->dests[n]] = 0;
+    tc->sendcounts_thread[comm->dests[n]] = 0;
   }
   tc->thread_queue_size = 0;
 }
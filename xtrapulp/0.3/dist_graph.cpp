@@ -59,6 +59,116 @@
 extern int procid, nprocs;
 extern bool verbose, debug, verify;
 
+// Takes an adjacency already in local indexes as the graph's out_edges,
+// narrowing it into a new array when local indexes are 32 bits. A caller's
+// adjacency is then kept in global_out_edges rather than freed, so in both
+// widths it stays valid until clear_graph() releases it
+void set_local_edges(dist_graph_t* g, uint64_t* edges)
+{
+#ifdef LOCAL_INDEX_32
+  if (g->n_total > (uint64_t)UINT32_MAX)
+    throw_err("set_local_edges(), too many vertices for 32-bit local indexes", procid);
+
+  g->out_edges = (lid_t*)malloc(g->m_local*sizeof(lid_t));
+  if (g->out_edges == NULL && g->m_local > 0)
+    throw_err("set_local_edges(), unable to allocate out edges", procid);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < g->m_local; ++i)
+    g->out_edges[i] = (lid_t)edges[i];
+
+  if (g->caller_edges) {
+    g->global_out_edges = edges;
+  } else {
+    free(edges);
+    g->global_out_edges = NULL;
+  }
+#else
+  g->out_edges = edges;
+  g->global_out_edges = NULL;
+#endif
+}
+
+
+// Builds the local CSR from gen_edges, which holds stride values per edge:
+// the global source, the target, and with a stride of 3 the edge weight.
+// Weights come from weights_in instead when it's given. Degrees and edge
+// slots are claimed atomically, so with more than one thread the order
+// within an adjacency list can vary between runs.
+void build_csr(uint64_t n_local, uint64_t n_offset, uint64_t m_local,
+               uint64_t* gen_edges, uint64_t stride, int32_t* weights_in,
+               uint64_t* out_edges, uint64_t* out_degree_list, 
+               int32_t* edge_weights)
+{
+  uint64_t* cursors = (uint64_t*)malloc((n_local+1)*sizeof(uint64_t));
+  uint64_t* thread_sums = 
+    (uint64_t*)malloc((omp_get_max_threads()+1)*sizeof(uint64_t));
+  if (cursors == NULL || thread_sums == NULL)
+    throw_err("build_csr(), unable to allocate cursors", procid);
+
+#pragma omp parallel
+{
+  uint64_t num_threads = (uint64_t)omp_get_num_threads();
+  uint64_t tid = (uint64_t)omp_get_thread_num();
+
+#pragma omp for
+  for (uint64_t i = 0; i < n_local; ++i)
+    cursors[i] = 0;
+
+#pragma omp for
+  for (uint64_t i = 0; i < m_local; ++i)
+  {
+#pragma omp atomic
+    ++cursors[gen_edges[i*stride] - n_offset];
+  }
+
+  // Prefix sum over one block of vertices per thread
+  uint64_t begin = n_local*tid / num_threads;
+  uint64_t end = n_local*(tid+1) / num_threads;
+  uint64_t sum = 0;
+  for (uint64_t i = begin; i < end; ++i)
+    sum += cursors[i];
+  thread_sums[tid+1] = sum;
+
+#pragma omp barrier
+
+#pragma omp single
+{
+  thread_sums[0] = 0;
+  for (uint64_t t = 0; t < num_threads; ++t)
+    thread_sums[t+1] += thread_sums[t];
+  out_degree_list[n_local] = thread_sums[num_threads];
+}
+
+  sum = thread_sums[tid];
+  for (uint64_t i = begin; i < end; ++i)
+  {
+    out_degree_list[i] = sum;
+    sum += cursors[i];
+    cursors[i] = out_degree_list[i];
+  }
+
+#pragma omp barrier
+
+#pragma omp for
+  for (uint64_t i = 0; i < m_local; ++i)
+  {
+    uint64_t* edge = &gen_edges[i*stride];
+    uint64_t index;
+#pragma omp atomic capture
+    index = cursors[edge[0] - n_offset]++;
+    out_edges[index] = edge[1];
+    if (edge_weights != NULL)
+      edge_weights[index] = 
+        (weights_in != NULL) ? weights_in[i] : (int32_t)edge[2];
+  }
+} // end parallel
+
+  free(cursors);
+  free(thread_sums);
+}
+
+
 int create_graph(graph_gen_data_t *ggi, dist_graph_t *g)
 {  
   if (debug) { printf("Task %d create_graph() start\n", procid); }
@@ -89,33 +199,16 @@ int create_graph(graph_gen_data_t *ggi, dist_graph_t *g)
 
   uint64_t* out_edges = (uint64_t*)malloc(g->m_local*sizeof(uint64_t));
   uint64_t* out_degree_list = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
-  uint64_t* temp_counts = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));
-  if (out_edges == NULL || out_degree_list == NULL || temp_counts == NULL)
+  if (out_edges == NULL || out_degree_list == NULL)
     throw_err("create_graph(), unable to allocate graph edge storage", procid);
 
-#pragma omp parallel
-{
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local+1; ++i)
-    out_degree_list[i] = 0;
-#pragma omp for
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    temp_counts[i] = 0;
-}
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2)
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    out_degree_list[i+1] = out_degree_list[i] + temp_counts[i];
-  memcpy(temp_counts, out_degree_list, g->n_local*sizeof(uint64_t));
-
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2)
-    out_edges[temp_counts[ggi->gen_edges[i] - g->n_offset]++] = ggi->gen_edges[i+1];
+  build_csr(g->n_local, g->n_offset, g->m_local, ggi->gen_edges, 2, NULL,
+            out_edges, out_degree_list, NULL);
   
   free(ggi->gen_edges);
-  free(temp_counts);
-  g->out_edges = out_edges;
+  g->out_edges = NULL;
+  g->global_out_edges = out_edges;
+  g->caller_edges = false;
   g->out_degree_list = out_degree_list;
 
   g->local_unmap = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));
@@ -168,39 +261,17 @@ int create_graph_weighted(graph_gen_data_t *ggi, dist_graph_t *g)
   uint64_t* out_edges = (uint64_t*)malloc(g->m_local*sizeof(uint64_t));
   uint64_t* out_degree_list = 
       (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
-  uint64_t* temp_counts = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));
   int32_t* edge_weights = (int32_t*)malloc(g->m_local*sizeof(int32_t));
-  if (  out_edges == NULL || out_degree_list == NULL ||
-      temp_counts == NULL ||    edge_weights == NULL)
+  if (out_edges == NULL || out_degree_list == NULL || edge_weights == NULL)
     throw_err("create_graph_weighted(), unable to allocate graph edge storage", procid);
 
-#pragma omp parallel
-{
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local+1; ++i)
-    out_degree_list[i] = 0;
-#pragma omp for
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    temp_counts[i] = 0;
-}
-
-  for (uint64_t i = 0; i < g->m_local*3; i+=3)
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    out_degree_list[i+1] = out_degree_list[i] + temp_counts[i];
-  memcpy(temp_counts, out_degree_list, g->n_local*sizeof(uint64_t));
-
-  for (uint64_t i = 0; i < g->m_local*3; i+=3) {
-    out_edges[temp_counts[ggi->gen_edges[i] - g->n_offset]] = 
-        ggi->gen_edges[i+1];
-    edge_weights[temp_counts[ggi->gen_edges[i] - g->n_offset]] = 
-        (int32_t)ggi->gen_edges[i+2];
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  }
+  build_csr(g->n_local, g->n_offset, g->m_local, ggi->gen_edges, 3, NULL,
+            out_edges, out_degree_list, edge_weights);
   
   free(ggi->gen_edges);
-  free(temp_counts);
-  g->out_edges = out_edges;
+  g->out_edges = NULL;
+  g->global_out_edges = out_edges;
+  g->caller_edges = false;
   g->out_degree_list = out_degree_list;
   g->edge_weights = edge_weights;
 
@@ -256,38 +327,22 @@ int create_graph_serial(graph_gen_data_t *ggi, dist_graph_t *g)
 
   uint64_t* out_edges = (uint64_t*)malloc(g->m_local*sizeof(uint64_t));
   uint64_t* out_degree_list = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
-  uint64_t* temp_counts = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));
-  if (out_edges == NULL || out_degree_list == NULL || temp_counts == NULL)
+  if (out_edges == NULL || out_degree_list == NULL)
     throw_err("create_graph_serial(), unable to allocate out edge storage\n", procid);
 
-#pragma omp parallel
-{
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local+1; ++i)
-    out_degree_list[i] = 0;
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    temp_counts[i] = 0;
-}
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2)
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    out_degree_list[i+1] = out_degree_list[i] + temp_counts[i];
-  memcpy(temp_counts, out_degree_list, g->n_local*sizeof(uint64_t));
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2)
-    out_edges[temp_counts[ggi->gen_edges[i] - g->n_offset]++] = ggi->gen_edges[i+1];
+  build_csr(g->n_local, g->n_offset, g->m_local, ggi->gen_edges, 2, NULL,
+            out_edges, out_degree_list, NULL);
 
   free(ggi->gen_edges);
-  free(temp_counts);
-  g->out_edges = out_edges;
+  g->caller_edges = false;
+  set_local_edges(g, out_edges);
   g->out_degree_list = out_degree_list;
 
   g->local_unmap = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));  
   if (g->local_unmap == NULL)
     throw_err("create_graph_serial(), unable to allocate unmap\n", procid);
 
+#pragma omp parallel for
   for (uint64_t i = 0; i < g->n_local; ++i)
     g->local_unmap[i] = i + g->n_offset;
 
@@ -332,40 +387,17 @@ int create_graph_serial_weighted(graph_gen_data_t *ggi, dist_graph_t *g)
 
   uint64_t* out_edges = (uint64_t*)malloc(g->m_local*sizeof(uint64_t));
   uint64_t* out_degree_list = (uint64_t*)malloc((g->n_local+1)*sizeof(uint64_t));
-  uint64_t* temp_counts = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));
   int32_t* edge_weights = (int32_t*)malloc(g->m_local*sizeof(int32_t));
-  if (  out_edges == NULL || out_degree_list == NULL ||
-      temp_counts == NULL ||    edge_weights == NULL)
+  if (out_edges == NULL || out_degree_list == NULL || edge_weights == NULL)
     throw_err("create_graph_serial(), unable to allocate out edge storage\n", procid);
 
-#pragma omp parallel
-{
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local+1; ++i)
-    out_degree_list[i] = 0;
-#pragma omp for nowait
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    temp_counts[i] = 0;
-}
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2)
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  for (uint64_t i = 0; i < g->n_local; ++i)
-    out_degree_list[i+1] = out_degree_list[i] + temp_counts[i];
-  memcpy(temp_counts, out_degree_list, g->n_local*sizeof(uint64_t));
-
-  for (uint64_t i = 0; i < g->m_local*2; i+=2) {
-    out_edges[temp_counts[ggi->gen_edges[i] - g->n_offset]] = 
-        ggi->gen_edges[i+1];
-    edge_weights[temp_counts[ggi->gen_edges[i] - g->n_offset]] = 
-        (int32_t)ggi->edge_weights[i/2];
-    ++temp_counts[ggi->gen_edges[i] - g->n_offset];
-  }
+  build_csr(g->n_local, g->n_offset, g->m_local, ggi->gen_edges, 2, 
+            ggi->edge_weights, out_edges, out_degree_list, edge_weights);
 
   free(ggi->gen_edges);
   free(ggi->edge_weights);
-  free(temp_counts);
-  g->out_edges = out_edges;
+  g->caller_edges = false;
+  set_local_edges(g, out_edges);
   g->out_degree_list = out_degree_list;
   g->edge_weights = edge_weights;
 
@@ -373,6 +405,7 @@ int create_graph_serial_weighted(graph_gen_data_t *ggi, dist_graph_t *g)
   if (g->local_unmap == NULL)
     throw_err("create_graph_serial(), unable to allocate unmap\n", procid);
 
+#pragma omp parallel for
   for (uint64_t i = 0; i < g->n_local; ++i)
     g->local_unmap[i] = i + g->n_offset;
 
@@ -417,7 +450,8 @@ int create_graph(dist_graph_t* g,
   g->num_edge_weights = 0;
   g->map = (struct fast_map*)malloc(sizeof(struct fast_map));
 
-  g->out_edges = local_adjs;
+  g->out_edges = NULL;
+  g->global_out_edges = local_adjs;
   g->out_degree_list = local_offsets;
 
   if (g->num_vert_weights > 0)
@@ -521,12 +555,13 @@ int create_graph_serial(dist_graph_t* g,
                   MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
   }
 
-  g->out_edges = local_adjs;
+  set_local_edges(g, local_adjs);
   g->out_degree_list = local_offsets;
   g->local_unmap = (uint64_t*)malloc(g->n_local*sizeof(uint64_t));  
   if (g->local_unmap == NULL)
     throw_err("create_graph_serial(), unable to allocate unmap\n", procid);
 
+#pragma omp parallel for
   for (uint64_t i = 0; i < g->n_local; ++i)
     g->local_unmap[i] = i + g->n_offset;
 
@@ -546,6 +581,7 @@ int clear_graph(dist_graph_t *g)
   if (debug) { printf("Task %d clear_graph() start\n", procid); }
 
   free(g->out_edges);
+  free(g->global_out_edges);
   free(g->out_degree_list);
   free(g->ghost_degrees);
   free(g->local_unmap);
@@ -582,26 +618,64 @@ int relabel_edges(dist_graph_t *g, uint64_t* vert_dist)
 
   uint64_t total_edges = g->m_local + g->n_local;
   init_map(g->map, total_edges*2);
+
+#pragma omp parallel for
   for (uint64_t i = 0; i < g->n_local; ++i)
   {
-    uint64_t vert = g->local_unmap[i];
-    set_value(g->map, vert, i);
+    bool inserted;
+    uint64_t index = insert_key_atomic(g->map, g->local_unmap[i], &inserted);
+    g->map->values[index] = i;
   }
 
-  uint64_t cur_label = g->n_local;
+  // Any endpoint not already in the map is a ghost, its value stays null
+  // until the ghosts are labeled below
+#pragma omp parallel for
   for (uint64_t i = 0; i < g->m_local; ++i)
   {
-    uint64_t out = g->out_edges[i];
-    uint64_t val = get_value(g->map, out);
-    if (val == NULL_KEY)
-    {
-      set_value_uq(g->map, out, cur_label);
-      g->out_edges[i] = cur_label++;
-    }
-    else
-      g->out_edges[i] = val;
+    bool inserted;
+    uint64_t index = 
+      insert_key_atomic(g->map, g->global_out_edges[i], &inserted);
+    if (inserted)
+      g->map->values[index] = NULL_KEY;
   }
 
+  // Each thread collects the ghosts in its range of slots
+  uint64_t* thread_offsets = 
+    (uint64_t*)malloc((omp_get_max_threads()+1)*sizeof(uint64_t));
+  if (thread_offsets == NULL)
+    throw_err("relabel_edges(), unable to allocate thread offsets", procid);
+
+#pragma omp parallel
+{
+  uint64_t num_threads = (uint64_t)omp_get_num_threads();
+  uint64_t tid = (uint64_t)omp_get_thread_num();
+  uint64_t begin = g->map->capacity*tid / num_threads;
+  uint64_t end = g->map->capacity*(tid+1) / num_threads;
+
+  uint64_t num_found = 0;
+  for (uint64_t i = begin; i < end; ++i)
+    if (g->map->keys[i] != NULL_KEY && g->map->values[i] == NULL_KEY)
+      ++num_found;
+  thread_offsets[tid+1] = num_found;
+
+#pragma omp barrier
+
+#pragma omp single
+{
+  thread_offsets[0] = 0;
+  for (uint64_t t = 0; t < num_threads; ++t)
+    thread_offsets[t+1] += thread_offsets[t];
+  g->map->num_unique = thread_offsets[num_threads];
+}
+
+  uint64_t cur_offset = thread_offsets[tid];
+  for (uint64_t i = begin; i < end; ++i)
+    if (g->map->keys[i] != NULL_KEY && g->map->values[i] == NULL_KEY)
+      g->map->unique_keys[cur_offset++] = g->map->keys[i];
+} // end parallel
+
+  free(thread_offsets);
+
   g->n_ghost = g->map->num_unique;
   g->n_total = g->n_ghost + g->n_local;
 
@@ -611,41 +685,76 @@ int relabel_edges(dist_graph_t *g, uint64_t* vert_dist)
   if (g->n_ghost > 0) {
     g->ghost_unmap = (uint64_t*)malloc(g->n_ghost*sizeof(uint64_t));
     g->ghost_tasks = (uint64_t*)malloc(g->n_ghost*sizeof(uint64_t));
-    if (g->ghost_unmap == NULL || g->ghost_tasks == NULL)
+    uint64_t* task_offsets = (uint64_t*)malloc((nprocs+1)*sizeof(uint64_t));
+    uint64_t* task_cursors = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+    if (g->ghost_unmap == NULL || g->ghost_tasks == NULL || 
+        task_offsets == NULL || task_cursors == NULL)
       throw_err("relabel_edges(), unable to allocate ghost unmaps", procid);
 
+    uint64_t n_per_rank = g->n / (uint64_t)nprocs + 1;
+
+#pragma omp parallel for
+    for (int32_t i = 0; i < nprocs+1; ++i)
+      task_offsets[i] = 0;
+
+    // Tasks own contiguous ranges of ids, so grouping the ghosts by task
+    // and sorting each group labels them in global id order
 #pragma omp parallel for
     for (uint64_t i = 0; i < g->n_ghost; ++i)
     {
-      uint64_t cur_index = get_value(g->map, g->map->unique_keys[i]);
-
-      cur_index -= g->n_local;
-      g->ghost_unmap[cur_index] = g->map->unique_keys[i];
+      uint64_t global_id = g->map->unique_keys[i];
+      if (vert_dist == NULL)
+        g->ghost_tasks[i] = global_id / n_per_rank;
+      else
+        g->ghost_tasks[i] = highest_less_than(vert_dist, global_id);
+#pragma omp atomic
+      ++task_offsets[g->ghost_tasks[i]+1];
     }
 
-    if (vert_dist == NULL)
+    for (int32_t i = 0; i < nprocs; ++i)
     {
-      uint64_t n_per_rank = g->n / (uint64_t)nprocs + 1;  
+      task_offsets[i+1] += task_offsets[i];
+      task_cursors[i] = task_offsets[i];
+    }
 
 #pragma omp parallel for
-      for (uint64_t i = 0; i < g->n_ghost; ++i)
-        g->ghost_tasks[i] = g->ghost_unmap[i] / n_per_rank;
+    for (uint64_t i = 0; i < g->n_ghost; ++i)
+    {
+      uint64_t index;
+#pragma omp atomic capture
+      index = task_cursors[g->ghost_tasks[i]]++;
+      g->ghost_unmap[index] = g->map->unique_keys[i];
     }
-    else
+
+#pragma omp parallel for schedule(dynamic)
+    for (int32_t i = 0; i < nprocs; ++i)
     {
- #pragma omp parallel for
+      if (task_offsets[i+1] > task_offsets[i] + 1)
+        quicksort_inc(g->ghost_unmap, 
+                      (int64_t)task_offsets[i], (int64_t)task_offsets[i+1]-1);
+      for (uint64_t j = task_offsets[i]; j < task_offsets[i+1]; ++j)
+        g->ghost_tasks[j] = i;
+    }
+
+#pragma omp parallel for
     for (uint64_t i = 0; i < g->n_ghost; ++i)
-      {   
-        uint64_t global_id = g->ghost_unmap[i];
-        int32_t rank = highest_less_than(vert_dist, global_id);
-        g->ghost_tasks[i] = rank;
-      }
+    {
+      uint64_t index = get_index(g->map, g->ghost_unmap[i]);
+      g->map->values[index] = g->n_local + i;
+      g->map->unique_keys[i] = g->ghost_unmap[i];
+      g->map->unique_indexes[i] = index;
     }
+
+    free(task_offsets);
+    free(task_cursors);
   } else {
     g->ghost_unmap = NULL;
     g->ghost_tasks = NULL;
   }
 
+  get_values(g->map, g->global_out_edges, g->global_out_edges, g->m_local);
+  set_local_edges(g, g->global_out_edges);
+
   if (verbose) {
     elt = omp_get_wtime() - elt;
     printf(" Task %d relabel_edges() %9.6f (s)\n", procid, elt); 
@@ -656,6 +765,41 @@ int relabel_edges(dist_graph_t *g, uint64_t* vert_dist)
 }
 
 
+// Orders each adjacency list by neighbor index, so a vertex's neighbors
+// are read front to back through the vertex arrays
+int sort_adjacencies(dist_graph_t *g)
+{
+  if (debug) { printf("Task %d sort_adjacencies() start\n", procid); }
+  double elt = 0.0;
+  if (verbose) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+#pragma omp parallel for schedule(guided)
+  for (uint64_t i = 0; i < g->n_local; ++i)
+  {
+    int64_t begin = (int64_t)g->out_degree_list[i];
+    int64_t end = (int64_t)g->out_degree_list[i+1];
+    if (end - begin < 2)
+      continue;
+
+    if (g->edge_weights != NULL)
+      quicksort_inc(g->out_edges, g->edge_weights, begin, end-1);
+    else
+      quicksort_inc(g->out_edges, begin, end-1);
+  }
+
+  if (verbose) {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d sort_adjacencies() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug) { printf("Task %d sort_adjacencies() success\n", procid); }
+  return 0;
+}
+
+
 // Below is for testing only
 int set_weights_graph(dist_graph_t *g)
 {
@@ -689,7 +833,7 @@ int set_weights_graph(dist_graph_t *g)
 
   if (g->num_vert_weights > 2) {
     uint64_t sum_neighbors = 0;
-    uint64_t* outs = out_vertices(g, v);
+    lid_t* outs = out_vertices(g, v);
     for (uint64_t i = 0; i < out_degree(g, v); ++i)
       if (outs[i] < g->n_local)
         sum_neighbors += out_degree(g, outs[i]);
@@ -790,13 +934,15 @@ int get_ghost_degrees(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q)
 {
   if (debug) { printf("Task %d get_ghost_degrees() start\n", procid); }
 
+  init_neighbor_comm(g, comm);
+
   g->ghost_degrees = (uint64_t*)malloc(g->n_ghost*(sizeof(uint64_t)));
   if (g->ghost_degrees == NULL)
     throw_err("get_ghost_degrees(), unable to allocate ghost degrees\n", procid);
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
 #pragma omp parallel 
 {
@@ -807,10 +953,11 @@ int get_ghost_degrees(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q)
 
 #pragma omp for schedule(guided) nowait
   for (uint64_t i = 0; i < g->n_local; ++i)
-    update_sendcounts_thread(g, &tc, i);
+    update_sendcounts_thread(g, &tc, comm, i);
 
-  for (int32_t i = 0; i < nprocs; ++i)
+  for (int32_t n = 0; n < comm->num_dests; ++n)
   {
+    int32_t i = comm->dests[n];
 #pragma omp atomic
     comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -840,10 +987,10 @@ int get_ghost_degrees(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q)
 #pragma omp for
   for (uint64_t i = 0; i < comm->total_recv; ++i)
   {
-    uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
+    uint64_t index = g->n_local + recv_vert(comm, i);
     assert(index >= g->n_local);
     assert(index < g->n_total);
-    g->ghost_degrees[index - g->n_local] = comm->recvbuf_data[i];
+    g->ghost_degrees[index - g->n_local] = recv_data(comm, i);
   }
 
 #pragma omp single
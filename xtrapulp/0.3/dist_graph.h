@@ -79,12 +79,22 @@ struct graph_gen_data_t {
   uint64_t num_edge_weights;
 };
 
+void set_local_edges(dist_graph_t* g, uint64_t* edges);
+
+void build_csr(uint64_t n_local, uint64_t n_offset, uint64_t m_local,
+               uint64_t* gen_edges, uint64_t stride, int32_t* weights_in,
+               uint64_t* out_edges, uint64_t* out_degree_list, 
+               int32_t* edge_weights);
+
 int create_graph(graph_gen_data_t *ggi, dist_graph_t *g);
 int create_graph_weighted(graph_gen_data_t *ggi, dist_graph_t *g);
 
 int create_graph_serial(graph_gen_data_t *ggi, dist_graph_t *g);
 int create_graph_serial_weighted(graph_gen_data_t *ggi, dist_graph_t *g);
 
+// The graph takes over local_offsets and local_adjs, clear_graph() frees
+// them; set g->caller_edges first, true when local_adjs must stay intact
+// until then rather than being freed once narrowed to 32-bit indexes
 int create_graph(dist_graph_t* g, 
           uint64_t n_global, uint64_t m_global, 
           uint64_t n_local, uint64_t m_local,
@@ -105,6 +115,8 @@ int relabel_edges(dist_graph_t *g);
 
 int relabel_edges(dist_graph_t* g, uint64_t* verts_per_rank);
 
+int sort_adjacencies(dist_graph_t *g);
+
 int set_weights_graph(dist_graph_t *g);
 
 int get_max_degree_vert(dist_graph_t *g);
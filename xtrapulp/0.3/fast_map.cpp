@@ -60,49 +60,64 @@ void init_map(fast_map* map, uint64_t init_size)
 {
   if (debug) { printf("Task %d init_map() start\n", procid); }
 
-  map->arr = (uint64_t*)malloc(init_size*2*sizeof(uint64_t));
+  uint64_t capacity = 1;
+  while (capacity < init_size)
+    capacity *= 2;
+
+  map->keys = (uint64_t*)malloc(capacity*sizeof(uint64_t));
+  map->values = (uint64_t*)malloc(capacity*sizeof(uint64_t));
   map->unique_keys = (uint64_t*)malloc(init_size*sizeof(uint64_t));
   map->unique_indexes = (uint64_t*)malloc(init_size*sizeof(uint64_t));
-  if (map->arr == NULL || map->unique_keys == NULL || 
-      map->unique_indexes == NULL)
+  if (map->keys == NULL || map->values == NULL || 
+      map->unique_keys == NULL || map->unique_indexes == NULL)
     throw_err("init_map(), unable to allocate resources\n", procid);
 
-  map->capacity = init_size;
+  set_map_capacity(map, capacity);
   map->num_unique = 0;
   map->hashing = true;
   
 #pragma omp parallel for
   for (uint64_t i = 0; i < map->capacity; ++i)
-    map->arr[i*2] = NULL_KEY;
+    map->keys[i] = NULL_KEY;
 
   if (debug) { printf("Task %d init_map() success\n", procid); }
 }
 
+// Local ids are their own indexes, so lookups return the key as is
 void init_map_nohash(fast_map* map, uint64_t init_size)
 {
   if (debug) { printf("Task %d init_map_nohash() start\n", procid); }
 
-  map->arr = (uint64_t*)malloc(init_size*sizeof(uint64_t));
-  map->unique_keys = (uint64_t*)malloc(init_size*sizeof(uint64_t));
-  map->unique_indexes = (uint64_t*)malloc(init_size*sizeof(uint64_t));
-  if (map->arr == NULL || map->unique_keys == NULL || 
-      map->unique_indexes == NULL)
-    throw_err("init_map(), unable to allocate resources\n", procid);
-
+  map->keys = NULL;
+  map->values = NULL;
+  map->unique_keys = NULL;
+  map->unique_indexes = NULL;
   map->capacity = init_size;
+  map->mask = 0;
+  map->shift = 0;
   map->num_unique = 0;
   map->hashing = false;
-
-#pragma omp parallel for
-  for (uint64_t i = 0; i < map->capacity; ++i)
-    map->arr[i] = i; 
   
   if (debug) { printf("Task %d init_map_nohash() success\n", procid); }
 }
 
+// Capacity is a power of two when hashing
+void set_map_capacity(fast_map* map, uint64_t capacity)
+{
+  map->capacity = capacity;
+  map->mask = capacity - 1;
+  map->shift = 64;
+  while (capacity > 1)
+  {
+    capacity /= 2;
+    --map->shift;
+  }
+}
+
 void clear_map(fast_map* map)
 {
-  free(map->arr);
+  free(map->keys);
+  free(map->values);
   free(map->unique_keys);
   free(map->unique_indexes);
 
@@ -113,7 +128,38 @@ void clear_map(fast_map* map)
 void empty_map(fast_map* map)
 {
   for (uint64_t i = 0; i < map->num_unique; ++i)
-    map->arr[map->unique_indexes[i]] = NULL_KEY;
+    map->keys[map->unique_indexes[i]] = NULL_KEY;
 
   map->num_unique = 0;
 }
+
+// Looks up n keys, prefetching the slots of keys a few iterations ahead.
+// Each thread prefetches only within its own range, so out may be keys.
+void get_values(fast_map* map, uint64_t* keys, uint64_t* out, uint64_t n)
+{
+  if (!map->hashing)
+  {
+    if (out != keys)
+    {
+#pragma omp parallel for
+      for (uint64_t i = 0; i < n; ++i)
+        out[i] = keys[i];
+    }
+    return;
+  }
+
+#pragma omp parallel
+{
+  uint64_t num_threads = (uint64_t)omp_get_num_threads();
+  uint64_t tid = (uint64_t)omp_get_thread_num();
+  uint64_t begin = n*tid / num_threads;
+  uint64_t end = n*(tid+1) / num_threads;
+
+  for (uint64_t i = begin; i < end; ++i)
+  {
+    if (i + MAP_PREFETCH_DISTANCE < end)
+      prefetch_value(map, keys[i + MAP_PREFETCH_DISTANCE]);
+    out[i] = get_value(map, keys[i]);
+  }
+} // end parallel
+}
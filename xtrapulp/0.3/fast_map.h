@@ -55,88 +55,144 @@ extern int procid, nprocs;
 extern bool verbose, debug, verify;
 
 #define NULL_KEY 18446744073709551615U
+#define MAP_PREFETCH_DISTANCE 16
 
+// Open addressing with linear probing over a power of two table. Keys and
+// values are kept in separate arrays, so a probe sequence walks contiguous
+// keys. Without hashing the map is the identity and holds no tables.
 struct fast_map {
-  uint64_t* arr;
+  uint64_t* keys;
+  uint64_t* values;
   uint64_t* unique_keys;
   uint64_t* unique_indexes;
   uint64_t capacity;
+  uint64_t mask;
+  uint64_t shift;
   uint64_t num_unique;
   bool hashing;
 } ;
 
 void init_map(fast_map* map, uint64_t init_size);
 void init_map_nohash(fast_map* map, uint64_t init_size);
+void set_map_capacity(fast_map* map, uint64_t capacity);
 void clear_map(fast_map* map);
 void empty_map(fast_map* map);
+void get_values(fast_map* map, uint64_t* keys, uint64_t* out, uint64_t n);
 
 inline uint64_t mult_hash(fast_map* map, uint64_t key);
+inline void prefetch_value(fast_map* map, uint64_t key);
 inline void set_value(fast_map* map, uint64_t key, uint64_t value);
 inline void set_value_uq(fast_map* map, uint64_t key, uint64_t value);
+inline uint64_t insert_key_atomic(fast_map* map, uint64_t key, bool* inserted);
 inline uint64_t get_value(fast_map* map, uint64_t key);
+inline uint64_t get_index(fast_map* map, uint64_t key);
 inline uint64_t get_max_key(fast_map* map);
 
+// Fibonacci hashing, the high bits of the product index the table
 inline uint64_t mult_hash(fast_map* map, uint64_t key)
 {
   if (map->hashing)
-    return (key*(uint64_t)2654435761 % map->capacity);
+    return (key*(uint64_t)11400714819323198485ULL) >> map->shift;
   else
     return key;
 }
 
+inline void prefetch_value(fast_map* map, uint64_t key)
+{
+  if (!map->hashing) return;
+
+  uint64_t cur_index = mult_hash(map, key);
+  __builtin_prefetch(&map->keys[cur_index]);
+  __builtin_prefetch(&map->values[cur_index]);
+}
+
 inline void set_value(fast_map* map, uint64_t key, uint64_t value)
 {
-  uint64_t cur_index = mult_hash(map, key)*2;
+  uint64_t cur_index = mult_hash(map, key);
   uint64_t count = 0;
-  while (map->arr[cur_index] != key && map->arr[cur_index] != NULL_KEY)
+  while (map->keys[cur_index] != key && map->keys[cur_index] != NULL_KEY)
   {
-    cur_index = (cur_index + 2) % (map->capacity*2);
+    cur_index = (cur_index + 1) & map->mask;
     ++count;
     if (debug && count % 100 == 0)
       fprintf(stderr, "Warning: fast_map set_value(): Big Count %d -- %lu - %lu, %lu, %lu\n", 
               procid, count, cur_index, key, value);
   }
-  if (map->arr[cur_index] == NULL_KEY)
+  if (map->keys[cur_index] == NULL_KEY)
   {  
-    map->arr[cur_index] = key;
+    map->keys[cur_index] = key;
   }
-  map->arr[cur_index+1] = value;
+  map->values[cur_index] = value;
 }
 
 inline void set_value_uq(fast_map* map, uint64_t key, uint64_t value)
 {
-  uint64_t cur_index = mult_hash(map, key)*2;
+  uint64_t cur_index = mult_hash(map, key);
   uint64_t count = 0;
-  while (map->arr[cur_index] != key && map->arr[cur_index] != NULL_KEY)
+  while (map->keys[cur_index] != key && map->keys[cur_index] != NULL_KEY)
   {
-    cur_index = (cur_index + 2) % (map->capacity*2);
+    cur_index = (cur_index + 1) & map->mask;
     ++count;
     if (debug && count % 100 == 0)
       fprintf(stderr, "Warning: fast_map set_value_uq(): Big Count %d -- %lu - %lu, %lu, %lu\n", 
               procid, count, cur_index, key, value);
   }
-  if (map->arr[cur_index] == NULL_KEY)
+  if (map->keys[cur_index] == NULL_KEY)
   {  
-    map->arr[cur_index] = key;
+    map->keys[cur_index] = key;
     map->unique_keys[map->num_unique] = key;
     map->unique_indexes[map->num_unique] = cur_index;
     ++map->num_unique;
   }
-  map->arr[cur_index+1] = value;
+  map->values[cur_index] = value;
 }
 
+// Claims a slot for key if it isn't there yet, safe for concurrent callers.
+// Values and the unique lists are left for the caller to fill in.
+inline uint64_t insert_key_atomic(fast_map* map, uint64_t key, bool* inserted)
+{
+  uint64_t cur_index = mult_hash(map, key);
+  while (true)
+  {
+    uint64_t cur_key;
+#pragma omp atomic read
+    cur_key = map->keys[cur_index];
+    if (cur_key == NULL_KEY)
+      cur_key = __sync_val_compare_and_swap(&map->keys[cur_index], 
+                                            NULL_KEY, key);
+    if (cur_key == NULL_KEY || cur_key == key)
+    {
+      *inserted = (cur_key == NULL_KEY);
+      return cur_index;
+    }
+    cur_index = (cur_index + 1) & map->mask;
+  }
+}
 
 inline uint64_t get_value(fast_map* map, uint64_t key)
 {
-  if (!map->hashing) return map->arr[key];
+  if (!map->hashing) return key;
+  
+  uint64_t cur_index = mult_hash(map, key);
+  while (map->keys[cur_index] != key && map->keys[cur_index] != NULL_KEY)
+    cur_index = (cur_index + 1) & map->mask;
+  if (map->keys[cur_index] == NULL_KEY)
+    return NULL_KEY;
+  else
+    return map->values[cur_index];
+}
+
+inline uint64_t get_index(fast_map* map, uint64_t key)
+{
+  if (!map->hashing) return key;
   
-  uint64_t cur_index = mult_hash(map, key)*2;
-  while (map->arr[cur_index] != key && map->arr[cur_index] != NULL_KEY)
-    cur_index = (cur_index + 2) % (map->capacity*2);
-  if (map->arr[cur_index] == NULL_KEY)
+  uint64_t cur_index = mult_hash(map, key);
+  while (map->keys[cur_index] != key && map->keys[cur_index] != NULL_KEY)
+    cur_index = (cur_index + 1) & map->mask;
+  if (map->keys[cur_index] == NULL_KEY)
     return NULL_KEY;
   else
-    return map->arr[cur_index+1];
+    return cur_index;
 }
 
 inline uint64_t get_max_key(fast_map* map)
@@ -144,10 +200,10 @@ inline uint64_t get_max_key(fast_map* map)
   uint64_t max_val = 0;
   uint64_t max_key = NULL_KEY;
   for (uint64_t i = 0; i < map->num_unique; ++i)
-    if (map->arr[map->unique_indexes[i]+1] > max_val)
+    if (map->values[map->unique_indexes[i]] > max_val)
     {
-      max_val = map->arr[map->unique_indexes[i]+1];
-      max_key = map->arr[map->unique_indexes[i]];
+      max_val = map->values[map->unique_indexes[i]];
+      max_key = map->keys[map->unique_indexes[i]];
     }
 
   return max_key;
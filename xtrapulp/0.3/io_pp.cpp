@@ -48,8 +48,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <math.h>
 #include <limits>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
@@ -175,6 +181,295 @@ int load_graph_edges_32(char *input_filename, graph_gen_data_t *ggi,
   return 0;
 }
 
+int stream_edges_pass(int fd, uint64_t edge_start, uint64_t nedges,
+                      uint64_t num_chunks, uint64_t n_per_rank,
+                      uint64_t n_offset, uint64_t *local_counts,
+                      uint64_t *out_edges)
+{
+  // Counting pass ships single endpoints, filling pass ships (src, dst)
+  bool fill = (out_edges != NULL);
+  uint64_t per_endpoint = fill ? 2 : 1;
+
+  uint32_t *read_buf =
+      (uint32_t *)malloc(2 * EDGE_CHUNK_SIZE * sizeof(uint32_t));
+  uint64_t *sendbuf[2];
+  uint64_t *recvbuf[2] = {NULL, NULL};
+  uint64_t recv_capacity[2] = {0, 0};
+  int32_t *sendcounts[2];
+  int32_t *recvcounts[2];
+  int32_t *sdispls[2];
+  int32_t *rdispls[2];
+  int32_t *sdispls_cpy = (int32_t *)malloc(nprocs * sizeof(int32_t));
+  for (int32_t b = 0; b < 2; ++b)
+  {
+    sendbuf[b] = (uint64_t *)malloc(2 * per_endpoint * EDGE_CHUNK_SIZE *
+                                    sizeof(uint64_t));
+    sendcounts[b] = (int32_t *)malloc(nprocs * sizeof(int32_t));
+    recvcounts[b] = (int32_t *)malloc(nprocs * sizeof(int32_t));
+    sdispls[b] = (int32_t *)malloc((nprocs + 1) * sizeof(int32_t));
+    rdispls[b] = (int32_t *)malloc((nprocs + 1) * sizeof(int32_t));
+    if (sendbuf[b] == NULL || sendcounts[b] == NULL ||
+        recvcounts[b] == NULL || sdispls[b] == NULL || rdispls[b] == NULL)
+      throw_err("stream_edges_pass(), unable to allocate buffers", procid);
+  }
+  if (read_buf == NULL || sdispls_cpy == NULL)
+    throw_err("stream_edges_pass(), unable to allocate buffers", procid);
+
+  MPI_Request request = MPI_REQUEST_NULL;
+  int32_t pending = -1;
+  for (uint64_t c = 0; c <= num_chunks; ++c)
+  {
+    int32_t b = (int32_t)(c % 2);
+    if (c < num_chunks)
+    {
+      // Read and pack this chunk while the previous one is still in flight
+      uint64_t chunk_start = c * EDGE_CHUNK_SIZE;
+      uint64_t count = 0;
+      if (chunk_start < nedges)
+        count = (nedges - chunk_start) < EDGE_CHUNK_SIZE ?
+                (nedges - chunk_start) : EDGE_CHUNK_SIZE;
+      if (pread_full(fd, (char *)read_buf, count * 2 * sizeof(uint32_t),
+                     (edge_start + chunk_start) * 2 * sizeof(uint32_t)))
+        throw_err("stream_edges_pass(), unable to read input file", procid);
+
+      for (int32_t i = 0; i < nprocs; ++i)
+        sendcounts[b][i] = 0;
+      for (uint64_t i = 0; i < count * 2; ++i)
+        sendcounts[b][read_buf[i] / n_per_rank] += (int32_t)per_endpoint;
+
+      sdispls[b][0] = 0;
+      for (int32_t i = 0; i < nprocs; ++i)
+      {
+        sdispls[b][i + 1] = sdispls[b][i] + sendcounts[b][i];
+        sdispls_cpy[i] = sdispls[b][i];
+      }
+
+      for (uint64_t i = 0; i < count * 2; i += 2)
+      {
+        uint64_t vert1 = (uint64_t)read_buf[i];
+        uint64_t vert2 = (uint64_t)read_buf[i + 1];
+        int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
+        int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
+
+        sendbuf[b][sdispls_cpy[vert_task1]++] = vert1;
+        if (fill)
+          sendbuf[b][sdispls_cpy[vert_task1]++] = vert2;
+        sendbuf[b][sdispls_cpy[vert_task2]++] = vert2;
+        if (fill)
+          sendbuf[b][sdispls_cpy[vert_task2]++] = vert1;
+      }
+
+      MPI_Alltoall(sendcounts[b], 1, MPI_INT32_T,
+                   recvcounts[b], 1, MPI_INT32_T, MPI_COMM_WORLD);
+
+      rdispls[b][0] = 0;
+      for (int32_t i = 0; i < nprocs; ++i)
+        rdispls[b][i + 1] = rdispls[b][i] + recvcounts[b][i];
+
+      uint64_t total_recv = (uint64_t)rdispls[b][nprocs];
+      if (total_recv > recv_capacity[b])
+      {
+        free(recvbuf[b]);
+        recvbuf[b] = (uint64_t *)malloc(total_recv * sizeof(uint64_t));
+        recv_capacity[b] = total_recv;
+        if (recvbuf[b] == NULL)
+          throw_err("stream_edges_pass(), unable to allocate recv buffer",
+                    procid);
+      }
+    }
+
+    // Finish the previous chunk's exchange and fold it into the CSR
+    if (pending >= 0)
+    {
+      MPI_Wait(&request, MPI_STATUS_IGNORE);
+      uint64_t *recv = recvbuf[pending];
+      uint64_t total_recv = (uint64_t)rdispls[pending][nprocs];
+      if (fill)
+      {
+        for (uint64_t i = 0; i < total_recv; i += 2)
+          out_edges[local_counts[recv[i] - n_offset]++] = recv[i + 1];
+      }
+      else
+      {
+#pragma omp parallel for
+        for (uint64_t i = 0; i < total_recv; ++i)
+        {
+#pragma omp atomic
+          ++local_counts[recv[i] - n_offset];
+        }
+      }
+      pending = -1;
+    }
+
+    if (c < num_chunks)
+    {
+      MPI_Ialltoallv(sendbuf[b], sendcounts[b], sdispls[b], MPI_UINT64_T,
+                     recvbuf[b], recvcounts[b], rdispls[b], MPI_UINT64_T,
+                     MPI_COMM_WORLD, &request);
+      pending = b;
+    }
+  }
+
+  free(read_buf);
+  free(sdispls_cpy);
+  for (int32_t b = 0; b < 2; ++b)
+  {
+    free(sendbuf[b]);
+    free(recvbuf[b]);
+    free(sendcounts[b]);
+    free(recvcounts[b]);
+    free(sdispls[b]);
+    free(rdispls[b]);
+  }
+
+  return 0;
+}
+
+int load_graph_streaming_32(char *input_filename, dist_graph_t *g,
+                            bool offset_vids)
+{
+  if (debug)
+  {
+    printf("Task %d load_graph_streaming_32() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  if (offset_vids)
+    throw_err("load_graph_streaming_32(), offset vids not supported", procid);
+
+  int fd = open(input_filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("load_graph_streaming_32() unable to open input file", procid);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throw_err("load_graph_streaming_32() unable to stat input file", procid);
+
+  // Same edge split across tasks as load_graph_edges_32()
+  uint64_t nedges_global = (uint64_t)st.st_size / (2 * sizeof(uint32_t));
+  uint64_t edge_start = (uint64_t)procid * (nedges_global / nprocs);
+  uint64_t edge_end = (uint64_t)(procid + 1) * (nedges_global / nprocs);
+  if (procid == nprocs - 1)
+    edge_end = nedges_global;
+  uint64_t nedges = edge_end - edge_start;
+
+  uint64_t num_chunks = (nedges + EDGE_CHUNK_SIZE - 1) / EDGE_CHUNK_SIZE;
+  MPI_Allreduce(MPI_IN_PLACE, &num_chunks, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+  // The edge list carries no header, so one read-only pass finds n before
+  // any edge can be routed to its owner
+  uint32_t *read_buf =
+      (uint32_t *)malloc(2 * EDGE_CHUNK_SIZE * sizeof(uint32_t));
+  if (read_buf == NULL)
+    throw_err("load_graph_streaming_32(), unable to allocate buffer", procid);
+
+  uint64_t max_vid = 0;
+  for (uint64_t chunk_start = 0; chunk_start < nedges;
+       chunk_start += EDGE_CHUNK_SIZE)
+  {
+    uint64_t count = (nedges - chunk_start) < EDGE_CHUNK_SIZE ?
+                     (nedges - chunk_start) : EDGE_CHUNK_SIZE;
+    if (pread_full(fd, (char *)read_buf, count * 2 * sizeof(uint32_t),
+                   (edge_start + chunk_start) * 2 * sizeof(uint32_t)))
+      throw_err("load_graph_streaming_32(), unable to read input file",
+                procid);
+
+#pragma omp parallel for reduction(max : max_vid)
+    for (uint64_t i = 0; i < count * 2; ++i)
+      if (read_buf[i] > max_vid)
+        max_vid = read_buf[i];
+  }
+  free(read_buf);
+
+  MPI_Allreduce(MPI_IN_PLACE, &max_vid, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+  uint64_t n_global = max_vid + 1;
+  uint64_t n_per_rank = n_global / (uint64_t)nprocs + 1;
+  uint64_t n_offset = (uint64_t)procid * n_per_rank;
+  if (n_offset > n_global)
+    n_offset = n_global;
+  uint64_t n_local = n_global - n_offset;
+  if (n_local > n_per_rank)
+    n_local = n_per_rank;
+
+  // Second pass counts degrees, third pass places edges straight into the
+  // final CSR, so only the offsets are held beyond the graph itself
+  uint64_t *out_degree_list =
+      (uint64_t *)malloc((n_local + 1) * sizeof(uint64_t));
+  uint64_t *temp_counts = (uint64_t *)malloc(n_local * sizeof(uint64_t));
+  if (out_degree_list == NULL || (temp_counts == NULL && n_local > 0))
+    throw_err("load_graph_streaming_32(), unable to allocate offsets",
+              procid);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < n_local; ++i)
+    temp_counts[i] = 0;
+
+  stream_edges_pass(fd, edge_start, nedges, num_chunks, n_per_rank,
+                    n_offset, temp_counts, NULL);
+
+  out_degree_list[0] = 0;
+  for (uint64_t i = 0; i < n_local; ++i)
+    out_degree_list[i + 1] = out_degree_list[i] + temp_counts[i];
+  memcpy(temp_counts, out_degree_list, n_local * sizeof(uint64_t));
+
+  uint64_t m_local = out_degree_list[n_local];
+  uint64_t *out_edges = (uint64_t *)malloc(m_local * sizeof(uint64_t));
+  if (out_edges == NULL && m_local > 0)
+    throw_err("load_graph_streaming_32(), unable to allocate edges", procid);
+
+  stream_edges_pass(fd, edge_start, nedges, num_chunks, n_per_rank,
+                    n_offset, temp_counts, out_edges);
+  close(fd);
+  free(temp_counts);
+
+  g->caller_edges = false;
+  if (nprocs > 1)
+  {
+    uint64_t *global_ids = (uint64_t *)malloc(n_local * sizeof(uint64_t));
+    if (global_ids == NULL && n_local > 0)
+      throw_err("load_graph_streaming_32(), unable to allocate ids", procid);
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < n_local; ++i)
+      global_ids[i] = n_offset + i;
+
+    create_graph(g, n_global, nedges_global, n_local, m_local,
+                 out_degree_list, out_edges, global_ids, 0, NULL, NULL);
+    g->n_offset = n_offset;
+    free(global_ids);
+    relabel_edges(g);
+  }
+  else
+  {
+    create_graph_serial(g, n_global, nedges_global, n_local, m_local,
+                        out_degree_list, out_edges, 0, NULL, NULL);
+  }
+
+  if (verbose)
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d load_graph_streaming_32() read %lu edges, "
+           "n_local %lu, m_local %lu, %9.6f (s)\n",
+           procid, nedges, n_local, m_local, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d load_graph_streaming_32() success\n", procid);
+  }
+
+  return 0;
+}
+
 int load_graph_edges_64(char *input_filename, graph_gen_data_t *ggi,
                         bool offset_vids)
 {
@@ -283,6 +578,14 @@ int load_graph_edges_64(char *input_filename, graph_gen_data_t *ggi,
 
 int scale_weights(uint64_t n, uint64_t num_weights,
                   float *weights_in, int32_t *weights_out)
+{
+  scale_weights(n, num_weights, weights_in, weights_out, false);
+
+  return 0;
+}
+
+int scale_weights(uint64_t n, uint64_t num_weights,
+                  float *weights_in, int32_t *weights_out, bool global_scale)
 {
   const double INT_EPSILON = 1e-5;
 
@@ -318,6 +621,18 @@ int scale_weights(uint64_t n, uint64_t num_weights,
     }
   }
 
+  // Each task only holds a slice of the weights, so the integer check and
+  // the scale factor have to be computed from the global sums and maxes
+  if (global_scale)
+  {
+    MPI_Allreduce(MPI_IN_PLACE, nonint, (int32_t)num_weights,
+                  MPI_INT32_T, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, sum_weights, (int32_t)num_weights,
+                  MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, max_weights, (int32_t)num_weights,
+                  MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  }
+
   const double max_weight_sum = double(std::numeric_limits<int>::max() / 8);
   for (uint64_t j = 0; j < num_weights; j++)
   {
@@ -347,339 +662,1256 @@ int scale_weights(uint64_t n, uint64_t num_weights,
   return 0;
 }
 
-int read_adj(char *input_filename,
-             graph_gen_data_t *ggi, bool offset_vids)
+int pread_full(int fd, char *buf, uint64_t count, uint64_t offset)
 {
-  std::ifstream infile;
-  std::string line;
-  std::string val;
-
-  float *tmp_vert_weights = NULL;
-  float *tmp_edge_weights = NULL;
-  ggi->gen_edges = (uint64_t *)malloc((ggi->m) * sizeof(uint64_t));
-  ggi->edge_weights_sum = 0;
-  ggi->max_edge_weight = 0;
-  if (ggi->num_edge_weights == 0 && ggi->num_vert_weights == 0)
-  {
-    // unweighted
-    ggi->vert_weights = NULL;
-    ggi->edge_weights = NULL;
-    ggi->vert_weights_sums = NULL;
-    ggi->max_vert_weights = NULL;
-  }
-  else if (ggi->num_vert_weights == 0)
-  {
-    // edge weights but no vertex weights
-    tmp_vert_weights = (float *)malloc(ggi->n * sizeof(float));
-    tmp_edge_weights = (float *)malloc(ggi->n * sizeof(float));
-    ggi->vert_weights = (int32_t *)malloc(ggi->n * sizeof(int32_t));
-    ggi->vert_weights_sums = (int64_t *)malloc(sizeof(int64_t));
-    ggi->edge_weights = (int32_t *)malloc(ggi->m / 2 * sizeof(int32_t));
-    ggi->max_vert_weights =
-        (int32_t *)malloc(ggi->num_vert_weights * sizeof(int32_t));
-    ggi->max_vert_weights[0] = 1;
-    ggi->vert_weights_sums[0] = 0;
+  while (count > 0)
+  {
+    ssize_t bytes = pread(fd, buf, count, (off_t)offset);
+    if (bytes < 0 && errno == EINTR)
+      continue;
+    if (bytes <= 0)
+      return 1;
+
+    buf += bytes;
+    count -= (uint64_t)bytes;
+    offset += (uint64_t)bytes;
   }
-  else
+
+  return 0;
+}
+
+uint64_t find_line_start(int fd, uint64_t pos, uint64_t begin, uint64_t end)
+{
+  if (pos <= begin)
+    return begin;
+  if (pos >= end)
+    return end;
+
+  // A line belongs to whoever holds its first byte, so start looking at the
+  // byte before pos in case pos itself already begins a line
+  char buf[4096];
+  uint64_t cur = pos - 1;
+  while (cur < end)
   {
-    // vertex weights, maybe edge weights (will get set to unit weight if no)
-    tmp_vert_weights =
-        (float *)malloc(ggi->num_vert_weights * ggi->n * sizeof(float));
-    tmp_edge_weights =
-        (float *)malloc(ggi->m / 2 * sizeof(float));
-    ggi->vert_weights =
-        (int32_t *)malloc(ggi->num_vert_weights * ggi->n * sizeof(int32_t));
-    ggi->vert_weights_sums =
-        (int64_t *)malloc(ggi->num_vert_weights * sizeof(int64_t));
-    ggi->edge_weights = (int32_t *)malloc(ggi->m / 2 * sizeof(int32_t));
-    ggi->max_vert_weights =
-        (int32_t *)malloc(ggi->num_vert_weights * sizeof(int32_t));
-    for (uint64_t w = 0; w < ggi->num_vert_weights; ++w)
-    {
-      ggi->max_vert_weights[w] = 0;
-      ggi->vert_weights_sums[w] = 0;
-    }
+    uint64_t count = (end - cur) < 4096 ? (end - cur) : 4096;
+    if (pread_full(fd, buf, count, cur))
+      throw_err("find_line_start(), unable to read input file", procid);
+
+    char *newline = (char *)memchr(buf, '\n', count);
+    if (newline != NULL)
+      return cur + (uint64_t)(newline - buf) + 1;
+    cur += count;
   }
 
-  uint64_t count = 0;    // count for edges
-  uint64_t cur_line = 1; // count for vertices
+  return end;
+}
+
+inline bool is_blank(char c)
+{
+  return (c == ' ' || c == '\t' || c == '\r');
+}
+
+inline bool next_token(const char *&p, const char *end)
+{
+  while (p < end && is_blank(*p))
+    ++p;
+
+  return (p < end && *p != '\n');
+}
+
+inline void skip_token(const char *&p, const char *end)
+{
+  while (p < end && !is_blank(*p) && *p != '\n')
+    ++p;
+}
+
+inline uint64_t parse_uint(const char *&p, const char *end)
+{
+  uint64_t val = 0;
+  while (p < end && (uint8_t)(*p - '0') < 10)
+    val = val * 10 + (uint64_t)(*p++ - '0');
+  skip_token(p, end);
+
+  return val;
+}
+
+inline float parse_float(const char *&p, const char *end)
+{
+  // the read buffer is null terminated, so strtod can't run past it
+  char *tok_end = NULL;
+  float val = (float)strtod(p, &tok_end);
+  p = tok_end;
+  skip_token(p, end);
 
-  infile.open(input_filename);
-  getline(infile, line); // skip header
+  return val;
+}
 
+int read_adj_parallel(char *input_filename, graph_gen_data_t *ggi,
+                      bool offset_vids, uint64_t data_offset)
+{
   if (debug)
   {
-    printf("%d - reading n: %lu, m: %lu, nVwgt: %lu, nEwgt: %lu\n",
-           procid, ggi->n, ggi->m, ggi->num_vert_weights, ggi->num_edge_weights);
+    printf("Task %d read_adj_parallel() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
   }
 
-  while (getline(infile, line))
+  int fd = open(input_filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("read_adj_parallel() unable to open input file", procid);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throw_err("read_adj_parallel() unable to stat input file", procid);
+  uint64_t file_size = (uint64_t)st.st_size;
+  if (data_offset > file_size)
+    data_offset = file_size;
+
+  // Every task takes an even share of the bytes after the header, then
+  // snaps both ends forward to the next line start
+  uint64_t data_size = file_size - data_offset;
+  uint64_t read_begin = find_line_start(fd,
+      data_offset + (data_size * (uint64_t)procid) / (uint64_t)nprocs,
+      data_offset, file_size);
+  uint64_t read_end = file_size;
+  if (procid < nprocs - 1)
+    read_end = find_line_start(fd,
+        data_offset + (data_size * (uint64_t)(procid + 1)) / (uint64_t)nprocs,
+        data_offset, file_size);
+  uint64_t read_size = read_end - read_begin;
+
+  char *buf = (char *)malloc((read_size + 1) * sizeof(char));
+  if (buf == NULL)
+    throw_err("read_adj_parallel(), unable to allocate read buffer", procid);
+  if (pread_full(fd, buf, read_size, read_begin))
+    throw_err("read_adj_parallel(), unable to read input file", procid);
+  buf[read_size] = '\0';
+  close(fd);
+
+  uint64_t num_vert_weights_in = ggi->num_vert_weights;
+  uint64_t num_edge_weights_in = ggi->num_edge_weights;
+  bool weighted = (num_vert_weights_in > 0 || num_edge_weights_in > 0);
+  uint64_t num_vert_weights = num_vert_weights_in;
+  if (num_vert_weights == 0 && num_edge_weights_in > 0)
+    num_vert_weights = 1;
+
+  // Same line-snapping within the task buffer, one chunk per thread
+  int32_t num_threads = omp_get_max_threads();
+  uint64_t *thread_begin =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  uint64_t *thread_lines =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  uint64_t *thread_edges =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  if (thread_begin == NULL || thread_lines == NULL || thread_edges == NULL)
+    throw_err("read_adj_parallel(), unable to allocate thread offsets", procid);
+
+  thread_begin[0] = 0;
+  thread_begin[num_threads] = read_size;
+  for (int32_t t = 1; t < num_threads; ++t)
   {
-    uint64_t src = cur_line - 1;
-    uint64_t dst = NULL_KEY;
-    std::stringstream ss(line);
+    uint64_t pos = (read_size * (uint64_t)t) / (uint64_t)num_threads;
+    if (pos < thread_begin[t - 1])
+      pos = thread_begin[t - 1];
+    char *newline = NULL;
+    if (pos > 0 && pos < read_size)
+      newline = (char *)memchr(buf + pos - 1, '\n', read_size - pos + 1);
+    if (pos == 0)
+      thread_begin[t] = 0;
+    else if (newline == NULL)
+      thread_begin[t] = read_size;
+    else
+      thread_begin[t] = (uint64_t)(newline - buf) + 1;
+  }
 
-    for (uint64_t w = 0; w < ggi->num_vert_weights; ++w)
-    {
-      getline(ss, val, ' ');
-      double weight = (int32_t)atof(val.c_str());
-      tmp_vert_weights[(src * ggi->num_vert_weights) + w] = weight;
-    }
+  // First pass, count lines (vertices) and adjacencies per thread chunk
+#pragma omp parallel num_threads(num_threads)
+  {
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t num_lines = 0;
+    uint64_t num_edges = 0;
 
-    if (ggi->num_vert_weights == 0 && ggi->num_edge_weights > 0)
+    while (p < end)
     {
-      ggi->vert_weights[src] = 1;
+      uint64_t num_tokens = 0;
+      while (next_token(p, end))
+      {
+        ++num_tokens;
+        skip_token(p, end);
+      }
+      if (num_tokens > num_vert_weights_in)
+        num_edges += (num_tokens - num_vert_weights_in + num_edge_weights_in) /
+                     (1 + num_edge_weights_in);
+
+      ++num_lines;
+      if (p < end)
+        ++p;
     }
 
-    while (getline(ss, val, ' '))
-    {
-      dst = atoi(val.c_str()) - 1;
+    thread_lines[tid + 1] = num_lines;
+    thread_edges[tid + 1] = num_edges;
+  }
+
+  thread_lines[0] = 0;
+  thread_edges[0] = 0;
+  for (int32_t t = 0; t < num_threads; ++t)
+  {
+    thread_lines[t + 1] += thread_lines[t];
+    thread_edges[t + 1] += thread_edges[t];
+  }
+
+  uint64_t n_read = thread_lines[num_threads];
+  uint64_t m_read = thread_edges[num_threads];
+  uint64_t vert_start = 0;
+  MPI_Exscan(&n_read, &vert_start, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  if (procid == 0)
+    vert_start = 0;
+
+  uint64_t n_global = n_read;
+  uint64_t m_global = m_read;
+  MPI_Allreduce(MPI_IN_PLACE, &n_global, 1,
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &m_global, 1,
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  if (n_global != ggi->n)
+    throw_err("read_adj_parallel(), line count does not match header", procid);
+
+  float *tmp_vert_weights = NULL;
+  float *tmp_edge_weights = NULL;
+  ggi->gen_edges = (uint64_t *)malloc(m_read * 2 * sizeof(uint64_t));
+  if (ggi->gen_edges == NULL)
+    throw_err("read_adj_parallel(), unable to allocate edge buffer", procid);
+  if (weighted)
+  {
+    tmp_vert_weights =
+        (float *)malloc(n_read * num_vert_weights * sizeof(float));
+    tmp_edge_weights = (float *)malloc(m_read * sizeof(float));
+    if (tmp_vert_weights == NULL || tmp_edge_weights == NULL)
+      throw_err("read_adj_parallel(), unable to allocate weight buffers", procid);
+  }
 
-      float weight = 1.0;
+  // Second pass, fill in edges and weights at the precomputed offsets
+#pragma omp parallel num_threads(num_threads)
+  {
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t line = thread_lines[tid];
+    uint64_t edge = thread_edges[tid];
+
+    while (p < end)
+    {
+      uint64_t src = vert_start + line;
 
-      if (ggi->num_edge_weights > 0)
+      for (uint64_t w = 0; w < num_vert_weights_in; ++w)
       {
-        getline(ss, val, ' ');
-        weight = atof(val.c_str());
+        float weight = 0.0;
+        if (next_token(p, end))
+          weight = (float)(int32_t)parse_float(p, end);
+        tmp_vert_weights[line * num_vert_weights + w] = weight;
       }
+      if (num_vert_weights_in == 0 && num_edge_weights_in > 0)
+        tmp_vert_weights[line] = 1.0;
 
-      ggi->gen_edges[2 * count] = dst;
-      ggi->gen_edges[2 * count + 1] = src;
-      if (ggi->num_edge_weights > 0 || ggi->num_vert_weights > 0)
+      while (next_token(p, end))
       {
-        tmp_edge_weights[count] = weight;
+        uint64_t dst = parse_uint(p, end) - 1;
+
+        float weight = 1.0;
+        if (num_edge_weights_in > 0 && next_token(p, end))
+          weight = parse_float(p, end);
+
+        ggi->gen_edges[2 * edge] = dst;
+        ggi->gen_edges[2 * edge + 1] = src;
+        if (weighted)
+          tmp_edge_weights[edge] = weight;
+        ++edge;
       }
 
-      ++count;
+      ++line;
+      if (p < end)
+        ++p;
     }
-    ++cur_line;
   }
-  assert(cur_line == ggi->n + 1);
-  ggi->m = count * 2; // num edges after self-loop removal
-  infile.close();
+
+  free(buf);
+  free(thread_begin);
+  free(thread_lines);
+  free(thread_edges);
+
+  ggi->m = m_global * 2;
+  ggi->m_local_read = m_read;
+  ggi->m_local_edges = m_read;
+  ggi->edge_weights_sum = 0;
+  ggi->max_edge_weight = 0;
+  ggi->vert_weights = NULL;
+  ggi->edge_weights = NULL;
+  ggi->vert_weights_sums = NULL;
+  ggi->max_vert_weights = NULL;
 
   if (ggi->num_vert_weights > 0)
     ggi->num_edge_weights = 1; // in case was set to zero, for consistency
   else if (ggi->num_edge_weights > 0)
     ggi->num_vert_weights = 1; // same thing
 
-  if (ggi->num_vert_weights > 0)
+  int32_t *read_vert_weights = NULL;
+  if (weighted)
   {
-    scale_weights(ggi->n, ggi->num_vert_weights,
-                  tmp_vert_weights, ggi->vert_weights);
-    scale_weights(ggi->m / 2, ggi->num_edge_weights,
-                  tmp_edge_weights, ggi->edge_weights);
-    delete[] tmp_vert_weights;
-    delete[] tmp_edge_weights;
-
-    for (uint64_t i = 0; i < ggi->n; ++i)
+    read_vert_weights =
+        (int32_t *)malloc(n_read * num_vert_weights * sizeof(int32_t));
+    ggi->edge_weights = (int32_t *)malloc(m_read * sizeof(int32_t));
+    ggi->vert_weights_sums =
+        (int64_t *)malloc(num_vert_weights * sizeof(int64_t));
+    ggi->max_vert_weights =
+        (int32_t *)malloc(num_vert_weights * sizeof(int32_t));
+    if (read_vert_weights == NULL || ggi->edge_weights == NULL ||
+        ggi->vert_weights_sums == NULL || ggi->max_vert_weights == NULL)
+      throw_err("read_adj_parallel(), unable to allocate weights", procid);
+
+    scale_weights(n_read, num_vert_weights,
+                  tmp_vert_weights, read_vert_weights, true);
+    scale_weights(m_read, ggi->num_edge_weights,
+                  tmp_edge_weights, ggi->edge_weights, true);
+    free(tmp_vert_weights);
+    free(tmp_edge_weights);
+
+    for (uint64_t w = 0; w < num_vert_weights; ++w)
     {
-      for (uint64_t j = 0; j < ggi->num_vert_weights; ++j)
-      {
-        int32_t weight = ggi->vert_weights[i * ggi->num_vert_weights + j];
-        ggi->vert_weights_sums[j] += weight;
-        if (weight > ggi->max_vert_weights[j])
-          ggi->max_vert_weights[j] = weight;
-      }
+      ggi->vert_weights_sums[w] = 0;
+      ggi->max_vert_weights[w] = 0;
     }
-    for (uint64_t i = 0; i < ggi->m / 2; ++i)
+    for (uint64_t i = 0; i < n_read; ++i)
     {
-      ggi->edge_weights_sum += ggi->edge_weights[i];
+      for (uint64_t w = 0; w < num_vert_weights; ++w)
+      {
+        int32_t weight = read_vert_weights[i * num_vert_weights + w];
+        ggi->vert_weights_sums[w] += weight;
+        if (weight > ggi->max_vert_weights[w])
+          ggi->max_vert_weights[w] = weight;
+      }
     }
+    int64_t edge_weights_sum = 0;
+#pragma omp parallel for reduction(+ : edge_weights_sum)
+    for (uint64_t i = 0; i < m_read; ++i)
+      edge_weights_sum += ggi->edge_weights[i];
+    ggi->edge_weights_sum = edge_weights_sum;
+
+    MPI_Allreduce(MPI_IN_PLACE, ggi->vert_weights_sums, num_vert_weights,
+                  MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, ggi->max_vert_weights, num_vert_weights,
+                  MPI_INT32_T, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &ggi->edge_weights_sum, 1,
+                  MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
   }
 
+  uint64_t n_orig_per_rank = ggi->n / (uint64_t)nprocs + 1;
   if (offset_vids)
   {
-    uint64_t n_global = 0;
-#pragma omp parallel for reduction(max : n_global)
-    for (uint64_t i = 0; i < ggi->m; ++i)
+#pragma omp parallel for
+    for (uint64_t i = 0; i < m_read * 2; ++i)
     {
       uint64_t task_id = ggi->gen_edges[i] / (uint64_t)nprocs;
       uint64_t task = ggi->gen_edges[i] % (uint64_t)nprocs;
-      uint64_t task_offset = task * (ggi->n / (uint64_t)nprocs + 1);
-      uint64_t new_vid = task_offset + task_id;
-      ggi->gen_edges[i] = new_vid;
-      if (new_vid > n_global)
-        n_global = new_vid;
+      ggi->gen_edges[i] = task * n_orig_per_rank + task_id;
     }
-    n_global += 1;
-
-    int32_t *new_vert_weights =
-        (int32_t *)malloc(n_global * ggi->num_vert_weights * sizeof(int32_t));
-#pragma omp parallel for
-    for (uint64_t i = 0; i < n_global * ggi->num_vert_weights; ++i)
-      new_vert_weights[i] = 0;
 
-#pragma omp parallel for
-    for (uint64_t i = 0; i < ggi->n; ++i)
+    // largest remapped id is the last vertex id assigned to any task
+    uint64_t n_max = 0;
+    for (uint64_t task = 0; task < (uint64_t)nprocs && task < ggi->n; ++task)
     {
-      uint64_t task_id = i / (uint64_t)nprocs;
-      uint64_t task = i % (uint64_t)nprocs;
-      uint64_t task_offset = task * (ggi->n / (uint64_t)nprocs + 1);
-      uint64_t new_vid = task_offset + task_id;
-
-      for (uint64_t w = 0; w < ggi->num_vert_weights; ++w)
-      {
-        new_vert_weights[new_vid * ggi->num_vert_weights + w] =
-            ggi->vert_weights[i * ggi->num_vert_weights + w];
-      }
+      uint64_t task_id = (ggi->n - 1 - task) / (uint64_t)nprocs;
+      uint64_t new_vid = task * n_orig_per_rank + task_id;
+      if (new_vid > n_max)
+        n_max = new_vid;
     }
-    ggi->n = n_global;
-    free(ggi->vert_weights);
-    ggi->vert_weights = new_vert_weights;
+    ggi->n = n_max + 1;
   }
 
-  return 0;
-}
+  uint64_t n_per_rank = ggi->n / (uint64_t)nprocs + 1;
+  ggi->n_offset = (uint64_t)procid * n_per_rank;
+  ggi->n_local = n_per_rank;
+  if (procid == nprocs - 1)
+    ggi->n_local = ggi->n - ggi->n_offset;
 
-int read_graph(char *input_filename,
-               graph_gen_data_t *ggi, bool offset_vids)
-{
-  if (procid == 0)
+  // Lines were split by bytes, so vertex weights need to be sent to the
+  // task owning each vertex under the block distribution
+  if (weighted)
   {
-    std::ifstream infile;
-    std::string line;
-    int format = 0;
-    ggi->num_vert_weights = 0;
+    uint64_t *sendcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *recvcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *sdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *rdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *sdispls_cpy = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *send_vids = (uint64_t *)malloc(n_read * sizeof(uint64_t));
+    int32_t *send_weights =
+        (int32_t *)malloc(n_read * num_vert_weights * sizeof(int32_t));
+    if (sendcounts == NULL || recvcounts == NULL || sdispls == NULL ||
+        rdispls == NULL || sdispls_cpy == NULL ||
+        send_vids == NULL || send_weights == NULL)
+      throw_err("read_adj_parallel(), unable to allocate comm buffers", procid);
 
-    infile.open(input_filename);
-    getline(infile, line);
-    sscanf(line.c_str(), "%lu %lu %d %lu",
-           &ggi->n, &ggi->m, &format, &ggi->num_vert_weights);
-    infile.close();
-    ggi->m *= 2;
+    for (int32_t i = 0; i < nprocs; ++i)
+      sendcounts[i] = 0;
 
-    switch (format)
-    {
-    case 0:
+    for (uint64_t i = 0; i < n_read; ++i)
     {
-      ggi->num_edge_weights = 0;
-      ggi->num_vert_weights = 0;
-      break;
+      uint64_t vid = vert_start + i;
+      if (offset_vids)
+        vid = (vid % (uint64_t)nprocs) * n_orig_per_rank +
+              vid / (uint64_t)nprocs;
+      ++sendcounts[vid / n_per_rank];
     }
-    case 1:
+
+    MPI_Alltoall(sendcounts, 1, MPI_UINT64_T,
+                 recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+
+    sdispls[0] = 0;
+    rdispls[0] = 0;
+    sdispls_cpy[0] = 0;
+    for (int32_t i = 1; i < nprocs; ++i)
     {
-      ggi->num_edge_weights = 1;
-      ggi->num_vert_weights = 0;
-      break;
+      sdispls[i] = sdispls[i - 1] + sendcounts[i - 1];
+      rdispls[i] = rdispls[i - 1] + recvcounts[i - 1];
+      sdispls_cpy[i] = sdispls[i];
     }
-    case 10:
-    {
-      ggi->num_edge_weights = 0;
+    uint64_t num_recv = rdispls[nprocs - 1] + recvcounts[nprocs - 1];
 
-      // Handle case if header file has no fourth argument
-      if (ggi->num_vert_weights == 0)
-        ggi->num_vert_weights = 1;
-      break;
-    }
-    case 11:
+    for (uint64_t i = 0; i < n_read; ++i)
     {
-      ggi->num_edge_weights = 1;
-
-      // Handle case if header file has no fourth argument
-      if (ggi->num_vert_weights == 0)
-        ggi->num_vert_weights = 1;
-      break;
-    }
-    default:
-      fprintf(stderr, "Unknown format specification: '%d'\n", format);
-      abort();
+      uint64_t vid = vert_start + i;
+      if (offset_vids)
+        vid = (vid % (uint64_t)nprocs) * n_orig_per_rank +
+              vid / (uint64_t)nprocs;
+      uint64_t index = sdispls_cpy[vid / n_per_rank]++;
+      send_vids[index] = vid;
+      for (uint64_t w = 0; w < num_vert_weights; ++w)
+        send_weights[index * num_vert_weights + w] =
+            read_vert_weights[i * num_vert_weights + w];
     }
+    free(read_vert_weights);
 
-    read_adj(input_filename, ggi, offset_vids);
+    uint64_t *recv_vids = (uint64_t *)malloc(num_recv * sizeof(uint64_t));
+    int32_t *recv_weights =
+        (int32_t *)malloc(num_recv * num_vert_weights * sizeof(int32_t));
+    if (recv_vids == NULL || recv_weights == NULL)
+      throw_err("read_adj_parallel(), unable to allocate comm buffers", procid);
 
-    // Do exchange of relevant info
-    MPI_Bcast(&ggi->n, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    ggi->n_offset = 0;
-    ggi->n_local = ggi->n / (uint64_t)nprocs + 1;
-    if (nprocs == 1)
-      ggi->n_local = ggi->n;
+    alltoallv_large(send_vids, sendcounts, sdispls,
+                    recv_vids, recvcounts, rdispls, MPI_UINT64_T);
 
-    MPI_Bcast(&ggi->m, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&ggi->num_vert_weights, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&ggi->num_edge_weights, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    ggi->m_local_read = (ggi->m / 2);
-
-    if (ggi->num_vert_weights > 0)
+    for (int32_t i = 0; i < nprocs; ++i)
     {
-      MPI_Bcast(ggi->max_vert_weights, ggi->num_vert_weights,
-                MPI_INT32_T, 0, MPI_COMM_WORLD);
-      MPI_Bcast(ggi->vert_weights_sums, ggi->num_vert_weights,
-                MPI_INT64_T, 0, MPI_COMM_WORLD);
+      sendcounts[i] *= num_vert_weights;
+      recvcounts[i] *= num_vert_weights;
+      sdispls[i] *= num_vert_weights;
+      rdispls[i] *= num_vert_weights;
+    }
 
-      int32_t *new_vert_weights =
-          (int32_t *)malloc(ggi->n_local * ggi->num_vert_weights * sizeof(int32_t));
-      int32_t *sendcounts = (int32_t *)malloc(nprocs * sizeof(int32_t));
-      int32_t *sendoffsets = (int32_t *)malloc(nprocs * sizeof(int32_t));
+    alltoallv_large(send_weights, sendcounts, sdispls,
+                    recv_weights, recvcounts, rdispls, MPI_INT32_T);
 
-      for (int32_t i = 0; i < nprocs; ++i)
-      {
-        sendcounts[i] =
-            (int32_t)(ggi->n / (uint64_t)nprocs + 1) * ggi->num_vert_weights;
-        sendoffsets[i] =
-            (int32_t)((uint64_t)procid * (ggi->n / (uint64_t)nprocs + 1)) *
-            ggi->num_vert_weights;
-      }
-      sendoffsets[nprocs - 1] =
-          (int32_t)((uint64_t)(nprocs - 1) * (ggi->n / (uint64_t)nprocs + 1)) *
-          ggi->num_vert_weights;
-      sendcounts[nprocs - 1] =
-          ggi->n * ggi->num_vert_weights - sendoffsets[nprocs - 1];
-
-      // for (int32_t i = 0; i < nprocs; ++i)
-      //   printf("%d - %d %d %d %d\n", procid, sendcounts[i], recvcounts[i],
-      //     sendoffsets[i], recvoffsets[i]);
-
-      MPI_Scatterv(ggi->vert_weights, sendcounts, sendoffsets, MPI_INT32_T,
-                   new_vert_weights, ggi->n_local * ggi->num_vert_weights,
-                   MPI_INT32_T, 0, MPI_COMM_WORLD);
-      free(sendcounts);
-      free(sendoffsets);
-      free(ggi->vert_weights);
-      ggi->vert_weights = new_vert_weights;
-    }
-  }
-  else
-  {
-    // we do this first to ensure that n_offsets and n_locals are consistent
-    MPI_Bcast(&ggi->n, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    ggi->n_offset = (uint64_t)procid * (ggi->n / (uint64_t)nprocs + 1);
-    ggi->n_local = ggi->n / (uint64_t)nprocs + 1;
-    if (procid == nprocs - 1)
-      ggi->n_local = ggi->n - ggi->n_offset;
+    ggi->vert_weights =
+        (int32_t *)malloc(ggi->n_local * num_vert_weights * sizeof(int32_t));
+    if (ggi->vert_weights == NULL)
+      throw_err("read_adj_parallel(), unable to allocate vertex weights", procid);
 
-    MPI_Bcast(&ggi->m, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&ggi->num_vert_weights, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&ggi->num_edge_weights, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
-    ggi->m_local_read = 0;
-    ggi->gen_edges = NULL;
-    ggi->vert_weights = NULL;
-    ggi->edge_weights = NULL;
+#pragma omp parallel for
+    for (uint64_t i = 0; i < ggi->n_local * num_vert_weights; ++i)
+      ggi->vert_weights[i] = 0;
 
-    if (ggi->num_vert_weights > 0)
+#pragma omp parallel for
+    for (uint64_t i = 0; i < num_recv; ++i)
     {
-      ggi->max_vert_weights =
-          (int32_t *)malloc(ggi->num_vert_weights * sizeof(int32_t));
-      ggi->vert_weights_sums =
-          (int64_t *)malloc(ggi->num_vert_weights * sizeof(int64_t));
-      MPI_Bcast(ggi->max_vert_weights, ggi->num_vert_weights,
-                MPI_INT32_T, 0, MPI_COMM_WORLD);
-      MPI_Bcast(ggi->vert_weights_sums, ggi->num_vert_weights,
-                MPI_INT64_T, 0, MPI_COMM_WORLD);
-
-      ggi->vert_weights =
-          (int32_t *)malloc(ggi->n_local * ggi->num_vert_weights * sizeof(int32_t));
-
-      MPI_Scatterv(NULL, NULL, NULL, MPI_INT32_T,
-                   ggi->vert_weights, ggi->n_local * ggi->num_vert_weights,
-                   MPI_INT32_T, 0, MPI_COMM_WORLD);
+      uint64_t index = recv_vids[i] - ggi->n_offset;
+      assert(index < ggi->n_local);
+      for (uint64_t w = 0; w < num_vert_weights; ++w)
+        ggi->vert_weights[index * num_vert_weights + w] =
+            recv_weights[i * num_vert_weights + w];
     }
-  }
 
-  return 0;
-}
+    free(sendcounts);
+    free(recvcounts);
+    free(sdispls);
+    free(rdispls);
+    free(sdispls_cpy);
+    free(send_vids);
+    free(send_weights);
+    free(recv_vids);
+    free(recv_weights);
+  }
 
-int exchange_edges(graph_gen_data_t *ggi, mpi_data_t *comm)
+  if (verbose)
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d read_adj_parallel() read %lu verts, %lu edges, %9.6f (s)\n",
+           procid, n_read, m_read, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d read_adj_parallel() success\n", procid);
+  }
+  return 0;
+}
+
+// Reads the first two ids on an edge list line and leaves p at its end;
+// blank lines, comments, and lines with a single token hold no edge
+inline bool parse_edge_line(const char *&p, const char *end,
+                            uint64_t &src, uint64_t &dst)
+{
+  bool is_edge = false;
+  if (next_token(p, end) && *p != '#' && *p != '%')
+  {
+    src = parse_uint(p, end);
+    if (next_token(p, end))
+    {
+      dst = parse_uint(p, end);
+      is_edge = true;
+    }
+  }
+
+  while (p < end && *p != '\n')
+    ++p;
+
+  return is_edge;
+}
+
+int read_edge_list_text(char *input_filename, graph_gen_data_t *ggi,
+                        bool offset_vids)
+{
+  if (debug)
+  {
+    printf("Task %d read_edge_list_text() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  // Matrix Market files open with a banner and comments, followed by a
+  // "rows cols entries" size line that must not be read as an edge;
+  // header is the Matrix Market flag, data offset in bytes, rows, cols
+  uint64_t header[4] = {0, 0, 0, 0};
+  if (procid == 0)
+  {
+    std::ifstream infile;
+    std::string line;
+
+    infile.open(input_filename);
+    if (!infile.is_open())
+      throw_err("read_edge_list_text() unable to open input file", procid);
+
+    if (getline(infile, line) && line.compare(0, 14, "%%MatrixMarket") == 0)
+    {
+      header[0] = 1;
+      header[1] = (uint64_t)line.size() + 1;
+      while (getline(infile, line))
+      {
+        header[1] += (uint64_t)line.size() + 1;
+        if (line.empty() || line[0] == '%')
+          continue;
+
+        sscanf(line.c_str(), "%lu %lu", &header[2], &header[3]);
+        break;
+      }
+    }
+    infile.close();
+  }
+
+  MPI_Bcast(header, 4, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  bool matrix_market = (header[0] == 1);
+  uint64_t data_offset = header[1];
+  uint64_t n_header = header[2] > header[3] ? header[2] : header[3];
+
+  int fd = open(input_filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("read_edge_list_text() unable to open input file", procid);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throw_err("read_edge_list_text() unable to stat input file", procid);
+  uint64_t file_size = (uint64_t)st.st_size;
+  if (data_offset > file_size)
+    data_offset = file_size;
+
+  // Same byte split and line snapping as read_adj_parallel()
+  uint64_t data_size = file_size - data_offset;
+  uint64_t read_begin = find_line_start(fd,
+      data_offset + (data_size * (uint64_t)procid) / (uint64_t)nprocs,
+      data_offset, file_size);
+  uint64_t read_end = file_size;
+  if (procid < nprocs - 1)
+    read_end = find_line_start(fd,
+        data_offset + (data_size * (uint64_t)(procid + 1)) / (uint64_t)nprocs,
+        data_offset, file_size);
+  uint64_t read_size = read_end - read_begin;
+
+  char *buf = (char *)malloc((read_size + 1) * sizeof(char));
+  if (buf == NULL)
+    throw_err("read_edge_list_text(), unable to allocate read buffer", procid);
+  if (pread_full(fd, buf, read_size, read_begin))
+    throw_err("read_edge_list_text(), unable to read input file", procid);
+  buf[read_size] = '\0';
+  close(fd);
+
+  int32_t num_threads = omp_get_max_threads();
+  uint64_t *thread_begin =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  uint64_t *thread_edges =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  if (thread_begin == NULL || thread_edges == NULL)
+    throw_err("read_edge_list_text(), unable to allocate thread offsets",
+              procid);
+
+  thread_begin[0] = 0;
+  thread_begin[num_threads] = read_size;
+  for (int32_t t = 1; t < num_threads; ++t)
+  {
+    uint64_t pos = (read_size * (uint64_t)t) / (uint64_t)num_threads;
+    if (pos < thread_begin[t - 1])
+      pos = thread_begin[t - 1];
+    char *newline = NULL;
+    if (pos > 0 && pos < read_size)
+      newline = (char *)memchr(buf + pos - 1, '\n', read_size - pos + 1);
+    if (pos == 0)
+      thread_begin[t] = 0;
+    else if (newline == NULL)
+      thread_begin[t] = read_size;
+    else
+      thread_begin[t] = (uint64_t)(newline - buf) + 1;
+  }
+
+  // First pass, count edges per thread chunk and find the id range
+  uint64_t min_vid = std::numeric_limits<uint64_t>::max();
+  uint64_t max_vid = 0;
+#pragma omp parallel num_threads(num_threads) \
+    reduction(min : min_vid) reduction(max : max_vid)
+  {
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t num_edges = 0;
+    uint64_t src = 0;
+    uint64_t dst = 0;
+
+    while (p < end)
+    {
+      if (parse_edge_line(p, end, src, dst))
+      {
+        ++num_edges;
+        if (src < min_vid) min_vid = src;
+        if (dst < min_vid) min_vid = dst;
+        if (src > max_vid) max_vid = src;
+        if (dst > max_vid) max_vid = dst;
+      }
+
+      if (p < end)
+        ++p;
+    }
+
+    thread_edges[tid + 1] = num_edges;
+  }
+
+  thread_edges[0] = 0;
+  for (int32_t t = 0; t < num_threads; ++t)
+    thread_edges[t + 1] += thread_edges[t];
+
+  uint64_t m_read = thread_edges[num_threads];
+  uint64_t m_global = m_read;
+  MPI_Allreduce(MPI_IN_PLACE, &m_global, 1,
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &min_vid, 1,
+                MPI_UINT64_T, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &max_vid, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+  if (m_global == 0)
+    throw_err("read_edge_list_text(), no edges in input file", procid);
+
+  // Matrix Market is always 1-based; other lists are 1-based exactly when
+  // no id 0 appears anywhere
+  uint64_t base = (matrix_market || min_vid > 0) ? 1 : 0;
+  if (min_vid < base)
+    throw_err("read_edge_list_text(), id 0 in 1-based input", procid);
+  ggi->n = max_vid - base + 1;
+  if (n_header > ggi->n)
+    ggi->n = n_header;
+
+  // A single task skips exchange_edges(), so it stores both directions of
+  // each edge here, as the exchange would
+  uint64_t num_dirs = (nprocs == 1) ? 2 : 1;
+  ggi->gen_edges = (uint64_t *)malloc(m_read * 2 * num_dirs * sizeof(uint64_t));
+  if (ggi->gen_edges == NULL)
+    throw_err("read_edge_list_text(), unable to allocate edge buffer",
+              procid);
+
+  // Second pass, fill in edges at the precomputed offsets
+#pragma omp parallel num_threads(num_threads)
+  {
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t edge = thread_edges[tid] * num_dirs;
+    uint64_t src = 0;
+    uint64_t dst = 0;
+
+    while (p < end)
+    {
+      if (parse_edge_line(p, end, src, dst))
+      {
+        ggi->gen_edges[2 * edge] = src - base;
+        ggi->gen_edges[2 * edge + 1] = dst - base;
+        ++edge;
+        if (num_dirs == 2)
+        {
+          ggi->gen_edges[2 * edge] = dst - base;
+          ggi->gen_edges[2 * edge + 1] = src - base;
+          ++edge;
+        }
+      }
+
+      if (p < end)
+        ++p;
+    }
+  }
+
+  free(buf);
+  free(thread_begin);
+  free(thread_edges);
+
+  ggi->m = m_global;
+  ggi->m_local_read = m_read * num_dirs;
+  ggi->m_local_edges = m_read * num_dirs;
+  ggi->num_vert_weights = 0;
+  ggi->num_edge_weights = 0;
+  ggi->edge_weights_sum = 0;
+  ggi->max_edge_weight = 0;
+  ggi->vert_weights = NULL;
+  ggi->edge_weights = NULL;
+  ggi->vert_weights_sums = NULL;
+  ggi->max_vert_weights = NULL;
+
+  uint64_t n_orig_per_rank = ggi->n / (uint64_t)nprocs + 1;
+  if (offset_vids)
+  {
+#pragma omp parallel for
+    for (uint64_t i = 0; i < ggi->m_local_edges * 2; ++i)
+    {
+      uint64_t task_id = ggi->gen_edges[i] / (uint64_t)nprocs;
+      uint64_t task = ggi->gen_edges[i] % (uint64_t)nprocs;
+      ggi->gen_edges[i] = task * n_orig_per_rank + task_id;
+    }
+
+    uint64_t n_max = 0;
+    for (uint64_t task = 0; task < (uint64_t)nprocs && task < ggi->n; ++task)
+    {
+      uint64_t task_id = (ggi->n - 1 - task) / (uint64_t)nprocs;
+      uint64_t new_vid = task * n_orig_per_rank + task_id;
+      if (new_vid > n_max)
+        n_max = new_vid;
+    }
+    ggi->n = n_max + 1;
+  }
+
+  uint64_t n_per_rank = ggi->n / (uint64_t)nprocs + 1;
+  ggi->n_offset = (uint64_t)procid * n_per_rank;
+  if (ggi->n_offset > ggi->n)
+    ggi->n_offset = ggi->n;
+  ggi->n_local = ggi->n - ggi->n_offset;
+  if (ggi->n_local > n_per_rank)
+    ggi->n_local = n_per_rank;
+
+  if (verbose)
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d read_edge_list_text() read %lu edges, n %lu, base %lu, %9.6f (s)\n",
+           procid, m_read, ggi->n, base, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d read_edge_list_text() success\n", procid);
+  }
+  return 0;
+}
+
+int read_graph(char *input_filename,
+               graph_gen_data_t *ggi, bool offset_vids)
+{
+  // n, m, format, number of vertex weights, header length in bytes
+  uint64_t header[5] = {0, 0, 0, 0, 0};
+
+  if (procid == 0)
+  {
+    std::ifstream infile;
+    std::string line;
+    int format = 0;
+
+    infile.open(input_filename);
+    if (!infile.is_open())
+      throw_err("read_graph() unable to open input file", procid);
+    getline(infile, line);
+    infile.close();
+
+    sscanf(line.c_str(), "%lu %lu %d %lu",
+           &header[0], &header[1], &format, &header[3]);
+    header[2] = (uint64_t)format;
+    header[4] = (uint64_t)line.size() + 1;
+  }
+
+  MPI_Bcast(header, 5, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  ggi->n = header[0];
+  ggi->m = header[1] * 2;
+  ggi->num_vert_weights = header[3];
+
+  int format = (int)header[2];
+  switch (format)
+  {
+  case 0:
+  {
+    ggi->num_edge_weights = 0;
+    ggi->num_vert_weights = 0;
+    break;
+  }
+  case 1:
+  {
+    ggi->num_edge_weights = 1;
+    ggi->num_vert_weights = 0;
+    break;
+  }
+  case 10:
+  {
+    ggi->num_edge_weights = 0;
+
+    // Handle case if header file has no fourth argument
+    if (ggi->num_vert_weights == 0)
+      ggi->num_vert_weights = 1;
+    break;
+  }
+  case 11:
+  {
+    ggi->num_edge_weights = 1;
+
+    // Handle case if header file has no fourth argument
+    if (ggi->num_vert_weights == 0)
+      ggi->num_vert_weights = 1;
+    break;
+  }
+  default:
+    if (procid == 0)
+      fprintf(stderr, "Unknown format specification: '%d'\n", format);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  if (debug)
+  {
+    printf("%d - reading n: %lu, m: %lu, nVwgt: %lu, nEwgt: %lu\n",
+           procid, ggi->n, ggi->m, ggi->num_vert_weights, ggi->num_edge_weights);
+  }
+
+  read_adj_parallel(input_filename, ggi, offset_vids, header[4]);
+
+  return 0;
+}
+
+bool is_csr_graph(char *input_filename)
+{
+  int32_t is_csr = 0;
+  if (procid == 0)
+  {
+    char magic[8];
+    int fd = open(input_filename, O_RDONLY);
+    if (fd >= 0)
+    {
+      if (!pread_full(fd, magic, sizeof(magic), 0) &&
+          memcmp(magic, CSR_MAGIC, sizeof(magic)) == 0)
+        is_csr = 1;
+      close(fd);
+    }
+  }
+
+  MPI_Bcast(&is_csr, 1, MPI_INT32_T, 0, MPI_COMM_WORLD);
+
+  return (is_csr == 1);
+}
+
+int read_csr_graph(char *input_filename, dist_graph_t *g, bool offset_vids)
+{
+  if (debug)
+  {
+    printf("Task %d read_csr_graph() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  if (offset_vids)
+    throw_err("read_csr_graph(), offset vids not supported for CSR input",
+              procid);
+
+  int fd = open(input_filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("read_csr_graph() unable to open input file", procid);
+
+  csr_header_t header;
+  if (procid == 0 && pread_full(fd, (char *)&header, sizeof(csr_header_t), 0))
+    throw_err("read_csr_graph() unable to read header", procid);
+  MPI_Bcast(&header, sizeof(csr_header_t), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  if (header.version != CSR_VERSION ||
+      (header.adj_bytes != 4 && header.adj_bytes != 8))
+    throw_err("read_csr_graph() unsupported CSR version", procid);
+
+  // Same block distribution that relabel_edges() assumes for ghost owners
+  uint64_t n_global = header.n;
+  uint64_t n_per_rank = n_global / (uint64_t)nprocs + 1;
+  uint64_t n_offset = (uint64_t)procid * n_per_rank;
+  if (n_offset > n_global)
+    n_offset = n_global;
+  uint64_t n_local = n_global - n_offset;
+  if (n_local > n_per_rank)
+    n_local = n_per_rank;
+
+  uint64_t *local_offsets =
+      (uint64_t *)malloc((n_local + 1) * sizeof(uint64_t));
+  uint64_t *global_ids = (uint64_t *)malloc(n_local * sizeof(uint64_t));
+  if (local_offsets == NULL || global_ids == NULL)
+    throw_err("read_csr_graph(), unable to allocate offsets", procid);
+  if (pread_full(fd, (char *)local_offsets, (n_local + 1) * sizeof(uint64_t),
+                 header.offsets_start + n_offset * sizeof(uint64_t)))
+    throw_err("read_csr_graph(), unable to read offsets", procid);
+
+  uint64_t edge_offset = local_offsets[0];
+  uint64_t m_local = local_offsets[n_local] - edge_offset;
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < n_local + 1; ++i)
+    local_offsets[i] -= edge_offset;
+#pragma omp parallel for
+  for (uint64_t i = 0; i < n_local; ++i)
+    global_ids[i] = n_offset + i;
+
+  uint64_t *local_adjs = (uint64_t *)malloc(m_local * sizeof(uint64_t));
+  if (local_adjs == NULL)
+    throw_err("read_csr_graph(), unable to allocate adjacencies", procid);
+
+  if (header.adj_bytes == 8)
+  {
+    if (pread_full(fd, (char *)local_adjs, m_local * sizeof(uint64_t),
+                   header.adjs_start + edge_offset * sizeof(uint64_t)))
+      throw_err("read_csr_graph(), unable to read adjacencies", procid);
+  }
+  else
+  {
+    // 32-bit ids are widened through a bounded staging buffer
+    uint64_t chunk_size =
+        m_local < CSR_READ_CHUNK ? m_local : CSR_READ_CHUNK;
+    uint32_t *chunk = (uint32_t *)malloc(chunk_size * sizeof(uint32_t) + 1);
+    if (chunk == NULL)
+      throw_err("read_csr_graph(), unable to allocate read buffer", procid);
+
+    for (uint64_t start = 0; start < m_local; start += chunk_size)
+    {
+      uint64_t count = m_local - start;
+      if (count > chunk_size)
+        count = chunk_size;
+      if (pread_full(fd, (char *)chunk, count * sizeof(uint32_t),
+                     header.adjs_start +
+                         (edge_offset + start) * sizeof(uint32_t)))
+        throw_err("read_csr_graph(), unable to read adjacencies", procid);
+
+#pragma omp parallel for
+      for (uint64_t i = 0; i < count; ++i)
+        local_adjs[start + i] = (uint64_t)chunk[i];
+    }
+
+    free(chunk);
+  }
+
+  // Unit weights fill in whichever side is missing, as with the text formats
+  uint64_t num_vert_weights = header.num_vert_weights;
+  if (num_vert_weights == 0 && header.num_edge_weights > 0)
+    num_vert_weights = 1;
+
+  int32_t *vert_weights = NULL;
+  int32_t *edge_weights = NULL;
+  if (num_vert_weights > 0)
+  {
+    vert_weights =
+        (int32_t *)malloc(n_local * num_vert_weights * sizeof(int32_t));
+    edge_weights = (int32_t *)malloc(m_local * sizeof(int32_t));
+    if (vert_weights == NULL || edge_weights == NULL)
+      throw_err("read_csr_graph(), unable to allocate weights", procid);
+
+    if (header.vert_weights_start > 0)
+    {
+      if (pread_full(fd, (char *)vert_weights,
+                     n_local * num_vert_weights * sizeof(int32_t),
+                     header.vert_weights_start +
+                         n_offset * num_vert_weights * sizeof(int32_t)))
+        throw_err("read_csr_graph(), unable to read vertex weights", procid);
+    }
+    else
+    {
+#pragma omp parallel for
+      for (uint64_t i = 0; i < n_local; ++i)
+        vert_weights[i] = 1;
+    }
+
+    if (header.edge_weights_start > 0)
+    {
+      if (pread_full(fd, (char *)edge_weights, m_local * sizeof(int32_t),
+                     header.edge_weights_start +
+                         edge_offset * sizeof(int32_t)))
+        throw_err("read_csr_graph(), unable to read edge weights", procid);
+    }
+    else
+    {
+#pragma omp parallel for
+      for (uint64_t i = 0; i < m_local; ++i)
+        edge_weights[i] = 1;
+    }
+  }
+  close(fd);
+
+  g->caller_edges = false;
+  if (nprocs > 1)
+  {
+    create_graph(g, n_global, header.m, n_local, m_local,
+                 local_offsets, local_adjs, global_ids,
+                 num_vert_weights, vert_weights, edge_weights);
+    g->n_offset = n_offset;
+    relabel_edges(g);
+  }
+  else
+  {
+    create_graph_serial(g, n_global, header.m, n_local, m_local,
+                        local_offsets, local_adjs,
+                        num_vert_weights, vert_weights, edge_weights);
+  }
+  free(global_ids);
+
+  // create_graph() only reduces the weight sums, the text path also
+  // provides global maxes and edge weight totals
+  if (num_vert_weights > 0)
+  {
+    int64_t edge_weights_sum = 0;
+    int32_t max_edge_weight = 0;
+#pragma omp parallel for reduction(+ : edge_weights_sum) \
+    reduction(max : max_edge_weight)
+    for (uint64_t i = 0; i < m_local; ++i)
+    {
+      edge_weights_sum += edge_weights[i];
+      if (edge_weights[i] > max_edge_weight)
+        max_edge_weight = edge_weights[i];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, g->max_vert_weights, 
+                  (int32_t)num_vert_weights, MPI_INT32_T, MPI_MAX, 
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&edge_weights_sum, &g->edge_weights_sum, 1,
+                  MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&max_edge_weight, &g->max_edge_weight, 1,
+                  MPI_INT32_T, MPI_MAX, MPI_COMM_WORLD);
+  }
+
+  if (debug)
+  {
+    printf("%d - read n: %lu, m: %lu, n_local: %lu, m_local: %lu, "
+           "nVwgt: %lu\n", procid, g->n, g->m, g->n_local, g->m_local,
+           g->num_vert_weights);
+  }
+
+  if (verbose)
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d read_csr_graph() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d read_csr_graph() success\n", procid);
+  }
+
+  return 0;
+}
+
+int read_vert_weights(char **weight_filenames, int32_t num_weight_files,
+                      char *mask_filename, dist_graph_t *g)
+{
+  if (debug)
+  {
+    printf("Task %d read_vert_weights() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  // Sidecar columns are indexed by global id, so this task's vertices must
+  // be the contiguous block the readers assign it
+  uint64_t n_offset = (g->n_local > 0) ? g->local_unmap[0] : 0;
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    if (g->local_unmap[i] != n_offset + i)
+      throw_err("read_vert_weights(), local vertices are not a contiguous block",
+                procid);
+
+  bool has_mask = (mask_filename != NULL && mask_filename[0] != '\0');
+  uint64_t num_vert_weights = (uint64_t)num_weight_files + (has_mask ? 1 : 0);
+  int32_t *vert_weights =
+      (int32_t *)malloc(g->n_local * num_vert_weights * sizeof(int32_t));
+  int32_t *column = (int32_t *)malloc(g->n_local * sizeof(int32_t));
+  int64_t *vert_weights_sums =
+      (int64_t *)malloc(num_vert_weights * sizeof(int64_t));
+  int32_t *max_vert_weights =
+      (int32_t *)malloc(num_vert_weights * sizeof(int32_t));
+  if (vert_weights == NULL || column == NULL ||
+      vert_weights_sums == NULL || max_vert_weights == NULL)
+    throw_err("read_vert_weights(), unable to allocate weights", procid);
+
+  for (uint64_t w = 0; w < num_vert_weights; ++w)
+  {
+    char *filename = (w < (uint64_t)num_weight_files) ? 
+                     weight_filenames[w] : mask_filename;
+    bool is_mask = (w == (uint64_t)num_weight_files);
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+      throw_err("read_vert_weights(), unable to open weight file", procid);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      throw_err("read_vert_weights(), unable to stat weight file", procid);
+    uint64_t expected_size = is_mask ? (g->n + 7) / 8 : 
+                                       g->n * sizeof(int32_t);
+    if ((uint64_t)st.st_size < expected_size)
+      throw_err("read_vert_weights(), weight file is smaller than graph", 
+                procid);
+
+    if (is_mask && g->n_local > 0)
+    {
+      // Bit i%8 of byte i/8 is set for training vertex i
+      uint64_t byte_begin = n_offset / 8;
+      uint64_t byte_end = (n_offset + g->n_local + 7) / 8;
+      uint8_t *bits = (uint8_t *)malloc(byte_end - byte_begin);
+      if (bits == NULL)
+        throw_err("read_vert_weights(), unable to allocate mask", procid);
+      if (pread_full(fd, (char *)bits, byte_end - byte_begin, byte_begin))
+        throw_err("read_vert_weights(), unable to read mask file", procid);
+
+#pragma omp parallel for
+      for (uint64_t i = 0; i < g->n_local; ++i)
+      {
+        uint64_t vid = n_offset + i;
+        column[i] = (bits[vid / 8 - byte_begin] >> (vid % 8)) & 1;
+      }
+      free(bits);
+    }
+    else if (g->n_local > 0)
+    {
+      if (pread_full(fd, (char *)column, g->n_local * sizeof(int32_t),
+                     n_offset * sizeof(int32_t)))
+        throw_err("read_vert_weights(), unable to read weight file", procid);
+    }
+    close(fd);
+
+    int64_t sum = 0;
+    int32_t max = 0;
+#pragma omp parallel for reduction(+ : sum) reduction(max : max)
+    for (uint64_t i = 0; i < g->n_local; ++i)
+    {
+      sum += column[i];
+      if (column[i] > max)
+        max = column[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    // Integer weights only need the range check of scale_weights()
+    const double max_weight_sum = 
+        double(std::numeric_limits<int>::max() / 8);
+    double scale = 1.0;
+    if ((double)sum > max_weight_sum)
+      scale = max_weight_sum / (double)sum;
+    if (scale != 1.0)
+    {
+      sum = 0;
+      max = 0;
+#pragma omp parallel for reduction(+ : sum) reduction(max : max)
+      for (uint64_t i = 0; i < g->n_local; ++i)
+      {
+        column[i] = (int32_t)ceil((double)column[i] * scale);
+        sum += column[i];
+        if (column[i] > max)
+          max = column[i];
+      }
+      MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_INT64_T, MPI_SUM, 
+                    MPI_COMM_WORLD);
+    }
+    vert_weights_sums[w] = sum;
+    max_vert_weights[w] = max;
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < g->n_local; ++i)
+      vert_weights[i * num_vert_weights + w] = column[i];
+  }
+  free(column);
+
+  MPI_Allreduce(MPI_IN_PLACE, max_vert_weights, (int32_t)num_vert_weights,
+                MPI_INT32_T, MPI_MAX, MPI_COMM_WORLD);
+
+  g->vert_weights = vert_weights;
+  g->vert_weights_sums = vert_weights_sums;
+  g->max_vert_weights = max_vert_weights;
+  g->num_vert_weights = num_vert_weights;
+
+  // An unweighted graph gets unit edge weights, as with format 010
+  if (g->edge_weights == NULL)
+  {
+    g->edge_weights = (int32_t *)malloc(g->m_local * sizeof(int32_t));
+    if (g->edge_weights == NULL)
+      throw_err("read_vert_weights(), unable to allocate edge weights", 
+                procid);
+#pragma omp parallel for
+    for (uint64_t i = 0; i < g->m_local; ++i)
+      g->edge_weights[i] = 1;
+
+    int64_t edge_weights_sum = (int64_t)g->m_local;
+    MPI_Allreduce(&edge_weights_sum, &g->edge_weights_sum, 1,
+                  MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+    g->max_edge_weight = 1;
+    g->num_edge_weights = 1;
+  }
+
+  if (verbose)
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d read_vert_weights() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d read_vert_weights() success\n", procid);
+  }
+
+  return 0;
+}
+
+int exchange_edges(graph_gen_data_t *ggi, mpi_data_t *comm)
 {
   if (debug)
   {
@@ -715,97 +1947,65 @@ int exchange_edges(graph_gen_data_t *ggi, mpi_data_t *comm)
   MPI_Alltoall(temp_sendcounts, 1, MPI_UINT64_T,
                temp_recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
 
+  uint64_t *sdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *rdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *sdispls_cpy = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  if (sdispls == NULL || rdispls == NULL || sdispls_cpy == NULL)
+  {
+    fprintf(stderr, "Task %d Error: exchange_out_edges(), unable to allocate displacements\n", procid);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
   uint64_t total_recv = 0;
   uint64_t total_send = 0;
   for (int32_t i = 0; i < nprocs; ++i)
   {
+    sdispls[i] = total_send;
+    sdispls_cpy[i] = total_send;
+    rdispls[i] = total_recv;
     total_recv += temp_recvcounts[i];
     total_send += temp_sendcounts[i];
   }
-  free(temp_sendcounts);
-  free(temp_recvcounts);
 
   uint64_t *recvbuf = (uint64_t *)malloc(total_recv * sizeof(uint64_t));
-  if (recvbuf == NULL)
+  uint64_t *sendbuf = (uint64_t *)malloc(total_send * sizeof(uint64_t));
+  if (recvbuf == NULL || sendbuf == NULL)
   {
-    fprintf(stderr, "Task %d Error: exchange_out_edges(), unable to allocate buffer\n", procid);
+    fprintf(stderr, "Task %d Error: exchange_out_edges(), unable to allocate buffers\n", procid);
     MPI_Abort(MPI_COMM_WORLD, 1);
   }
 
-  uint64_t max_transfer = total_send > total_recv ? total_send : total_recv;
-  uint64_t num_comms = max_transfer / (uint64_t)(MAX_SEND_SIZE / 2) + 1;
-  MPI_Allreduce(MPI_IN_PLACE, &num_comms, 1,
-                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
-
-  if (debug)
-    printf("Task %d exchange_edges() num_comms %lu total_send %lu total_recv %lu\n", procid, num_comms, total_send, total_recv);
-
-  uint64_t sum_recv = 0;
-  for (uint64_t c = 0; c < num_comms; ++c)
+  for (uint64_t i = 0; i < ggi->m_local_read; ++i)
   {
-    uint64_t send_begin = (ggi->m_local_read * c) / num_comms;
-    uint64_t send_end = (ggi->m_local_read * (c + 1)) / num_comms;
-    if (c == (num_comms - 1))
-      send_end = ggi->m_local_read;
-
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
-      comm->sendcounts[i] = 0;
-      comm->recvcounts[i] = 0;
-    }
-
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t vert1 = ggi->gen_edges[i * 2];
-      int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
-      comm->sendcounts[vert_task1] += 2;
-
-      uint64_t vert2 = ggi->gen_edges[i * 2 + 1];
-      int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
-      comm->sendcounts[vert_task2] += 2;
-    }
-
-    MPI_Alltoall(comm->sendcounts, 1, MPI_INT32_T,
-                 comm->recvcounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
+    uint64_t vert1 = ggi->gen_edges[2 * i];
+    uint64_t vert2 = ggi->gen_edges[2 * i + 1];
+    int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
+    int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
 
-    comm->sdispls[0] = 0;
-    comm->sdispls_cpy[0] = 0;
-    comm->rdispls[0] = 0;
-    for (int32_t i = 1; i < nprocs; ++i)
-    {
-      comm->sdispls[i] = comm->sdispls[i - 1] + comm->sendcounts[i - 1];
-      comm->rdispls[i] = comm->rdispls[i - 1] + comm->recvcounts[i - 1];
-      comm->sdispls_cpy[i] = comm->sdispls[i];
-    }
+    sendbuf[sdispls_cpy[vert_task1]++] = vert1;
+    sendbuf[sdispls_cpy[vert_task1]++] = vert2;
+    sendbuf[sdispls_cpy[vert_task2]++] = vert2;
+    sendbuf[sdispls_cpy[vert_task2]++] = vert1;
+  }
 
-    int32_t cur_send = comm->sdispls[nprocs - 1] + comm->sendcounts[nprocs - 1];
-    int32_t cur_recv = comm->rdispls[nprocs - 1] + comm->recvcounts[nprocs - 1];
-    uint64_t *sendbuf = (uint64_t *)malloc((uint64_t)cur_send * sizeof(uint64_t));
-    if (sendbuf == NULL)
-    {
-      fprintf(stderr, "Task %d Error: exchange_out_edges(), unable to allocate comm buffers", procid);
-      MPI_Abort(MPI_COMM_WORLD, 1);
-    }
+  // One exchange regardless of size, alltoallv_large() handles counts past
+  // the 32-bit limit
+  uint64_t max_transfer = total_send > total_recv ? total_send : total_recv;
+  MPI_Allreduce(MPI_IN_PLACE, &max_transfer, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
 
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t vert1 = ggi->gen_edges[2 * i];
-      uint64_t vert2 = ggi->gen_edges[2 * i + 1];
-      int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
-      int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
-
-      sendbuf[comm->sdispls_cpy[vert_task1]++] = vert1;
-      sendbuf[comm->sdispls_cpy[vert_task1]++] = vert2;
-      sendbuf[comm->sdispls_cpy[vert_task2]++] = vert2;
-      sendbuf[comm->sdispls_cpy[vert_task2]++] = vert1;
-    }
+  if (debug)
+    printf("Task %d exchange_edges() max_transfer %lu total_send %lu total_recv %lu\n", procid, max_transfer, total_send, total_recv);
 
-    MPI_Alltoallv(sendbuf, comm->sendcounts, comm->sdispls, MPI_UINT64_T,
-                  recvbuf + sum_recv, comm->recvcounts, comm->rdispls,
-                  MPI_UINT64_T, MPI_COMM_WORLD);
-    sum_recv += cur_recv;
-    free(sendbuf);
-  }
+  alltoallv_large(sendbuf, temp_sendcounts, sdispls,
+                  recvbuf, temp_recvcounts, rdispls,
+                  MPI_UINT64_T, max_transfer);
+  free(sendbuf);
+  free(temp_sendcounts);
+  free(temp_recvcounts);
+  free(sdispls);
+  free(rdispls);
+  free(sdispls_cpy);
 
   free(ggi->gen_edges);
   ggi->gen_edges = recvbuf;
@@ -860,100 +2060,68 @@ int exchange_edges_weighted(graph_gen_data_t *ggi, mpi_data_t *comm)
   MPI_Alltoall(temp_sendcounts, 1, MPI_UINT64_T,
                temp_recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
 
+  uint64_t *sdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *rdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *sdispls_cpy = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  if (sdispls == NULL || rdispls == NULL || sdispls_cpy == NULL)
+  {
+    fprintf(stderr, "Task %d Error: exchange_edges_weighted(), unable to allocate displacements\n", procid);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
   uint64_t total_recv = 0;
   uint64_t total_send = 0;
   for (int32_t i = 0; i < nprocs; ++i)
   {
+    sdispls[i] = total_send;
+    sdispls_cpy[i] = total_send;
+    rdispls[i] = total_recv;
     total_recv += temp_recvcounts[i];
     total_send += temp_sendcounts[i];
   }
-  free(temp_sendcounts);
-  free(temp_recvcounts);
 
   uint64_t *recvbuf = (uint64_t *)malloc(total_recv * sizeof(uint64_t));
-  if (recvbuf == NULL)
+  uint64_t *sendbuf = (uint64_t *)malloc(total_send * sizeof(uint64_t));
+  if (recvbuf == NULL || sendbuf == NULL)
   {
-    fprintf(stderr, "Task %d Error: exchange_edges_weighted(), unable to allocate buffer\n", procid);
+    fprintf(stderr, "Task %d Error: exchange_edges_weighted(), unable to allocate buffers\n", procid);
     MPI_Abort(MPI_COMM_WORLD, 1);
   }
 
-  uint64_t max_transfer = total_send > total_recv ? total_send : total_recv;
-  uint64_t num_comms = max_transfer / (uint64_t)(MAX_SEND_SIZE / 2) + 1;
-  MPI_Allreduce(MPI_IN_PLACE, &num_comms, 1,
-                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
-
-  if (debug)
-    printf("Task %d exchange_edges_weighted() num_comms %lu total_send %lu total_recv %lu\n", procid, num_comms, total_send, total_recv);
-
-  uint64_t sum_recv = 0;
-  for (uint64_t c = 0; c < num_comms; ++c)
+  for (uint64_t i = 0; i < ggi->m_local_read; ++i)
   {
-    uint64_t send_begin = (ggi->m_local_read * c) / num_comms;
-    uint64_t send_end = (ggi->m_local_read * (c + 1)) / num_comms;
-    if (c == (num_comms - 1))
-      send_end = ggi->m_local_read;
-
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
-      comm->sendcounts[i] = 0;
-      comm->recvcounts[i] = 0;
-    }
-
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t vert1 = ggi->gen_edges[i * 2];
-      int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
-      comm->sendcounts[vert_task1] += 3;
-
-      uint64_t vert2 = ggi->gen_edges[i * 2 + 1];
-      int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
-      comm->sendcounts[vert_task2] += 3;
-    }
-
-    MPI_Alltoall(comm->sendcounts, 1, MPI_INT32_T,
-                 comm->recvcounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
+    uint64_t vert1 = ggi->gen_edges[2 * i];
+    uint64_t vert2 = ggi->gen_edges[2 * i + 1];
+    uint64_t weight = (uint64_t)ggi->edge_weights[i];
+    int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
+    int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
 
-    comm->sdispls[0] = 0;
-    comm->sdispls_cpy[0] = 0;
-    comm->rdispls[0] = 0;
-    for (int32_t i = 1; i < nprocs; ++i)
-    {
-      comm->sdispls[i] = comm->sdispls[i - 1] + comm->sendcounts[i - 1];
-      comm->rdispls[i] = comm->rdispls[i - 1] + comm->recvcounts[i - 1];
-      comm->sdispls_cpy[i] = comm->sdispls[i];
-    }
+    sendbuf[sdispls_cpy[vert_task1]++] = vert1;
+    sendbuf[sdispls_cpy[vert_task1]++] = vert2;
+    sendbuf[sdispls_cpy[vert_task1]++] = weight;
+    sendbuf[sdispls_cpy[vert_task2]++] = vert2;
+    sendbuf[sdispls_cpy[vert_task2]++] = vert1;
+    sendbuf[sdispls_cpy[vert_task2]++] = weight;
+  }
 
-    int32_t cur_send = comm->sdispls[nprocs - 1] + comm->sendcounts[nprocs - 1];
-    int32_t cur_recv = comm->rdispls[nprocs - 1] + comm->recvcounts[nprocs - 1];
-    uint64_t *sendbuf = (uint64_t *)malloc((uint64_t)cur_send * sizeof(uint64_t));
-    if (sendbuf == NULL)
-    {
-      fprintf(stderr, "Task %d Error: exchange_edges_weighted(), unable to allocate comm buffers", procid);
-      MPI_Abort(MPI_COMM_WORLD, 1);
-    }
+  // One exchange regardless of size, alltoallv_large() handles counts past
+  // the 32-bit limit
+  uint64_t max_transfer = total_send > total_recv ? total_send : total_recv;
+  MPI_Allreduce(MPI_IN_PLACE, &max_transfer, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
 
-    for (uint64_t i = send_begin; i < send_end; ++i)
-    {
-      uint64_t vert1 = ggi->gen_edges[2 * i];
-      uint64_t vert2 = ggi->gen_edges[2 * i + 1];
-      uint64_t weight = (uint64_t)ggi->edge_weights[i];
-      int32_t vert_task1 = (int32_t)(vert1 / n_per_rank);
-      int32_t vert_task2 = (int32_t)(vert2 / n_per_rank);
-
-      sendbuf[comm->sdispls_cpy[vert_task1]++] = vert1;
-      sendbuf[comm->sdispls_cpy[vert_task1]++] = vert2;
-      sendbuf[comm->sdispls_cpy[vert_task1]++] = weight;
-      sendbuf[comm->sdispls_cpy[vert_task2]++] = vert2;
-      sendbuf[comm->sdispls_cpy[vert_task2]++] = vert1;
-      sendbuf[comm->sdispls_cpy[vert_task2]++] = weight;
-    }
+  if (debug)
+    printf("Task %d exchange_edges_weighted() max_transfer %lu total_send %lu total_recv %lu\n", procid, max_transfer, total_send, total_recv);
 
-    MPI_Alltoallv(sendbuf, comm->sendcounts, comm->sdispls, MPI_UINT64_T,
-                  recvbuf + sum_recv, comm->recvcounts, comm->rdispls,
-                  MPI_UINT64_T, MPI_COMM_WORLD);
-    sum_recv += cur_recv;
-    free(sendbuf);
-  }
+  alltoallv_large(sendbuf, temp_sendcounts, sdispls,
+                  recvbuf, temp_recvcounts, rdispls,
+                  MPI_UINT64_T, max_transfer);
+  free(sendbuf);
+  free(temp_sendcounts);
+  free(temp_recvcounts);
+  free(sdispls);
+  free(rdispls);
+  free(sdispls_cpy);
 
   if (ggi->gen_edges != NULL)
     free(ggi->gen_edges);
@@ -975,9 +2143,78 @@ int exchange_edges_weighted(graph_gen_data_t *ggi, mpi_data_t *comm)
   return 0;
 }
 
+int write_at_all(MPI_File fh, uint64_t offset, char *buf, uint64_t count)
+{
+  // MPI-IO counts are ints, so large writes go out in collective rounds
+  const uint64_t max_chunk = 1073741824;
+  uint64_t num_chunks = (count + max_chunk - 1) / max_chunk;
+  MPI_Allreduce(MPI_IN_PLACE, &num_chunks, 1,
+                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+  for (uint64_t c = 0; c < num_chunks; ++c)
+  {
+    uint64_t chunk_start = c * max_chunk;
+    uint64_t chunk_size = 0;
+    if (chunk_start < count)
+      chunk_size = (count - chunk_start) < max_chunk ?
+                   (count - chunk_start) : max_chunk;
+    else
+      chunk_start = 0;
+
+    if (MPI_File_write_at_all(fh, (MPI_Offset)(offset + chunk_start),
+                              buf + chunk_start, (int)chunk_size, MPI_BYTE,
+                              MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      return 1;
+  }
+
+  return 0;
+}
+
+inline uint64_t format_length(int32_t val)
+{
+  uint64_t len = 2;
+  uint32_t uval = (uint32_t)val;
+  if (val < 0)
+  {
+    ++len;
+    uval = 0 - uval;
+  }
+  while (uval >= 10)
+  {
+    ++len;
+    uval /= 10;
+  }
+
+  return len;
+}
+
+inline char *format_int32(char *p, int32_t val)
+{
+  uint32_t uval = (uint32_t)val;
+  if (val < 0)
+  {
+    *p++ = '-';
+    uval = 0 - uval;
+  }
+
+  char digits[10];
+  int32_t num_digits = 0;
+  do
+  {
+    digits[num_digits++] = (char)('0' + uval % 10);
+    uval /= 10;
+  } while (uval > 0);
+
+  while (num_digits > 0)
+    *p++ = digits[--num_digits];
+  *p++ = '\n';
+
+  return p;
+}
+
 int output_parts(const char *filename, dist_graph_t *g, int32_t *parts)
 {
-  output_parts(filename, g, parts, false);
+  output_parts(filename, g, parts, false, false);
 
   return 0;
 }
@@ -985,14 +2222,30 @@ int output_parts(const char *filename, dist_graph_t *g, int32_t *parts)
 int output_parts(const char *filename, dist_graph_t *g,
                  int32_t *parts, bool offset_vids)
 {
+  output_parts(filename, g, parts, offset_vids, false);
+
+  return 0;
+}
+
+int output_parts(const char *filename, dist_graph_t *g,
+                 int32_t *parts, bool offset_vids, bool binary)
+{
+  if (debug)
+  {
+    printf("Task %d output_parts() start\n", procid);
+  }
+
+  double elt = 0.0;
   if (verbose)
+  {
     printf("Task %d writing parts to %s\n", procid, filename);
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
 
-  int32_t *global_parts = (int32_t *)malloc(g->n * sizeof(int32_t));
-
-#pragma omp parallel for
-  for (uint64_t i = 0; i < g->n; ++i)
-    global_parts[i] = -1;
+  uint64_t *global_ids = (uint64_t *)malloc(g->n_local * sizeof(uint64_t));
+  if (global_ids == NULL && g->n_local > 0)
+    throw_err("output_parts(), unable to allocate global ids", procid);
 
   if (offset_vids)
   {
@@ -1004,7 +2257,7 @@ int output_parts(const char *filename, dist_graph_t *g,
       uint64_t task = (uint64_t)procid;
       uint64_t global_id = task_id * (uint64_t)nprocs + task;
       assert(global_id < g->n);
-      global_parts[global_id] = parts[i];
+      global_ids[i] = global_id;
       if (global_id > n_global)
         n_global = global_id;
     }
@@ -1019,126 +2272,606 @@ int output_parts(const char *filename, dist_graph_t *g,
     for (uint64_t i = 0; i < g->n_local; ++i)
     {
       assert(g->local_unmap[i] < g->n);
-      global_parts[g->local_unmap[i]] = parts[i];
+      global_ids[i] = g->local_unmap[i];
     }
   }
 
+  // With the default block distribution every task already holds the
+  // consecutive range of vertices that lands right after the previous
+  // task's range, so it can write its own parts in place
+  uint64_t write_start = 0;
+  uint64_t write_count = g->n_local;
+  MPI_Exscan(&write_count, &write_start, 1,
+             MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
   if (procid == 0)
-    MPI_Reduce(MPI_IN_PLACE, global_parts, (int32_t)g->n,
-               MPI_INT32_T, MPI_MAX, 0, MPI_COMM_WORLD);
-  else
-    MPI_Reduce(global_parts, NULL, (int32_t)g->n,
-               MPI_INT32_T, MPI_MAX, 0, MPI_COMM_WORLD);
+    write_start = 0;
+
+  int32_t in_order = (write_start + write_count <= g->n);
+#pragma omp parallel for reduction(min : in_order)
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    if (global_ids[i] != write_start + i)
+      in_order = 0;
+  uint64_t n_written = write_count;
+  MPI_Allreduce(MPI_IN_PLACE, &in_order, 1,
+                MPI_INT32_T, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &n_written, 1,
+                MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+  int32_t *write_parts = parts;
+  if (!in_order || n_written != g->n)
+  {
+    // Otherwise send every part to the task owning its block of ids
+    uint64_t n_per_rank = g->n / (uint64_t)nprocs + 1;
+    write_start = (uint64_t)procid * n_per_rank;
+    if (write_start > g->n)
+      write_start = g->n;
+    write_count = g->n - write_start;
+    if (write_count > n_per_rank)
+      write_count = n_per_rank;
+
+    uint64_t *sendcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *recvcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    uint64_t *sdispls = (uint64_t *)malloc((nprocs + 1) * sizeof(uint64_t));
+    uint64_t *rdispls = (uint64_t *)malloc((nprocs + 1) * sizeof(uint64_t));
+    uint64_t *sdispls_cpy = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+    for (int32_t i = 0; i < nprocs; ++i)
+      sendcounts[i] = 0;
+    for (uint64_t i = 0; i < g->n_local; ++i)
+      sendcounts[global_ids[i] / n_per_rank] += 2;
 
-  if (procid == 0)
+    MPI_Alltoall(sendcounts, 1, MPI_UINT64_T,
+                 recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+
+    sdispls[0] = 0;
+    rdispls[0] = 0;
+    for (int32_t i = 0; i < nprocs; ++i)
+    {
+      sdispls[i + 1] = sdispls[i] + sendcounts[i];
+      rdispls[i + 1] = rdispls[i] + recvcounts[i];
+      sdispls_cpy[i] = sdispls[i];
+    }
+
+    uint64_t *sendbuf = (uint64_t *)malloc(sdispls[nprocs] * sizeof(uint64_t));
+    uint64_t *recvbuf = (uint64_t *)malloc(rdispls[nprocs] * sizeof(uint64_t));
+    write_parts = (int32_t *)malloc(write_count * sizeof(int32_t));
+    if (sendbuf == NULL || recvbuf == NULL || write_parts == NULL)
+      throw_err("output_parts(), unable to allocate exchange buffers",
+                procid);
+
+    for (uint64_t i = 0; i < g->n_local; ++i)
+    {
+      int32_t task = (int32_t)(global_ids[i] / n_per_rank);
+      sendbuf[sdispls_cpy[task]++] = global_ids[i];
+      sendbuf[sdispls_cpy[task]++] = (uint64_t)parts[i];
+    }
+
+    alltoallv_large(sendbuf, sendcounts, sdispls,
+                    recvbuf, recvcounts, rdispls, MPI_UINT64_T);
+
+#pragma omp parallel
+    {
+#pragma omp for
+      for (uint64_t i = 0; i < write_count; ++i)
+        write_parts[i] = -1;
+
+#pragma omp for
+      for (uint64_t i = 0; i < rdispls[nprocs]; i += 2)
+        write_parts[recvbuf[i] - write_start] = (int32_t)recvbuf[i + 1];
+    }
+
+    free(sendcounts);
+    free(recvcounts);
+    free(sdispls);
+    free(rdispls);
+    free(sdispls_cpy);
+    free(sendbuf);
+    free(recvbuf);
+  }
+  free(global_ids);
+
+  if (debug)
+    for (uint64_t i = 0; i < write_count; ++i)
+      if (write_parts[i] == -1)
+        printf("Part error: %lu not assigned\n", write_start + i);
+
+  MPI_File fh;
+  if (MPI_File_open(MPI_COMM_WORLD, filename,
+                    MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                    MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    throw_err("output_parts(), unable to open output file", procid);
+  MPI_File_set_size(fh, 0);
+
+  if (binary)
   {
-    if (debug)
-      for (uint64_t i = 0; i < g->n; ++i)
-        if (global_parts[i] == -1)
-        {
-          printf("Part error: %lu not assigned\n", i);
-          global_parts[i] = 0;
-        }
+    if (write_at_all(fh, write_start * sizeof(int32_t), (char *)write_parts,
+                     write_count * sizeof(int32_t)))
+      throw_err("output_parts(), unable to write output file", procid);
+  }
+  else
+  {
+    // Each thread measures then formats its own slice of lines directly
+    // into the task buffer, and tasks place their text by byte prefix sum
+    int32_t num_threads = omp_get_max_threads();
+    uint64_t *thread_offsets =
+        (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+    char *text = NULL;
+    uint64_t text_size = 0;
+
+#pragma omp parallel num_threads(num_threads)
+    {
+      int32_t tid = omp_get_thread_num();
+      uint64_t begin = write_count * (uint64_t)tid / (uint64_t)num_threads;
+      uint64_t end = write_count * (uint64_t)(tid + 1) / (uint64_t)num_threads;
+
+      uint64_t thread_size = 0;
+      for (uint64_t i = begin; i < end; ++i)
+        thread_size += format_length(write_parts[i]);
+      thread_offsets[tid + 1] = thread_size;
+
+#pragma omp barrier
+#pragma omp single
+      {
+        thread_offsets[0] = 0;
+        for (int32_t t = 0; t < num_threads; ++t)
+          thread_offsets[t + 1] += thread_offsets[t];
+        text_size = thread_offsets[num_threads];
+        text = (char *)malloc(text_size + 1);
+        if (text == NULL)
+          throw_err("output_parts(), unable to allocate text buffer", procid);
+      }
 
-    std::ofstream outfile;
-    outfile.open(filename);
+      char *p = text + thread_offsets[tid];
+      for (uint64_t i = begin; i < end; ++i)
+        p = format_int32(p, write_parts[i]);
+    }
 
-    for (uint64_t i = 0; i < g->n; ++i)
-      outfile << global_parts[i] << std::endl;
+    uint64_t text_start = 0;
+    MPI_Exscan(&text_size, &text_start, 1,
+               MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    if (procid == 0)
+      text_start = 0;
 
-    // FILE* fp = fopen(filename, "wb");
-    // fwrite(global_parts, sizeof(int32_t), g->n, fp);
-    // fclose(fp);
+    if (write_at_all(fh, text_start, text, text_size))
+      throw_err("output_parts(), unable to write output file", procid);
 
-    outfile.close();
+    free(thread_offsets);
+    free(text);
   }
 
-  free(global_parts);
+  MPI_File_close(&fh);
+  if (write_parts != parts)
+    free(write_parts);
 
   if (verbose)
-    printf("Task %d done writing parts\n", procid);
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d output_parts() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d output_parts() success\n", procid);
+  }
 
   return 0;
 }
 
-int read_parts(const char *filename, dist_graph_t *g,
-               pulp_data_t *pulp, bool offset_vids)
+int request_parts(uint64_t num_requests, uint64_t *request_ids,
+                  int32_t *request_tasks, int32_t *request_parts,
+                  int32_t *lookup_parts, uint64_t lookup_offset,
+                  fast_map *lookup_map)
 {
-  if (verbose)
-    printf("Task %d reading in parts from %s\n", procid, filename);
+  uint64_t *sendcounts = (uint64_t *)calloc(nprocs, sizeof(uint64_t));
+  uint64_t *recvcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *sdispls = (uint64_t *)malloc((nprocs + 1) * sizeof(uint64_t));
+  uint64_t *rdispls = (uint64_t *)malloc((nprocs + 1) * sizeof(uint64_t));
+  uint64_t *sdispls_cpy = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *request_index =
+      (uint64_t *)malloc(num_requests * sizeof(uint64_t));
+  uint64_t *sendbuf = (uint64_t *)malloc(num_requests * sizeof(uint64_t));
+  if (sendcounts == NULL || recvcounts == NULL || sdispls == NULL ||
+      rdispls == NULL || sdispls_cpy == NULL ||
+      (num_requests > 0 && (request_index == NULL || sendbuf == NULL)))
+    throw_err("request_parts(), unable to allocate request buffers", procid);
+
+  for (uint64_t i = 0; i < num_requests; ++i)
+    ++sendcounts[request_tasks[i]];
+
+  MPI_Alltoall(sendcounts, 1, MPI_UINT64_T,
+               recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+
+  sdispls[0] = 0;
+  rdispls[0] = 0;
+  for (int32_t i = 0; i < nprocs; ++i)
+  {
+    sdispls[i + 1] = sdispls[i] + sendcounts[i];
+    rdispls[i + 1] = rdispls[i] + recvcounts[i];
+    sdispls_cpy[i] = sdispls[i];
+  }
+
+  for (uint64_t i = 0; i < num_requests; ++i)
+  {
+    uint64_t index = sdispls_cpy[request_tasks[i]]++;
+    sendbuf[index] = request_ids[i];
+    request_index[index] = i;
+  }
 
-  int32_t *global_parts = (int32_t *)malloc(g->n * sizeof(int32_t));
+  uint64_t *recvbuf = (uint64_t *)malloc(rdispls[nprocs] * sizeof(uint64_t));
+  int32_t *response = (int32_t *)malloc(rdispls[nprocs] * sizeof(int32_t));
+  int32_t *answers = (int32_t *)malloc(num_requests * sizeof(int32_t));
+  if ((rdispls[nprocs] > 0 && (recvbuf == NULL || response == NULL)) ||
+      (num_requests > 0 && answers == NULL))
+    throw_err("request_parts(), unable to allocate response buffers", procid);
 
+  alltoallv_large(sendbuf, sendcounts, sdispls,
+                  recvbuf, recvcounts, rdispls, MPI_UINT64_T);
+
+  // Answer from the task's slice of the file, or from its local vertices
+  if (lookup_map != NULL)
+    get_values(lookup_map, recvbuf, recvbuf, rdispls[nprocs]);
+  else
+  {
 #pragma omp parallel for
-  for (uint64_t i = 0; i < g->n; ++i)
-    global_parts[i] = -1;
+    for (uint64_t i = 0; i < rdispls[nprocs]; ++i)
+      recvbuf[i] -= lookup_offset;
+  }
+
 #pragma omp parallel for
-  for (uint64_t i = 0; i < g->n_total; ++i)
-    pulp->local_parts[i] = -1;
+  for (uint64_t i = 0; i < rdispls[nprocs]; ++i)
+    response[i] = lookup_parts[recvbuf[i]];
 
-  if (procid == 0)
+  alltoallv_large(response, recvcounts, rdispls,
+                  answers, sendcounts, sdispls, MPI_INT32_T);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < num_requests; ++i)
+    request_parts[request_index[i]] = answers[i];
+
+  free(sendcounts);
+  free(recvcounts);
+  free(sdispls);
+  free(rdispls);
+  free(sdispls_cpy);
+  free(request_index);
+  free(sendbuf);
+  free(recvbuf);
+  free(response);
+  free(answers);
+
+  return 0;
+}
+
+int read_parts_slice(const char *filename, uint64_t *slice_bounds,
+                     int32_t *&slice_parts, bool binary)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("read_parts_slice() unable to open parts file", procid);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throw_err("read_parts_slice() unable to stat parts file", procid);
+  uint64_t file_size = (uint64_t)st.st_size;
+
+  uint64_t slice_start = slice_bounds[procid];
+  uint64_t slice_count = slice_bounds[procid + 1] - slice_start;
+  slice_parts = (int32_t *)malloc(slice_count * sizeof(int32_t));
+  if (slice_parts == NULL && slice_count > 0)
+    throw_err("read_parts_slice(), unable to allocate parts", procid);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < slice_count; ++i)
+    slice_parts[i] = -1;
+
+  if (binary)
   {
-    std::ifstream outfile;
-    outfile.open(filename);
+    uint64_t n_file = file_size / sizeof(int32_t);
+    uint64_t read_count = 0;
+    if (slice_start < n_file)
+      read_count = (n_file - slice_start) < slice_count ?
+                   (n_file - slice_start) : slice_count;
+    if (pread_full(fd, (char *)slice_parts, read_count * sizeof(int32_t),
+                   slice_start * sizeof(int32_t)))
+      throw_err("read_parts_slice(), unable to read parts file", procid);
+    close(fd);
+
+    return 0;
+  }
+
+  // Text parts are split by bytes, snapped to line starts, and parsed one
+  // thread chunk at a time; the parsed values are then shifted over to the
+  // tasks owning each slice of vertex ids
+  uint64_t read_begin = find_line_start(fd,
+      (file_size * (uint64_t)procid) / (uint64_t)nprocs, 0, file_size);
+  uint64_t read_end = file_size;
+  if (procid < nprocs - 1)
+    read_end = find_line_start(fd,
+        (file_size * (uint64_t)(procid + 1)) / (uint64_t)nprocs, 0, file_size);
+  uint64_t read_size = read_end - read_begin;
+
+  char *buf = (char *)malloc((read_size + 1) * sizeof(char));
+  if (buf == NULL)
+    throw_err("read_parts_slice(), unable to allocate read buffer", procid);
+  if (pread_full(fd, buf, read_size, read_begin))
+    throw_err("read_parts_slice(), unable to read parts file", procid);
+  buf[read_size] = '\0';
+  close(fd);
+
+  int32_t num_threads = omp_get_max_threads();
+  uint64_t *thread_begin =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  uint64_t *thread_counts =
+      (uint64_t *)malloc((num_threads + 1) * sizeof(uint64_t));
+  if (thread_begin == NULL || thread_counts == NULL)
+    throw_err("read_parts_slice(), unable to allocate thread offsets", procid);
+
+  thread_begin[0] = 0;
+  thread_begin[num_threads] = read_size;
+  for (int32_t t = 1; t < num_threads; ++t)
+  {
+    uint64_t pos = (read_size * (uint64_t)t) / (uint64_t)num_threads;
+    if (pos < thread_begin[t - 1])
+      pos = thread_begin[t - 1];
+    char *newline = NULL;
+    if (pos > 0 && pos < read_size)
+      newline = (char *)memchr(buf + pos - 1, '\n', read_size - pos + 1);
+    if (pos == 0)
+      thread_begin[t] = 0;
+    else if (newline == NULL)
+      thread_begin[t] = read_size;
+    else
+      thread_begin[t] = (uint64_t)(newline - buf) + 1;
+  }
 
-    for (uint64_t i = 0; i < g->n; ++i)
-      outfile >> global_parts[i];
+  // Count values first, like operator>> every token is one vertex's part
+#pragma omp parallel num_threads(num_threads)
+  {
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t count = 0;
 
-    outfile.close();
+    while (p < end)
+    {
+      while (next_token(p, end))
+      {
+        ++count;
+        skip_token(p, end);
+      }
+      if (p < end)
+        ++p;
+    }
 
-    if (debug)
-      for (uint64_t i = 0; i < g->n; ++i)
-        if (global_parts[i] == -1)
-        {
-          printf("Part error: %lu not assigned\n", i);
-          global_parts[i] = 0;
-        }
+    thread_counts[tid + 1] = count;
   }
 
-  MPI_Bcast(global_parts, (int32_t)g->n, MPI_INT32_T, 0, MPI_COMM_WORLD);
+  thread_counts[0] = 0;
+  for (int32_t t = 0; t < num_threads; ++t)
+    thread_counts[t + 1] += thread_counts[t];
+  uint64_t n_read = thread_counts[num_threads];
 
-  if (offset_vids)
+  int32_t *parsed_parts = (int32_t *)malloc(n_read * sizeof(int32_t));
+  if (parsed_parts == NULL && n_read > 0)
+    throw_err("read_parts_slice(), unable to allocate parsed parts", procid);
+
+#pragma omp parallel num_threads(num_threads)
   {
-#pragma omp parallel for
-    for (uint64_t i = 0; i < g->n_local; ++i)
+    int32_t tid = omp_get_thread_num();
+    const char *p = buf + thread_begin[tid];
+    const char *end = buf + thread_begin[tid + 1];
+    uint64_t index = thread_counts[tid];
+
+    while (p < end)
     {
-      uint64_t task = (uint64_t)procid;
-      uint64_t task_id = g->local_unmap[i] - g->n_offset;
-      uint64_t global_id = task_id * (uint64_t)nprocs + task;
-      if (global_id < g->n)
-        pulp->local_parts[i] = global_parts[global_id];
+      while (next_token(p, end))
+      {
+        bool negative = (*p == '-');
+        if (negative)
+          ++p;
+        int32_t part = (int32_t)parse_uint(p, end);
+        parsed_parts[index++] = negative ? -part : part;
+      }
+      if (p < end)
+        ++p;
     }
+  }
+
+  free(buf);
+  free(thread_begin);
+  free(thread_counts);
+
+  uint64_t read_start = 0;
+  MPI_Exscan(&n_read, &read_start, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  if (procid == 0)
+    read_start = 0;
+
+  // Both the read ranges and the slices are ascending by task, so each
+  // overlap is one contiguous run in the send and receive buffers
+  uint64_t *sendcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *recvcounts = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *sdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  uint64_t *rdispls = (uint64_t *)malloc(nprocs * sizeof(uint64_t));
+  if (sendcounts == NULL || recvcounts == NULL ||
+      sdispls == NULL || rdispls == NULL)
+    throw_err("read_parts_slice(), unable to allocate counts", procid);
+
+  for (int32_t i = 0; i < nprocs; ++i)
+  {
+    uint64_t begin = slice_bounds[i] > read_start ? 
+                     slice_bounds[i] : read_start;
+    uint64_t end = slice_bounds[i + 1] < read_start + n_read ?
+                   slice_bounds[i + 1] : read_start + n_read;
+    sendcounts[i] = end > begin ? end - begin : 0;
+    sdispls[i] = end > begin ? begin - read_start : 0;
+  }
+
+  MPI_Alltoall(sendcounts, 1, MPI_UINT64_T,
+               recvcounts, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+
+  rdispls[0] = 0;
+  for (int32_t i = 1; i < nprocs; ++i)
+    rdispls[i] = rdispls[i - 1] + recvcounts[i - 1];
+
+  alltoallv_large(parsed_parts, sendcounts, sdispls,
+                  slice_parts, recvcounts, rdispls, MPI_INT32_T);
+
+  free(parsed_parts);
+  free(sendcounts);
+  free(recvcounts);
+  free(sdispls);
+  free(rdispls);
+
+  return 0;
+}
+
+int read_parts(const char *filename, dist_graph_t *g,
+               pulp_data_t *pulp, bool offset_vids)
+{
+  read_parts(filename, g, pulp, offset_vids, false);
+
+  return 0;
+}
+
+int read_parts(const char *filename, dist_graph_t *g,
+               pulp_data_t *pulp, bool offset_vids, bool binary)
+{
+  if (debug)
+  {
+    printf("Task %d read_parts() start\n", procid);
+  }
+
+  double elt = 0.0;
+  if (verbose)
+  {
+    printf("Task %d reading in parts from %s\n", procid, filename);
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < g->n_total; ++i)
+    pulp->local_parts[i] = -1;
+
+  // Vertex ids as they appear in the file, which differ from the internal
+  // ids only when vertices were dealt out round-robin
+  uint64_t *file_ids = (uint64_t *)malloc(g->n_local * sizeof(uint64_t));
+  if (file_ids == NULL && g->n_local > 0)
+    throw_err("read_parts(), unable to allocate file ids", procid);
+
 #pragma omp parallel for
-    for (uint64_t i = 0; i < g->n_ghost; ++i)
+  for (uint64_t i = 0; i < g->n_local; ++i)
+  {
+    if (offset_vids)
     {
-      uint64_t task = (uint64_t)g->ghost_tasks[i];
-      uint64_t task_id = g->ghost_unmap[i] - task * (g->n / (uint64_t)nprocs + 1);
-      uint64_t global_id = task_id * (uint64_t)nprocs + task;
-      if (global_id < g->n)
-        pulp->local_parts[i + g->n_local] = global_parts[global_id];
+      uint64_t task_id = g->local_unmap[i] - g->n_offset;
+      file_ids[i] = task_id * (uint64_t)nprocs + (uint64_t)procid;
     }
-    if (debug)
-      for (uint64_t i = 0; i < g->n_total; ++i)
-        if (pulp->local_parts[i] == -1)
-        {
-          printf("Part error: %lu not assigned\n", i);
-          pulp->local_parts[i] = 0;
-        }
+    else
+      file_ids[i] = g->local_unmap[i];
   }
-  else
+
+  // Task i reads the parts of file ids [slice_bounds[i], slice_bounds[i+1]),
+  // sized like the local vertex counts so block distributions line up
+  uint64_t *slice_bounds = (uint64_t *)malloc((nprocs + 1) * sizeof(uint64_t));
+  if (slice_bounds == NULL)
+    throw_err("read_parts(), unable to allocate slice bounds", procid);
+  MPI_Allgather(&g->n_local, 1, MPI_UINT64_T,
+                slice_bounds + 1, 1, MPI_UINT64_T, MPI_COMM_WORLD);
+  slice_bounds[0] = 0;
+  for (int32_t i = 0; i < nprocs; ++i)
+    slice_bounds[i + 1] += slice_bounds[i];
+  slice_bounds[nprocs] = g->n;
+  for (int32_t i = nprocs - 1; i >= 0; --i)
+    if (slice_bounds[i] > slice_bounds[i + 1])
+      slice_bounds[i] = slice_bounds[i + 1];
+
+  int32_t *slice_parts = NULL;
+  read_parts_slice(filename, slice_bounds, slice_parts, binary);
+
+  uint64_t slice_start = slice_bounds[procid];
+  uint64_t slice_end = slice_bounds[procid + 1];
+  uint64_t num_requests = 0;
+#pragma omp parallel for reduction(+ : num_requests)
+  for (uint64_t i = 0; i < g->n_local; ++i)
+  {
+    if (file_ids[i] >= slice_start && file_ids[i] < slice_end)
+      pulp->local_parts[i] = slice_parts[file_ids[i] - slice_start];
+    else if (file_ids[i] < g->n)
+      ++num_requests;
+  }
+
+  // Anything not in our own slice is requested from the task reading it
+  uint64_t *request_ids = (uint64_t *)malloc(num_requests * sizeof(uint64_t));
+  int32_t *request_tasks = (int32_t *)malloc(num_requests * sizeof(int32_t));
+  uint64_t *request_verts = (uint64_t *)malloc(num_requests * sizeof(uint64_t));
+  int32_t *request_answers = (int32_t *)malloc(num_requests * sizeof(int32_t));
+  if (num_requests > 0 && (request_ids == NULL || request_tasks == NULL ||
+                           request_verts == NULL || request_answers == NULL))
+    throw_err("read_parts(), unable to allocate requests", procid);
+
+  uint64_t request_count = 0;
+  for (uint64_t i = 0; i < g->n_local; ++i)
   {
+    if ((file_ids[i] >= slice_start && file_ids[i] < slice_end) ||
+        file_ids[i] >= g->n)
+      continue;
+
+    request_ids[request_count] = file_ids[i];
+    request_tasks[request_count] = (int32_t)(std::upper_bound(
+        slice_bounds, slice_bounds + nprocs + 1, file_ids[i]) -
+        slice_bounds - 1);
+    request_verts[request_count] = i;
+    ++request_count;
+  }
+
+  request_parts(num_requests, request_ids, request_tasks, request_answers,
+                slice_parts, slice_start, NULL);
+
 #pragma omp parallel for
-    for (uint64_t i = 0; i < g->n_local; ++i)
-      pulp->local_parts[i] = global_parts[g->local_unmap[i]];
+  for (uint64_t i = 0; i < num_requests; ++i)
+    pulp->local_parts[request_verts[i]] = request_answers[i];
+
+  free(file_ids);
+  free(slice_bounds);
+  free(slice_parts);
+  free(request_ids);
+  free(request_tasks);
+  free(request_verts);
+  free(request_answers);
+
+  // Ghost parts come straight from the owning tasks' local parts
+  int32_t *ghost_tasks = (int32_t *)malloc(g->n_ghost * sizeof(int32_t));
+  if (ghost_tasks == NULL && g->n_ghost > 0)
+    throw_err("read_parts(), unable to allocate ghost tasks", procid);
+
 #pragma omp parallel for
-    for (uint64_t i = 0; i < g->n_ghost; ++i)
-      pulp->local_parts[i + g->n_local] = global_parts[g->ghost_unmap[i]];
-  }
+  for (uint64_t i = 0; i < g->n_ghost; ++i)
+    ghost_tasks[i] = (int32_t)g->ghost_tasks[i];
 
-  free(global_parts);
+  request_parts(g->n_ghost, g->ghost_unmap, ghost_tasks,
+                pulp->local_parts + g->n_local,
+                pulp->local_parts, 0, g->map);
+
+  free(ghost_tasks);
+
+  if (debug)
+    for (uint64_t i = 0; i < g->n_total; ++i)
+      if (pulp->local_parts[i] == -1)
+      {
+        printf("Part error: %lu not assigned\n", i);
+        pulp->local_parts[i] = 0;
+      }
 
   if (verbose)
-    printf("Task %d done reading in parts\n", procid);
+  {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d read_parts() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug)
+  {
+    printf("Task %d read_parts() success\n", procid);
+  }
 
   return 0;
 }
@@ -51,21 +51,81 @@
 #include "dist_graph.h"
 #include "comms.h"
 
+// Binary CSR container written by pulp's graph2csr: the header, then
+// 64-byte aligned sections of uint64_t offsets, adjacencies of adj_bytes
+// each, int32_t vertex weights, and int32_t edge weights. A start offset of
+// 0 marks an absent weight section. A copy of pulp/0.2/csr.h, so keep the
+// two in step; the size check below catches a field added to only one.
+#define CSR_MAGIC "PULPCSR"
+#define CSR_VERSION 1
+#define CSR_READ_CHUNK 16777216
+
+// Edges per read/exchange round when streaming binary edge lists
+#define EDGE_CHUNK_SIZE 262144
+
+struct csr_header_t {
+  char magic[8];
+  uint32_t version;
+  uint32_t adj_bytes;
+  uint64_t n;
+  uint64_t m;
+  uint64_t num_vert_weights;
+  uint64_t num_edge_weights;
+  uint64_t offsets_start;
+  uint64_t adjs_start;
+  uint64_t vert_weights_start;
+  uint64_t edge_weights_start;
+  uint64_t file_size;
+};
+static_assert(sizeof(csr_header_t) == 88, 
+              "csr_header_t must match pulp/0.2/csr.h");
+
 int load_graph_edges_32(char *input_filename, graph_gen_data_t *ggi, 
                         bool offset_vids);
 
+int stream_edges_pass(int fd, uint64_t edge_start, uint64_t nedges,
+                      uint64_t num_chunks, uint64_t n_per_rank,
+                      uint64_t n_offset, uint64_t* local_counts,
+                      uint64_t* out_edges);
+
+int load_graph_streaming_32(char *input_filename, dist_graph_t* g,
+                            bool offset_vids);
+
 int load_graph_edges_64(char *input_filename, graph_gen_data_t *ggi, 
                         bool offset_vids);
 
 int scale_weights(uint64_t n, uint64_t num_weights, 
                   float* weights_in, int32_t* weights_out);
 
-int read_adj(char* input_filename, 
-  graph_gen_data_t *ggi, bool offset_vids);
+int scale_weights(uint64_t n, uint64_t num_weights, 
+                  float* weights_in, int32_t* weights_out, bool global_scale);
+
+int pread_full(int fd, char* buf, uint64_t count, uint64_t offset);
+
+int write_at_all(MPI_File fh, uint64_t offset, char* buf, uint64_t count);
+
+uint64_t find_line_start(int fd, uint64_t pos, uint64_t begin, uint64_t end);
+
+int read_adj_parallel(char* input_filename, graph_gen_data_t *ggi, 
+  bool offset_vids, uint64_t data_offset);
+
+// Whitespace separated "src dst ..." lines, SNAP or Matrix Market; lines
+// starting with # or % are skipped and ids may be 0- or 1-based
+int read_edge_list_text(char* input_filename, graph_gen_data_t *ggi,
+  bool offset_vids);
 
 int read_graph(char* input_filename, 
   graph_gen_data_t *ggi, bool offset_vids);
 
+bool is_csr_graph(char* input_filename);
+
+int read_csr_graph(char* input_filename, dist_graph_t* g, bool offset_vids);
+
+// Each weight file holds n native int32 values, the weight of vertex i at
+// byte offset 4*i; the mask file holds one bit per vertex, bit i%8 of byte i/8
+int read_vert_weights(char** weight_filenames, int32_t num_weight_files,
+                      char* mask_filename, dist_graph_t* g);
+
 int exchange_edges(graph_gen_data_t *ggi, mpi_data_t* comm);
 
 int exchange_edges_weighted(graph_gen_data_t *ggi, mpi_data_t* comm);
@@ -75,7 +135,21 @@ int output_parts(const char* filename, dist_graph_t* g, int32_t* parts);
 int output_parts(const char* filename, dist_graph_t* g, 
                  int32_t* parts, bool offset_vids);
 
+int output_parts(const char* filename, dist_graph_t* g, 
+                 int32_t* parts, bool offset_vids, bool binary);
+
+int request_parts(uint64_t num_requests, uint64_t* request_ids,
+                  int32_t* request_tasks, int32_t* request_parts,
+                  int32_t* lookup_parts, uint64_t lookup_offset,
+                  fast_map* lookup_map);
+
+int read_parts_slice(const char* filename, uint64_t* slice_bounds,
+                     int32_t*& slice_parts, bool binary);
+
 int read_parts(const char* filename, dist_graph_t* g, 
                pulp_data_t* pulp, bool offset_vids);
 
+int read_parts(const char* filename, dist_graph_t* g, 
+               pulp_data_t* pulp, bool offset_vids, bool binary);
+
 #endif
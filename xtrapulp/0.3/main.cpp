@@ -55,6 +55,7 @@
 #include "generate.h"
 #include "comms.h"
 #include "io_pp.h"
+#include "snapshot.h"
 #include "pulp_util.h"
 #include "util.h"
 
@@ -80,6 +81,19 @@ void print_usage_full(char **argv)
   printf("\t-a\n");
   printf("\t\tGraph file is adjacency (METIS) format\n");
   printf("\t\tDefault is unsigned 32-bit binary edge list\n");
+  printf("\t-u\n");
+  printf("\t\tGraph file is unsigned 32-bit binary edge list, streamed\n");
+  printf("\t-x\n");
+  printf("\t\tGraph file is text edge list (SNAP or Matrix Market)\n");
+  printf("\t-k [prefix]\n");
+  printf("\t\tReuse graph snapshot at prefix if it matches the input,\n");
+  printf("\t\telse build the graph and write a snapshot there\n");
+  printf("\t-L\n");
+  printf("\t\tSort each adjacency list by neighbor index\n");
+  printf("\t-W \"file file ...\"\n");
+  printf("\t\tSpace delimited list of binary int32 vertex weight files\n");
+  printf("\t-M [file]\n");
+  printf("\t\tBinary bitset of training vertices, added as the last weight\n");
   printf("\t-t \"#.# #.# ...\"\n");
   printf("\t\tFor PuLP-W: Space delimited list of constraints\n");
   printf("\t-v [#.#]:\n");
@@ -97,10 +111,20 @@ void print_usage_full(char **argv)
   printf("\t\tGenerate multiple partitions [default: 1]\n");
   printf("\t-o [file]:\n");
   printf("\t\tOutput parts file [default: graphname.part.numparts]\n");
+  printf("\t-b:\n");
+  printf("\t\tInput and output parts files are binary int32, not text\n");
   printf("\t-i [file]:\n");
   printf("\t\tInput parts file [default: none]\n");
   printf("\t-s [seed]:\n");
   printf("\t\tSet seed integer [default: random int]\n");
+  printf("\t-O:\n");
+  printf("\t\tOverlap boundary exchanges with the interior sweep\n");
+  printf("\t-N:\n");
+  printf("\t\tExchange through shared memory on a node and node leaders\n");
+  printf("\t-R:\n");
+  printf("\t\tExchange ghost updates with one-sided puts\n");
+  printf("\t-S:\n");
+  printf("\t\tReduce only changed part sizes (weighted graphs)\n");
   exit(0);
 }
 
@@ -120,6 +144,21 @@ int parse_constraints(char *optarg,
   return 0;
 }
 
+int parse_filenames(char *optarg,
+                    char **filenames, int32_t &num_files)
+{
+  num_files = 0;
+  for (char *name = strtok(optarg, " "); name != NULL; 
+       name = strtok(NULL, " "))
+  {
+    filenames[num_files++] = name;
+    if (num_files >= MAX_CONSTRAINTS)
+      throw_err("Maximum weight files is 1024. Check input formatting.");
+  }
+
+  return 0;
+}
+
 int main(int argc, char **argv)
 {
   srand(time(0));
@@ -153,6 +192,12 @@ int main(int argc, char **argv)
   parts_out[0] = '\0';
   char parts_in[1024];
   parts_in[0] = '\0';
+  char snapshot_prefix[1024];
+  snapshot_prefix[0] = '\0';
+  char mask_file[1024];
+  mask_file[0] = '\0';
+  char *weight_files[MAX_CONSTRAINTS];
+  int32_t num_weight_files = 0;
 
   strcat(input_filename, argv[1]);
   int32_t num_parts = atoi(argv[2]);
@@ -161,10 +206,13 @@ int main(int argc, char **argv)
   double constraints[MAX_CONSTRAINTS];
   int32_t num_constraints = 0;
   bool adj_format = false;
+  bool edge_list_format = false;
+  bool edge_text_format = false;
 
   uint64_t num_runs = 1;
   bool output_time = true;
   bool output_quality = false;
+  bool binary_parts = false;
 
   bool gen_rmat = false;
   bool gen_rand = false;
@@ -172,6 +220,7 @@ int main(int argc, char **argv)
   uint64_t gen_n = 0;
   uint64_t gen_m_per_n = 16;
   bool offset_vids = false;
+  bool sort_adjs = false;
   int pulp_seed = rand();
 
   bool do_bfs_init = true;
@@ -179,11 +228,15 @@ int main(int argc, char **argv)
   bool do_repart = false;
   bool do_edge_balance = false;
   bool do_maxcut_balance = false;
+  bool do_overlap_comm = false;
+  bool do_node_exchange = false;
+  bool do_rma_exchange = false;
+  bool do_sparse_part_sizes = false;
 
   char c;
   adj_format = true;
   output_quality = true;
-  while ((c = getopt(argc, argv, "v:e:o:i:mn:s:p:dlqtc:az:w:")) != -1)
+  while ((c = getopt(argc, argv, "v:e:o:i:bmn:s:p:dlqtc:auxk:z:w:W:M:ONRSL")) != -1)
   {
     switch (c)
     {
@@ -193,6 +246,20 @@ int main(int argc, char **argv)
     case 'a':
       adj_format = true;
       break;
+    case 'u':
+      adj_format = false;
+      edge_list_format = true;
+      break;
+    case 'x':
+      adj_format = false;
+      edge_text_format = true;
+      break;
+    case 'k':
+      strcat(snapshot_prefix, optarg);
+      break;
+    case 'L':
+      sort_adjs = true;
+      break;
     case 'c':
       parse_constraints(optarg, constraints, num_constraints);
       break;
@@ -209,6 +276,9 @@ int main(int argc, char **argv)
     case 'o':
       strcat(parts_out, optarg);
       break;
+    case 'b':
+      binary_parts = true;
+      break;
     case 'i':
       strcat(parts_in, optarg);
       do_repart = true;
@@ -254,14 +324,40 @@ int main(int argc, char **argv)
     case 'w':
       train_wid = atoi(optarg);
       break;
+    case 'W':
+      parse_filenames(optarg, weight_files, num_weight_files);
+      break;
+    case 'M':
+      strcat(mask_file, optarg);
+      break;
+    case 'O':
+      do_overlap_comm = true;
+      break;
+    case 'N':
+      do_node_exchange = true;
+      break;
+    case 'R':
+      do_rma_exchange = true;
+      break;
+    case 'S':
+      do_sparse_part_sizes = true;
+      break;
     default:
       throw_err("Input argument format error");
     }
   }
+  if (mask_file[0] != '\0')
+    train_wid = num_weight_files;
   printf("Batch size = %ld\n", batch_size);
   printf("Train nids weight id = %ld\n", train_wid);
 
   graph_gen_data_t *ggi = (graph_gen_data_t *)malloc(sizeof(graph_gen_data_t));
+  dist_graph_t *g = (dist_graph_t *)malloc(sizeof(dist_graph_t));
+  bool direct_load = false;
+  bool from_snapshot = false;
+  graph_snapshot_t snap = {NULL, 0};
+  uint64_t input_hash = 0;
+  int32_t snapshot_format = -1;
   if (gen_rand)
   {
     std::stringstream ss;
@@ -290,22 +386,63 @@ int main(int argc, char **argv)
       printf("Reading in graphfile %s\n", input_filename);
     strcat(graphname, input_filename);
 
-    if (adj_format)
+    int32_t input_format = INPUT_FORMAT_ADJ;
+    if (is_csr_graph(input_filename))
+      input_format = INPUT_FORMAT_CSR;
+    else if (edge_text_format)
+      input_format = INPUT_FORMAT_EDGE_TEXT;
+    else if (edge_list_format || !adj_format)
+      input_format = INPUT_FORMAT_EDGE_LIST;
+
+    if (snapshot_prefix[0] != '\0')
+    {
+      input_hash = hash_input_file(input_filename);
+      from_snapshot = load_graph_snapshot(snapshot_prefix, input_hash,
+                                          input_format, offset_vids, 
+                                          sort_adjs, g, &snap);
+    }
+
+    if (from_snapshot)
+    {
+      direct_load = true;
+      if (procid == 0)
+        printf("Loaded graph snapshot %s\n", snapshot_prefix);
+    }
+    else if (input_format == INPUT_FORMAT_CSR)
+    {
+      direct_load = true;
+      read_csr_graph(input_filename, g, offset_vids);
+    }
+    else if (edge_list_format)
+    {
+      direct_load = true;
+      load_graph_streaming_32(input_filename, g, offset_vids);
+    }
+    else if (edge_text_format)
+      read_edge_list_text(input_filename, ggi, offset_vids);
+    else if (adj_format)
       read_graph(input_filename, ggi, offset_vids);
     else
       load_graph_edges_32(input_filename, ggi, offset_vids);
 
+    if (snapshot_prefix[0] != '\0')
+      snapshot_format = input_format;
+
     elt = omp_get_wtime() - elt;
     if (procid == 0)
       printf("Reading Finished: %9.6lf (s)\n", elt);
   }
 
-  dist_graph_t *g = (dist_graph_t *)malloc(sizeof(dist_graph_t));
   mpi_data_t *comm = (mpi_data_t *)malloc(sizeof(mpi_data_t));
   pulp_data_t *pulp = (pulp_data_t *)malloc(sizeof(pulp_data_t));
   queue_data_t *q = (queue_data_t *)malloc(sizeof(queue_data_t));
   init_comm_data(comm);
-  if (nprocs > 1)
+  if (direct_load)
+  {
+    // These readers build the local CSR themselves, nothing to exchange
+    free(ggi);
+  }
+  else if (nprocs > 1)
   {
     if (ggi->num_vert_weights > 0)
     {
@@ -332,6 +469,29 @@ int main(int argc, char **argv)
     }
     // set_weights_graph(g);
   }
+  // A loaded snapshot was saved with the requested order already
+  if (sort_adjs && !from_snapshot)
+    sort_adjacencies(g);
+  init_queue_data(g, q);
+  if (!from_snapshot)
+    get_ghost_degrees(g, comm, q);
+  if (!from_snapshot && snapshot_format >= 0)
+    write_graph_snapshot(snapshot_prefix, input_filename, input_hash,
+                         snapshot_format, offset_vids, sort_adjs, g);
+
+  // Sidecar weights replace any read with the graph. They are applied after
+  // the snapshot is written, so a snapshot never holds them
+  if (num_weight_files > 0 || mask_file[0] != '\0')
+  {
+    if (!from_snapshot && g->vert_weights != NULL)
+    {
+      free(g->vert_weights);
+      free(g->vert_weights_sums);
+      free(g->max_vert_weights);
+    }
+    read_vert_weights(weight_files, num_weight_files, mask_file, g);
+  }
+
   if (g->num_vert_weights > 0)
   {
     init_pulp_data_weighted(g, pulp, num_parts);
@@ -340,8 +500,6 @@ int main(int argc, char **argv)
   {
     init_pulp_data(g, pulp, num_parts);
   }
-  init_queue_data(g, q);
-  get_ghost_degrees(g, comm, q);
 
   pulp_part_control_t *ppc =
       (pulp_part_control_t *)malloc(sizeof(pulp_part_control_t));
@@ -350,7 +508,8 @@ int main(int argc, char **argv)
       constraints, (int)g->num_vert_weights,
       do_lp_init, do_bfs_init, do_repart,
       do_edge_balance, do_maxcut_balance,
-      false, pulp_seed};
+      false, pulp_seed, do_overlap_comm, do_node_exchange,
+      do_rma_exchange, do_sparse_part_sizes};
 
   double total_elt = 0.0;
   for (uint32_t i = 0; i < num_runs; ++i)
@@ -361,7 +520,7 @@ int main(int argc, char **argv)
       if (procid == 0)
         printf("Reading in parts file %s\n", parts_in);
       elt = omp_get_wtime();
-      read_parts(parts_in, g, pulp, offset_vids);
+      read_parts(parts_in, g, pulp, offset_vids, binary_parts);
       elt = omp_get_wtime() - elt;
       if (procid == 0)
         printf("Reading Finished: %9.6lf (s)\n", elt);
@@ -414,7 +573,7 @@ int main(int argc, char **argv)
     if (procid == 0)
       printf("Writing out parts file %s\n", temp_out);
     elt = omp_get_wtime();
-    output_parts(temp_out, g, pulp->local_parts, offset_vids);
+    output_parts(temp_out, g, pulp->local_parts, offset_vids, binary_parts);
     if (procid == 0)
       printf("Done Writing: %9.6lf (s)\n", omp_get_wtime() - elt);
   }
@@ -423,6 +582,8 @@ int main(int argc, char **argv)
     printf("XtraPuLP Avg. Time: %9.6lf (s)\n", (total_elt / (double)num_runs));
   }
 
+  if (from_snapshot)
+    clear_graph_snapshot(g, &snap);
   // clear_graph(g);
   // free(g);
   // clear_comm_data(comm);
@@ -55,15 +55,89 @@ extern int procid, nprocs;
 extern bool verbose, debug, verify;
 
 
+// Per-thread part arrays, kept between parallel regions from
+// init_thread_pulp_pool() to clear_thread_pulp_pool() and filled in by each
+// thread on its first use
+thread_pulp_t* thread_pulps = NULL;
+int32_t num_thread_pulps = 0;
+int32_t thread_pulp_parts = 0;
+uint64_t thread_pulp_weights = 0;
+
+void init_thread_pulp_pool(int32_t num_parts, uint64_t num_vert_weights)
+{
+  num_thread_pulps = omp_get_max_threads();
+  thread_pulps = (thread_pulp_t*)calloc(num_thread_pulps, sizeof(thread_pulp_t));
+  if (thread_pulps == NULL)
+    throw_err("init_thread_pulp_pool(), unable to allocate resources\n", procid);
+  thread_pulp_parts = num_parts;
+  thread_pulp_weights = num_vert_weights;
+}
+
+void clear_thread_pulp_pool()
+{
+  for (int32_t t = 0; t < num_thread_pulps; ++t)
+  {
+    thread_pulp_t* tp = &thread_pulps[t];
+    free(tp->part_counts);
+    free(tp->part_vert_weights);
+    free(tp->part_edge_weights);
+    free(tp->part_cut_weights);
+    if (tp->part_weights != NULL)
+      for (uint64_t w = 0; w < thread_pulp_weights; ++w)
+        free(tp->part_weights[w]);
+    free(tp->part_weights);
+  }
+  free(thread_pulps);
+  thread_pulps = NULL;
+  num_thread_pulps = 0;
+}
+
+// Callers outside the pooled call, or sized differently, allocate their own
+thread_pulp_t* get_thread_pulp(pulp_data_t* pulp, uint64_t num_vert_weights)
+{
+  int32_t tid = omp_get_thread_num();
+  if (tid >= num_thread_pulps || pulp->num_parts != thread_pulp_parts || 
+      (num_vert_weights > 0 && num_vert_weights != thread_pulp_weights))
+    return NULL;
+
+  return &thread_pulps[tid];
+}
+
 void init_thread_pulp(thread_pulp_t* tp, pulp_data_t* pulp)
 {  
   //if (debug) printf("Task %d init_thread_pulp() start\n", procid); 
 
-  tp->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
+  thread_pulp_t* pool = get_thread_pulp(pulp, 0);
+  tp->pooled = (pool != NULL);
+  if (tp->pooled)
+  {
+    if (pool->part_vert_weights == NULL)
+    {
+      if (pool->part_counts == NULL)
+        pool->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
+      if (pool->part_cut_weights == NULL)
+        pool->part_cut_weights = 
+          (double*)malloc(pulp->num_parts*sizeof(double));
+      pool->part_vert_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+      pool->part_edge_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+    }
+    tp->part_counts = pool->part_counts;
+    tp->part_vert_weights = pool->part_vert_weights;
+    tp->part_edge_weights = pool->part_edge_weights;
+    tp->part_cut_weights = pool->part_cut_weights;
+  }
+  else
+  {
+    tp->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
+    tp->part_vert_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+    tp->part_edge_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+    tp->part_cut_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+  }
   tp->part_weights = NULL;
-  tp->part_vert_weights = (double*)malloc(pulp->num_parts*sizeof(double));
-  tp->part_edge_weights = (double*)malloc(pulp->num_parts*sizeof(double));
-  tp->part_cut_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+  if (tp->part_counts == NULL || tp->part_vert_weights == NULL ||
+      tp->part_edge_weights == NULL || tp->part_cut_weights == NULL)
+    throw_err("init_thread_pulp(), unable to allocate resources\n", procid);
+
   for (int32_t p = 0; p < pulp->num_parts; ++p) {
     tp->part_counts[p] = 0.0;
     tp->part_vert_weights[p] = 0.0;
@@ -80,13 +154,39 @@ void init_thread_pulp(thread_pulp_t* tp, pulp_data_t* pulp,
 {  
   //if (debug) printf("Task %d init_thread_pulp() start\n", procid); 
 
-  tp->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
-  tp->part_weights = (double**)malloc(num_vert_weights*sizeof(double*));
-  for (uint64_t w = 0; w < num_vert_weights; ++w)
-    tp->part_weights[w] = (double*)malloc(pulp->num_parts*sizeof(double));
+  thread_pulp_t* pool = get_thread_pulp(pulp, num_vert_weights);
+  tp->pooled = (pool != NULL);
+  if (tp->pooled)
+  {
+    if (pool->part_weights == NULL)
+    {
+      if (pool->part_counts == NULL)
+        pool->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
+      if (pool->part_cut_weights == NULL)
+        pool->part_cut_weights = 
+          (double*)malloc(pulp->num_parts*sizeof(double));
+      pool->part_weights = (double**)malloc(num_vert_weights*sizeof(double*));
+      for (uint64_t w = 0; w < num_vert_weights; ++w)
+        pool->part_weights[w] = 
+          (double*)malloc(pulp->num_parts*sizeof(double));
+    }
+    tp->part_counts = pool->part_counts;
+    tp->part_weights = pool->part_weights;
+    tp->part_cut_weights = pool->part_cut_weights;
+  }
+  else
+  {
+    tp->part_counts = (double*)malloc(pulp->num_parts*sizeof(double));
+    tp->part_weights = (double**)malloc(num_vert_weights*sizeof(double*));
+    for (uint64_t w = 0; w < num_vert_weights; ++w)
+      tp->part_weights[w] = (double*)malloc(pulp->num_parts*sizeof(double));
+    tp->part_cut_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+  }
   tp->part_vert_weights = NULL;
   tp->part_edge_weights = NULL;
-  tp->part_cut_weights = (double*)malloc(pulp->num_parts*sizeof(double));
+  if (tp->part_counts == NULL || tp->part_weights == NULL ||
+      tp->part_cut_weights == NULL)
+    throw_err("init_thread_pulp(), unable to allocate resources\n", procid);
 
    for (int32_t p = 0; p < pulp->num_parts; ++p) {
     tp->part_counts[p] = 0.0;
@@ -103,6 +203,9 @@ void clear_thread_pulp(thread_pulp_t* tp)
 {
   //if (debug) printf("Task %d clear_thread_pulp() start\n", procid); 
 
+  if (tp->pooled)
+    return;
+
   free(tp->part_counts);
   if (tp->part_weights != NULL) {
     free(tp->part_weights);
@@ -136,6 +239,18 @@ void init_pulp_data(
   pulp->avg_sizes = NULL;
   pulp->part_sizes = NULL;
   pulp->part_size_changes = NULL;
+  pulp->size_changes = NULL;
+  pulp->sparse_sizes = false;
+  pulp->part_touched = NULL;
+  pulp->touched_parts = NULL;
+  pulp->changed_parts = NULL;
+  pulp->owned_seen = NULL;
+  pulp->owned_parts = NULL;
+  pulp->owned_sums = NULL;
+  pulp->sparse_sendbuf = NULL;
+  pulp->sparse_recvbuf = NULL;
+  pulp->sparse_counts = NULL;
+  pulp->size_trees = NULL;
   ////////////////////////////
 
   pulp->local_parts = (int32_t*)malloc(g->n_total*sizeof(int32_t));  
@@ -176,6 +291,8 @@ void init_pulp_data(
   for (int32_t p = 0; p < pulp->num_parts; ++p)
     pulp->part_cut_size_changes[p] = 0;
   
+  init_tally_width(g, pulp);
+
   if (debug) printf("Task %d init_pulp_data() success\n", procid);
 }
 
@@ -198,7 +315,7 @@ void update_pulp_data(dist_graph_t* g, pulp_data_t* pulp)
     uint64_t vert_index = i;
     int32_t part = pulp->local_parts[vert_index];
     uint64_t out_degree = out_degree(g, vert_index);
-    uint64_t* outs = out_vertices(g, vert_index);
+    lid_t* outs = out_vertices(g, vert_index);
     pulp->part_vert_sizes[part] += 1;
     pulp->part_edge_sizes[part] += (int64_t)out_degree;
     for (uint64_t j = 0; j < out_degree; ++j)
@@ -276,23 +393,38 @@ void init_pulp_data_weighted(
   for (uint64_t w = 0; w < g->num_vert_weights; ++w)
     pulp->part_sizes[w] = (int64_t*)malloc(pulp->num_parts*sizeof(int64_t));
   
+  // All deltas share one block so pulp_w() reduces them in a single call,
+  // part_cut_size_changes first, then each part_size_changes[w], then room
+  // for cut_size_change
+  pulp->size_changes = (int64_t*)malloc(
+    ((g->num_vert_weights+1)*pulp->num_parts+1)*sizeof(int64_t));
   pulp->part_size_changes = (int64_t**)malloc(g->num_vert_weights*sizeof(int64_t*));
   for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-    pulp->part_size_changes[w] = 
-        (int64_t*)malloc(pulp->num_parts*sizeof(int64_t));
+    pulp->part_size_changes[w] = pulp->size_changes + (w+1)*pulp->num_parts;
 
   pulp->part_cut_sizes = (int64_t*)malloc(pulp->num_parts*sizeof(int64_t));
-  pulp->part_cut_size_changes = (int64_t*)malloc(pulp->num_parts*sizeof(int64_t));
+  pulp->part_cut_size_changes = pulp->size_changes;
   if (pulp->local_parts == NULL || 
       pulp->part_sizes == NULL || 
       pulp->part_cut_sizes == NULL || 
       pulp->part_size_changes == NULL || 
-      pulp->part_cut_size_changes == NULL)
+      pulp->size_changes == NULL)
     throw_err("init_pulp_data_weighted(), unable to allocate resources", procid);
 
   pulp->cut_size = 0;
   pulp->max_cut = 0;
   pulp->cut_size_change = 0;
+  pulp->sparse_sizes = false;
+  pulp->part_touched = NULL;
+  pulp->touched_parts = NULL;
+  pulp->changed_parts = NULL;
+  pulp->owned_seen = NULL;
+  pulp->owned_parts = NULL;
+  pulp->owned_sums = NULL;
+  pulp->sparse_sendbuf = NULL;
+  pulp->sparse_recvbuf = NULL;
+  pulp->sparse_counts = NULL;
+  pulp->size_trees = NULL;
 
   for (uint64_t w = 0; w < g->num_vert_weights; ++w)
     for (int32_t p = 0; p < pulp->num_parts; ++p)
@@ -309,6 +441,8 @@ void init_pulp_data_weighted(
   for (uint64_t w = 0; w < g->num_vert_weights; ++w)
     pulp->maxes[w] = 0.0;
   
+  init_tally_width(g, pulp);
+
   if (debug) printf("Task %d init_pulp_data_weighted() success\n", procid);
 }
 
@@ -338,7 +472,7 @@ void update_pulp_data_weighted(dist_graph_t* g, pulp_data_t* pulp)
           g->vert_weights[vert_index*g->num_vert_weights + w];
 
     uint64_t out_degree = out_degree(g, vert_index);
-    uint64_t* outs = out_vertices(g, vert_index);
+    lid_t* outs = out_vertices(g, vert_index);
     int32_t* weights = out_weights(g, vert_index);
     for (uint64_t j = 0; j < out_degree; ++j)
     {
@@ -380,6 +514,9 @@ void update_pulp_data_weighted(dist_graph_t* g, pulp_data_t* pulp)
     }
   }
 
+  if (pulp->size_trees != NULL)
+    build_part_size_trees(g, pulp);
+
   if (debug) printf("Task %d update_pulp_data_weighted() success\n", procid);
 }
 
@@ -397,6 +534,105 @@ void clear_pulp_data(pulp_data_t* pulp)
   free(pulp->part_size_changes);
   free(pulp->part_edge_size_changes);
   free(pulp->part_cut_size_changes);
+  free(pulp->part_touched);
+  free(pulp->touched_parts);
+  free(pulp->changed_parts);
+  free(pulp->owned_seen);
+  free(pulp->owned_parts);
+  free(pulp->owned_sums);
+  free(pulp->sparse_sendbuf);
+  free(pulp->sparse_recvbuf);
+  free(pulp->sparse_counts);
+  free(pulp->size_trees);
 
   if (debug) printf("Task %d clear_pulp_data() success\n", procid); 
 }
+
+// Sparse mode sends only the parts whose sizes changed, as records of the
+// part id, its cut delta, and one delta per weight. Part p is summed on
+// task p % nprocs, and the summed records are then gathered everywhere.
+// One pseudo part past the last carries cut_size_change.
+void init_sparse_part_sizes(dist_graph_t* g, pulp_data_t* pulp)
+{
+  if (debug) printf("Task %d init_sparse_part_sizes() start\n", procid); 
+
+  // Repeated runs reuse the buffers from the first
+  if (pulp->part_touched != NULL)
+    return;
+
+  uint64_t record_size = g->num_vert_weights + 2;
+  uint64_t num_owned = (uint64_t)pulp->num_parts / nprocs + 1;
+
+  pulp->part_touched = (int32_t*)malloc((pulp->num_parts+1)*sizeof(int32_t));
+  pulp->touched_parts = (int32_t*)malloc((pulp->num_parts+1)*sizeof(int32_t));
+  pulp->changed_parts = (int32_t*)malloc((pulp->num_parts+1)*sizeof(int32_t));
+  pulp->owned_seen = (int32_t*)malloc(num_owned*sizeof(int32_t));
+  pulp->owned_parts = (int32_t*)malloc(num_owned*sizeof(int32_t));
+  pulp->owned_sums = 
+    (int64_t*)malloc(num_owned*(record_size-1)*sizeof(int64_t));
+  pulp->sparse_sendbuf = 
+    (int64_t*)malloc((pulp->num_parts+1)*record_size*sizeof(int64_t));
+  pulp->sparse_recvbuf = 
+    (int64_t*)malloc(nprocs*num_owned*record_size*sizeof(int64_t));
+  pulp->sparse_counts = (int32_t*)malloc(6*nprocs*sizeof(int32_t));
+  pulp->size_trees = (int64_t*)malloc(
+    2*g->num_vert_weights*pulp->num_parts*sizeof(int64_t));
+  if (pulp->part_touched == NULL || pulp->touched_parts == NULL ||
+      pulp->changed_parts == NULL || pulp->owned_seen == NULL ||
+      pulp->owned_parts == NULL || pulp->owned_sums == NULL ||
+      pulp->sparse_sendbuf == NULL || pulp->sparse_recvbuf == NULL ||
+      pulp->sparse_counts == NULL || pulp->size_trees == NULL)
+    throw_err("init_sparse_part_sizes(), unable to allocate resources", procid);
+
+  for (int32_t p = 0; p <= pulp->num_parts; ++p)
+    pulp->part_touched[p] = 0;
+  for (uint64_t i = 0; i < num_owned; ++i)
+    pulp->owned_seen[i] = 0;
+  pulp->num_touched = 0;
+  pulp->num_changed = 0;
+  build_part_size_trees(g, pulp);
+
+  if (debug) printf("Task %d init_sparse_part_sizes() success\n", procid); 
+}
+
+// Max trees over each weight's part sizes, leaves at [num_parts, 
+// 2*num_parts) and the largest part at the root, so the largest part stays
+// known while only changed parts are visited
+void build_part_size_trees(dist_graph_t* g, pulp_data_t* pulp)
+{
+  for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+  {
+    int64_t* tree = pulp->size_trees + 2*w*pulp->num_parts;
+    for (int32_t p = 0; p < pulp->num_parts; ++p)
+      tree[pulp->num_parts + p] = pulp->part_sizes[w][p];
+    for (int32_t i = pulp->num_parts - 1; i > 0; --i)
+      tree[i] = tree[2*i] > tree[2*i+1] ? tree[2*i] : tree[2*i+1];
+  }
+}
+
+void update_part_size_tree(pulp_data_t* pulp, uint64_t w, int32_t part)
+{
+  int64_t* tree = pulp->size_trees + 2*w*pulp->num_parts;
+  int32_t i = pulp->num_parts + part;
+  tree[i] = pulp->part_sizes[w][part];
+  for (i /= 2; i > 0; i /= 2)
+    tree[i] = tree[2*i] > tree[2*i+1] ? tree[2*i] : tree[2*i+1];
+}
+
+// Narrowest unsigned type for the neighbor part tallies of
+// max_neighbor_part(), which must hold any local degree and any part id
+void init_tally_width(dist_graph_t* g, pulp_data_t* pulp)
+{
+  uint64_t max_value = (uint64_t)pulp->num_parts;
+#pragma omp parallel for reduction(max:max_value)
+  for (uint64_t i = 0; i < g->n_local; ++i)
+    if (out_degree(g, i) > max_value)
+      max_value = out_degree(g, i);
+
+  if (max_value <= UINT16_MAX)
+    pulp->tally_bytes = sizeof(uint16_t);
+  else if (max_value <= UINT32_MAX)
+    pulp->tally_bytes = sizeof(uint32_t);
+  else
+    pulp->tally_bytes = sizeof(uint64_t);
+}
@@ -61,6 +61,9 @@ struct pulp_data_t {
   int32_t num_parts;
   int32_t* local_parts;
 
+  // bytes per neighbor part tally, see init_tally_width()
+  int32_t tally_bytes;
+
   int64_t cut_size;
   int64_t cut_size_change;
   int64_t max_cut;
@@ -77,7 +80,22 @@ struct pulp_data_t {
   double* maxes;
   int64_t** part_sizes;
   int64_t** part_size_changes;
-
+  int64_t* size_changes;
+
+  // used for pulp_w in sparse mode, see init_sparse_part_sizes()
+  bool sparse_sizes;
+  int32_t* part_touched;
+  int32_t* touched_parts;
+  uint64_t num_touched;
+  int32_t* changed_parts;
+  uint64_t num_changed;
+  int32_t* owned_seen;
+  int32_t* owned_parts;
+  int64_t* owned_sums;
+  int64_t* sparse_sendbuf;
+  int64_t* sparse_recvbuf;
+  int32_t* sparse_counts;
+  int64_t* size_trees;
 };
 
 struct thread_pulp_t {
@@ -88,8 +106,14 @@ struct thread_pulp_t {
 
   // used for pulp_w
   double** part_weights;
+
+  bool pooled;
 };
 
+void init_thread_pulp_pool(int32_t num_parts, uint64_t num_vert_weights);
+
+void clear_thread_pulp_pool();
+
 void init_thread_pulp(thread_pulp_t* tp, pulp_data_t* pulp);
 
 void init_thread_pulp(thread_pulp_t* tp, pulp_data_t* pulp, 
@@ -108,4 +132,63 @@ void update_pulp_data_weighted(dist_graph_t* g, pulp_data_t* pulp);
 
 void clear_pulp_data(pulp_data_t* pulp);
 
+void init_tally_width(dist_graph_t* g, pulp_data_t* pulp);
+
+void init_sparse_part_sizes(dist_graph_t* g, pulp_data_t* pulp);
+
+void build_part_size_trees(dist_graph_t* g, pulp_data_t* pulp);
+
+void update_part_size_tree(pulp_data_t* pulp, uint64_t w, int32_t part);
+
+inline void touch_part(pulp_data_t* pulp, int32_t part);
+inline uint64_t num_touched_parts(pulp_data_t* pulp);
+inline int32_t touched_part(pulp_data_t* pulp, uint64_t i);
+inline uint64_t num_changed_parts(pulp_data_t* pulp);
+inline int32_t changed_part(pulp_data_t* pulp, uint64_t i);
+inline int64_t max_part_size(pulp_data_t* pulp, uint64_t w);
+
+
+// Records a part whose size this task changed in the current iteration
+inline void touch_part(pulp_data_t* pulp, int32_t part)
+{
+  int32_t touched;
+#pragma omp atomic capture
+  { touched = pulp->part_touched[part]; pulp->part_touched[part] = 1; }
+
+  if (!touched)
+  {
+    uint64_t index;
+#pragma omp atomic capture
+    index = pulp->num_touched++;
+    pulp->touched_parts[index] = part;
+  }
+}
+
+// Parts this task changed since the last reduction, all parts when dense
+inline uint64_t num_touched_parts(pulp_data_t* pulp)
+{
+  return pulp->sparse_sizes ? pulp->num_touched : (uint64_t)pulp->num_parts;
+}
+
+inline int32_t touched_part(pulp_data_t* pulp, uint64_t i)
+{
+  return pulp->sparse_sizes ? pulp->touched_parts[i] : (int32_t)i;
+}
+
+// Parts any task changed in the last reduction, all parts when dense
+inline uint64_t num_changed_parts(pulp_data_t* pulp)
+{
+  return pulp->sparse_sizes ? pulp->num_changed : (uint64_t)pulp->num_parts;
+}
+
+inline int32_t changed_part(pulp_data_t* pulp, uint64_t i)
+{
+  return pulp->sparse_sizes ? pulp->changed_parts[i] : (int32_t)i;
+}
+
+inline int64_t max_part_size(pulp_data_t* pulp, uint64_t w)
+{
+  return pulp->size_trees[2*w*pulp->num_parts + 1];
+}
+
 #endif
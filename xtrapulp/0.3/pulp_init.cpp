@@ -73,8 +73,8 @@ void pulp_init_rand(
   }
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
 #pragma omp parallel
   {
@@ -96,10 +96,11 @@ void pulp_init_rand(
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < g->n_local; ++i)
-      update_sendcounts_thread(g, &tc, i);
+      update_sendcounts_thread(g, &tc, comm, i);
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -128,8 +129,8 @@ void pulp_init_rand(
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -158,8 +159,8 @@ void pulp_init_block(
   }
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   uint64_t num_per_part = g->n / (uint64_t)pulp->num_parts + 1;
 
@@ -185,10 +186,11 @@ void pulp_init_block(
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < g->n_local; ++i)
-      update_sendcounts_thread(g, &tc, i);
+      update_sendcounts_thread(g, &tc, comm, i);
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -217,8 +219,8 @@ void pulp_init_block(
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -290,8 +292,6 @@ void pulp_init_bfs_pull(
   free(roots);
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts[i] = 0;
 
   comm->global_queue_size = 1;
   uint64_t temp_send_size = 0;
@@ -312,7 +312,7 @@ void pulp_init_bfs_pull(
           continue;
 
         uint64_t out_degree = out_degree(g, vert_index);
-        uint64_t *outs = out_vertices(g, vert_index);
+        lid_t *outs = out_vertices(g, vert_index);
         for (uint64_t j = 0; j < out_degree; ++j)
         {
           uint64_t out_index = outs[j];
@@ -335,18 +335,19 @@ void pulp_init_bfs_pull(
       empty_queue(&tq, q);
 #pragma omp barrier
 
-      for (int32_t i = 0; i < nprocs; ++i)
-        tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
       for (uint64_t i = 0; i < q->send_size; ++i)
       {
         uint64_t vert_index = q->queue_send[i];
-        update_sendcounts_thread(g, &tc, vert_index);
+        update_sendcounts_thread(g, &tc, comm, vert_index);
       }
 
-      for (int32_t i = 0; i < nprocs; ++i)
+      for (int32_t n = 0; n < comm->num_dests; ++n)
       {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
         comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -379,8 +380,8 @@ void pulp_init_bfs_pull(
 #pragma omp for
       for (uint64_t i = 0; i < comm->total_recv; ++i)
       {
-        uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-        pulp->local_parts[index] = comm->recvbuf_data[i];
+        uint64_t index = g->n_local + recv_vert(comm, i);
+        pulp->local_parts[index] = recv_data(comm, i);
       }
 
 #pragma omp single
@@ -414,18 +415,19 @@ void pulp_init_bfs_pull(
     empty_queue(&tq, q);
 #pragma omp barrier
 
-    for (int32_t i = 0; i < nprocs; ++i)
-      tc.sendcounts_thread[i] = 0;
+    for (int32_t n = 0; n < comm->num_dests; ++n)
+      tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < q->send_size; ++i)
     {
       uint64_t vert_index = q->queue_send[i];
-      update_sendcounts_thread(g, &tc, vert_index);
+      update_sendcounts_thread(g, &tc, comm, vert_index);
     }
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -457,8 +459,8 @@ void pulp_init_bfs_pull(
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -502,8 +504,15 @@ void pulp_init_bfs_max(
     counts[i] = 0;
   }
 
+  q->send_size = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
+
 #pragma omp parallel
   {
+    thread_comm_t tc;
+    init_thread_comm(&tc);
+
 #pragma omp for
     for (uint64_t i = 0; i < g->n_local; ++i)
     {
@@ -519,6 +528,57 @@ void pulp_init_bfs_max(
         pulp->local_parts[i] = -1;
       }
     }
+
+#pragma omp for
+    for (uint64_t i = g->n_local; i < g->n_total; ++i)
+      pulp->local_parts[i] = -1;
+
+    // Ghosts need the seeded parts before the bfs can grow from them
+#pragma omp for schedule(guided) nowait
+    for (uint64_t i = 0; i < g->n_local; ++i)
+      update_sendcounts_thread(g, &tc, comm, i);
+
+    for (int32_t n = 0; n < comm->num_dests; ++n)
+    {
+      int32_t i = comm->dests[n];
+#pragma omp atomic
+      comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
+
+      tc.sendcounts_thread[i] = 0;
+    }
+
+#pragma omp barrier
+
+#pragma omp single
+    {
+      init_sendbuf_vid_data(comm);
+    }
+
+#pragma omp for schedule(guided) nowait
+    for (uint64_t i = 0; i < g->n_local; ++i)
+      update_vid_data_queues(g, &tc, comm, i, pulp->local_parts[i]);
+
+    empty_vid_data(&tc, comm);
+#pragma omp barrier
+
+#pragma omp single
+    {
+      exchange_vert_data(g, comm, q);
+    } // end single
+
+#pragma omp for
+    for (uint64_t i = 0; i < comm->total_recv; ++i)
+    {
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
+    }
+
+#pragma omp single
+    {
+      clear_recvbuf_vid_data(comm);
+    }
+
+    clear_thread_comm(&tc);
   }
   if (debug)
   {
@@ -530,8 +590,8 @@ void pulp_init_bfs_max(
   }
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   comm->global_queue_size = 1;
   uint64_t temp_send_size = 0;
@@ -553,7 +613,7 @@ void pulp_init_bfs_max(
 
         int32_t new_part = -1;
         uint64_t out_degree = out_degree(g, vert_index);
-        uint64_t *outs = out_vertices(g, vert_index);
+        lid_t *outs = out_vertices(g, vert_index);
         for (uint64_t j = 0; j < out_degree; ++j)
         {
           uint64_t out_index = outs[j];
@@ -580,18 +640,19 @@ void pulp_init_bfs_max(
       empty_queue(&tq, q);
 #pragma omp barrier
 
-      for (int32_t i = 0; i < nprocs; ++i)
-        tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
       for (uint64_t i = 0; i < q->send_size; ++i)
       {
         uint64_t vert_index = q->queue_send[i];
-        update_sendcounts_thread(g, &tc, vert_index);
+        update_sendcounts_thread(g, &tc, comm, vert_index);
       }
 
-      for (int32_t i = 0; i < nprocs; ++i)
+      for (int32_t n = 0; n < comm->num_dests; ++n)
       {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
         comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -624,8 +685,8 @@ void pulp_init_bfs_max(
 #pragma omp for
       for (uint64_t i = 0; i < comm->total_recv; ++i)
       {
-        uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-        pulp->local_parts[index] = comm->recvbuf_data[i];
+        uint64_t index = g->n_local + recv_vert(comm, i);
+        pulp->local_parts[index] = recv_data(comm, i);
       }
 
 #pragma omp single
@@ -667,18 +728,19 @@ void pulp_init_bfs_max(
     empty_queue(&tq, q);
 #pragma omp barrier
 
-    for (int32_t i = 0; i < nprocs; ++i)
-      tc.sendcounts_thread[i] = 0;
+    for (int32_t n = 0; n < comm->num_dests; ++n)
+      tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < q->send_size; ++i)
     {
       uint64_t vert_index = q->queue_send[i];
-      update_sendcounts_thread(g, &tc, vert_index);
+      update_sendcounts_thread(g, &tc, comm, vert_index);
     }
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -710,8 +772,8 @@ void pulp_init_bfs_max(
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -747,8 +809,8 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
   uint64_t not_initialized = 0;
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   double min_size = pulp->avg_sizes[0] * MIN_SIZE;
   double multiplier = (double)nprocs;
@@ -808,10 +870,11 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < g->n_local; ++i)
-      update_sendcounts_thread(g, &tc, i);
+      update_sendcounts_thread(g, &tc, comm, i);
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -840,8 +903,8 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -865,7 +928,7 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
           tp.part_counts[p] = 0.0;
 
         uint64_t out_degree = out_degree(g, vert_index);
-        uint64_t *outs = out_vertices(g, vert_index);
+        lid_t *outs = out_vertices(g, vert_index);
         int32_t *weights = out_weights(g, vert_index);
         for (uint64_t j = 0; j < out_degree; ++j)
         {
@@ -969,18 +1032,19 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
       empty_send(&tq, q);
 #pragma omp barrier
 
-      for (int32_t i = 0; i < nprocs; ++i)
-        tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
       for (uint64_t i = 0; i < q->send_size; ++i)
       {
         uint64_t vert_index = q->queue_send[i];
-        update_sendcounts_thread(g, &tc, vert_index);
+        update_sendcounts_thread(g, &tc, comm, vert_index);
       }
 
-      for (int32_t i = 0; i < nprocs; ++i)
+      for (int32_t n = 0; n < comm->num_dests; ++n)
       {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
         comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -1012,8 +1076,8 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
 #pragma omp for
       for (uint64_t i = 0; i < comm->total_recv; ++i)
       {
-        uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-        pulp->local_parts[index] = comm->recvbuf_data[i];
+        uint64_t index = g->n_local + recv_vert(comm, i);
+        pulp->local_parts[index] = recv_data(comm, i);
       }
 
 #pragma omp single
@@ -1048,18 +1112,19 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
     empty_queue(&tq, q);
 #pragma omp barrier
 
-    for (int32_t i = 0; i < nprocs; ++i)
-      tc.sendcounts_thread[i] = 0;
+    for (int32_t n = 0; n < comm->num_dests; ++n)
+      tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < q->send_size; ++i)
     {
       uint64_t vert_index = q->queue_send[i];
-      update_sendcounts_thread(g, &tc, vert_index);
+      update_sendcounts_thread(g, &tc, comm, vert_index);
     }
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -1091,8 +1156,8 @@ void pulp_init_label_prop_weighted(dist_graph_t *g,
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -1122,8 +1187,8 @@ void pulp_init_label_prop(dist_graph_t *g,
   }
 
   q->send_size = 0;
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   double min_size = pulp->avg_sizes[0] * MIN_SIZE;
   double multiplier = (double)nprocs;
@@ -1151,10 +1216,11 @@ void pulp_init_label_prop(dist_graph_t *g,
 
 #pragma omp for schedule(guided) nowait
     for (uint64_t i = 0; i < g->n_local; ++i)
-      update_sendcounts_thread(g, &tc, i);
+      update_sendcounts_thread(g, &tc, comm, i);
 
-    for (int32_t i = 0; i < nprocs; ++i)
+    for (int32_t n = 0; n < comm->num_dests; ++n)
     {
+      int32_t i = comm->dests[n];
 #pragma omp atomic
       comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -1183,8 +1249,8 @@ void pulp_init_label_prop(dist_graph_t *g,
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -1201,39 +1267,10 @@ void pulp_init_label_prop(dist_graph_t *g,
       {
         int32_t part = pulp->local_parts[vert_index];
 
-        for (int32_t p = 0; p < pulp->num_parts; ++p)
-          tp.part_counts[p] = 0.0;
-
-        uint64_t out_degree = out_degree(g, vert_index);
-        uint64_t *outs = out_vertices(g, vert_index);
-        for (uint64_t j = 0; j < out_degree; ++j)
-        {
-          uint64_t out_index = outs[j];
-          int32_t part_out = pulp->local_parts[out_index];
-          tp.part_counts[part_out] += 1.0;
-        }
-
-        int32_t max_part = part;
-        double max_val = -1.0;
-        uint64_t num_max = 0;
-        for (int32_t p = 0; p < pulp->num_parts; ++p)
-        {
-          if (tp.part_counts[p] == max_val)
-          {
-            tp.part_counts[num_max++] = (double)p;
-          }
-          else if (tp.part_counts[p] > max_val)
-          {
-            max_val = tp.part_counts[p];
-            max_part = p;
-            num_max = 0;
-            tp.part_counts[num_max++] = (double)p;
-          }
-        }
-
-        if (num_max > 1)
-          max_part =
-              (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
+        int64_t part_count = 0;
+        int64_t max_count = 0;
+        int32_t max_part = max_neighbor_part(g, pulp, &tp, vert_index, part,
+          &xs, &part_count, &max_count);
 
         if (max_part != part)
         {
@@ -1257,18 +1294,19 @@ void pulp_init_label_prop(dist_graph_t *g,
       empty_send(&tq, q);
 #pragma omp barrier
 
-      for (int32_t i = 0; i < nprocs; ++i)
-        tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
       for (uint64_t i = 0; i < q->send_size; ++i)
       {
         uint64_t vert_index = q->queue_send[i];
-        update_sendcounts_thread(g, &tc, vert_index);
+        update_sendcounts_thread(g, &tc, comm, vert_index);
       }
 
-      for (int32_t i = 0; i < nprocs; ++i)
+      for (int32_t n = 0; n < comm->num_dests; ++n)
       {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
         comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
@@ -1300,8 +1338,8 @@ void pulp_init_label_prop(dist_graph_t *g,
 #pragma omp for
       for (uint64_t i = 0; i < comm->total_recv; ++i)
       {
-        uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-        pulp->local_parts[index] = comm->recvbuf_data[i];
+        uint64_t index = g->n_local + recv_vert(comm, i);
+        pulp->local_parts[index] = recv_data(comm, i);
       }
 
 #pragma omp single
@@ -77,7 +77,7 @@ int part_eval(dist_graph_t* g, pulp_data_t* pulp)
     ++pulp->part_vert_sizes[part];
 
     uint64_t out_degree = out_degree(g, vert_index);
-    uint64_t* outs = out_vertices(g, vert_index);
+    lid_t* outs = out_vertices(g, vert_index);
     pulp->part_edge_sizes[part] += (int64_t)out_degree;
     for (uint64_t j = 0; j < out_degree; ++j)
     {
@@ -183,7 +183,7 @@ int part_eval(dist_graph_t* g, int32_t* parts, int32_t num_parts)
     ++pulp.part_sizes[0][part];
 
     uint64_t out_degree = out_degree(g, vert_index);
-    uint64_t* outs = out_vertices(g, vert_index);
+    lid_t* outs = out_vertices(g, vert_index);
     pulp.part_edge_sizes[part] += (int64_t)out_degree;
     for (uint64_t j = 0; j < out_degree; ++j)
     {
@@ -288,7 +288,7 @@ int part_eval_weighted(dist_graph_t* g, pulp_data_t* pulp)
           g->vert_weights[vert_index*g->num_vert_weights + w];
 
     uint64_t out_degree = out_degree(g, vert_index);
-    uint64_t* outs = out_vertices(g, vert_index);
+    lid_t* outs = out_vertices(g, vert_index);
     int32_t* weights = out_weights(g, vert_index);
     for (uint64_t j = 0; j < out_degree; ++j)
     {
@@ -49,6 +49,7 @@
 
 #include "dist_graph.h"
 #include "pulp_data.h"
+#include "util.h"
 
 int part_eval(dist_graph_t* g, pulp_data_t* pulp);
 
@@ -56,4 +57,65 @@ int part_eval(dist_graph_t* g, int32_t* parts, int32_t num_parts);
 
 int part_eval_weighted(dist_graph_t* g, pulp_data_t* pulp);
 
+// Tallies the parts of a vertex's neighbors in counts and returns the most
+// common, ties broken at random. Tallies are exact, so any count_t holding the
+// degree and the part ids picks the same part; narrower ones shrink the array
+// cleared and scanned per vertex. The max is found by a plain reduction that
+// vectorizes, then the tied parts are packed in order to the front of counts.
+template <typename count_t>
+inline int32_t max_neighbor_part(dist_graph_t* g, pulp_data_t* pulp,
+  count_t* counts, uint64_t vert_index, int32_t part, xs1024star_t* xs,
+  int64_t* part_count, int64_t* max_count)
+{
+  int32_t num_parts = pulp->num_parts;
+  int32_t* parts = pulp->local_parts;
+  for (int32_t p = 0; p < num_parts; ++p)
+    counts[p] = 0;
+
+  uint64_t out_degree = out_degree(g, vert_index);
+  lid_t* outs = out_vertices(g, vert_index);
+  for (uint64_t j = 0; j < out_degree; ++j)
+    ++counts[parts[outs[j]]];
+
+  *part_count = (int64_t)counts[part];
+  count_t max_val = 0;
+  for (int32_t p = 0; p < num_parts; ++p)
+    max_val = counts[p] > max_val ? counts[p] : max_val;
+  *max_count = (int64_t)max_val;
+
+  uint64_t num_max = 0;
+  for (int32_t p = 0; p < num_parts; ++p)
+  {
+    bool is_max = (counts[p] == max_val);
+    counts[num_max] = (count_t)p;
+    num_max += is_max;
+  }
+
+  int32_t max_part = max_val > 0 ? (int32_t)counts[0] : part;
+  if (num_max > 1)
+    max_part = (int32_t)counts[(xs1024star_next(xs) % num_max)];
+
+  return max_part;
+}
+
+// Runs the instantiation for the tally width set by init_tally_width(), in
+// the space of the thread's part_counts
+inline int32_t max_neighbor_part(dist_graph_t* g, pulp_data_t* pulp,
+  thread_pulp_t* tp, uint64_t vert_index, int32_t part, xs1024star_t* xs,
+  int64_t* part_count, int64_t* max_count)
+{
+  switch (pulp->tally_bytes)
+  {
+  case sizeof(uint16_t):
+    return max_neighbor_part(g, pulp, (uint16_t*)tp->part_counts,
+      vert_index, part, xs, part_count, max_count);
+  case sizeof(uint32_t):
+    return max_neighbor_part(g, pulp, (uint32_t*)tp->part_counts,
+      vert_index, part, xs, part_count, max_count);
+  default:
+    return max_neighbor_part(g, pulp, (uint64_t*)tp->part_counts,
+      vert_index, part, xs, part_count, max_count);
+  }
+}
+
 #endif
@@ -79,8 +79,8 @@ int pulp_v(dist_graph_t* g, mpi_data_t* comm, queue_data_t* q,
   q->next_size = 0;
   q->send_size = 0;
 
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   double tot_iter = 
     (double)(outer_iter*(refine_iter+balance_iter));
@@ -129,132 +129,150 @@ for (uint64_t cur_outer_iter = 0; cur_outer_iter < outer_iter; ++cur_outer_iter)
         tp.part_vert_weights[p] = 0.0;
     }
 
-#pragma omp for schedule(guided) reduction(+:num_swapped_1) nowait
-    for (uint64_t vert_index = 0; vert_index < g->n_local; ++vert_index)
+    for (int32_t sweep = 0; sweep < num_sweeps(comm); ++sweep)
     {
-      int32_t part = pulp->local_parts[vert_index];
-      for (int32_t p = 0; p < pulp->num_parts; ++p)
-        tp.part_counts[p] = 0.0;
-
-      uint64_t out_degree = out_degree(g, vert_index);
-      uint64_t* outs = out_vertices(g, vert_index);
-      for (uint64_t j = 0; j < out_degree; ++j)
-      {
-        uint64_t out_index = outs[j];
-        int32_t part_out = pulp->local_parts[out_index];
-        if (out_index >= g->n_local)
-        {
-          tp.part_counts[part_out] += g->ghost_degrees[out_index - g->n_local];
-        }
-        else 
-        { 
-          tp.part_counts[part_out] += out_degree(g, out_index);
-        }
-      }
-
-      int32_t max_part = part;
-      double max_val = 0.0;
-      uint64_t num_max = 0;
-      for (int32_t p = 0; p < pulp->num_parts; ++p)
+      uint64_t begin = sweep_begin(g, comm, sweep);
+      uint64_t end = sweep_end(g, comm, sweep);
+#pragma omp for schedule(guided) reduction(+:num_swapped_1) nowait
+      for (uint64_t i = begin; i < end; ++i)
       {
-        if (tp.part_vert_weights[p] > 0.0)
-          tp.part_counts[p] *= tp.part_vert_weights[p];
-        else
+        uint64_t vert_index = sweep_vert(comm, i);
+        int32_t part = pulp->local_parts[vert_index];
+        for (int32_t p = 0; p < pulp->num_parts; ++p)
           tp.part_counts[p] = 0.0;
 
-        if (tp.part_counts[p] == max_val)
+        uint64_t out_degree = out_degree(g, vert_index);
+        lid_t* outs = out_vertices(g, vert_index);
+        for (uint64_t j = 0; j < out_degree; ++j)
         {
-          tp.part_counts[num_max++] = (double)p;
+          uint64_t out_index = outs[j];
+          int32_t part_out = pulp->local_parts[out_index];
+          if (out_index >= g->n_local)
+          {
+            tp.part_counts[part_out] += g->ghost_degrees[out_index - g->n_local];
+          }
+          else 
+          { 
+            tp.part_counts[part_out] += out_degree(g, out_index);
+          }
         }
-        else if (tp.part_counts[p] > max_val)
+
+        int32_t max_part = part;
+        double max_val = 0.0;
+        uint64_t num_max = 0;
+        for (int32_t p = 0; p < pulp->num_parts; ++p)
         {
-          max_val = tp.part_counts[p];
-          max_part = p;
-          num_max = 0;
-          tp.part_counts[num_max++] = (double)p;
+          if (tp.part_vert_weights[p] > 0.0)
+            tp.part_counts[p] *= tp.part_vert_weights[p];
+          else
+            tp.part_counts[p] = 0.0;
+
+          if (tp.part_counts[p] == max_val)
+          {
+            tp.part_counts[num_max++] = (double)p;
+          }
+          else if (tp.part_counts[p] > max_val)
+          {
+            max_val = tp.part_counts[p];
+            max_part = p;
+            num_max = 0;
+            tp.part_counts[num_max++] = (double)p;
+          }
+        }      
+
+        if (num_max > 1)
+          max_part = 
+            (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
+
+        if (max_part != part)
+        {
+          ++num_swapped_1;
+      #pragma omp atomic
+          --pulp->part_vert_size_changes[part];
+      #pragma omp atomic
+          ++pulp->part_vert_size_changes[max_part];
+          
+          tp.part_vert_weights[part] = 
+            vert_balance * pulp->avg_vert_size / 
+            ((double)pulp->part_vert_sizes[part] + multiplier*(double)pulp->part_vert_size_changes[part]) - 1.0;
+          tp.part_vert_weights[max_part] = 
+            vert_balance * pulp->avg_vert_size / 
+            ((double)pulp->part_vert_sizes[max_part] + multiplier*(double)pulp->part_vert_size_changes[max_part]) - 1.0;
+          
+          if (tp.part_vert_weights[part] < 0.0)
+            tp.part_vert_weights[part] = 0.0;
+          if (tp.part_vert_weights[max_part] < 0.0)
+            tp.part_vert_weights[max_part] = 0.0;
+
+          pulp->local_parts[vert_index] = max_part;
+          if (sweep == 0)
+            add_vid_to_send(&tq, q, vert_index);
+          //add_vid_to_queue(&tq, q, vert_index);
         }
-      }      
+      }  
 
-      if (num_max > 1)
-        max_part = 
-          (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
+      // Only boundary vertices have updates to send, the interior sweep
+      // runs while they are in flight
+      if (sweep > 0)
+        continue;
 
-      if (max_part != part)
-      {
-        ++num_swapped_1;
-    #pragma omp atomic
-        --pulp->part_vert_size_changes[part];
-    #pragma omp atomic
-        ++pulp->part_vert_size_changes[max_part];
-        
-        tp.part_vert_weights[part] = 
-          vert_balance * pulp->avg_vert_size / 
-          ((double)pulp->part_vert_sizes[part] + multiplier*(double)pulp->part_vert_size_changes[part]) - 1.0;
-        tp.part_vert_weights[max_part] = 
-          vert_balance * pulp->avg_vert_size / 
-          ((double)pulp->part_vert_sizes[max_part] + multiplier*(double)pulp->part_vert_size_changes[max_part]) - 1.0;
-        
-        if (tp.part_vert_weights[part] < 0.0)
-          tp.part_vert_weights[part] = 0.0;
-        if (tp.part_vert_weights[max_part] < 0.0)
-          tp.part_vert_weights[max_part] = 0.0;
-
-        pulp->local_parts[vert_index] = max_part;
-        add_vid_to_send(&tq, q, vert_index);
-        //add_vid_to_queue(&tq, q, vert_index);
-      }
-    }  
-
-    empty_send(&tq, q);
-    //empty_queue(&tq, q);
+      empty_send(&tq, q);
+      //empty_queue(&tq, q);
 #pragma omp barrier
 
-    for (int32_t i = 0; i < nprocs; ++i)
-      tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
-    for (uint64_t i = 0; i < q->send_size; ++i)
-    {
-      uint64_t vert_index = q->queue_send[i];
-      update_sendcounts_thread(g, &tc, vert_index);
-    }
+      for (uint64_t i = 0; i < q->send_size; ++i)
+      {
+        uint64_t vert_index = q->queue_send[i];
+        update_sendcounts_thread(g, &tc, comm, vert_index);
+      }
 
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+      {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
-      comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
+        comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
-      tc.sendcounts_thread[i] = 0;
-    }
+        tc.sendcounts_thread[i] = 0;
+      }
 #pragma omp barrier
 
 #pragma omp single
 {
-    init_sendbuf_vid_data(comm);    
+      init_sendbuf_vid_data(comm);    
 }
 
 #pragma omp for schedule(guided) nowait
-    for (uint64_t i = 0; i < q->send_size; ++i)
-    {
-      uint64_t vert_index = q->queue_send[i];
-      update_vid_data_queues(g, &tc, comm,
-                             vert_index, pulp->local_parts[vert_index]);
-    }
+      for (uint64_t i = 0; i < q->send_size; ++i)
+      {
+        uint64_t vert_index = q->queue_send[i];
+        update_vid_data_queues(g, &tc, comm,
+                               vert_index, pulp->local_parts[vert_index]);
+      }
 
-    empty_vid_data(&tc, comm);
+      empty_vid_data(&tc, comm);
 #pragma omp barrier
 
 #pragma omp single
 {
-    exchange_vert_data(g, comm, q);
+      exchange_vert_data_begin(g, comm, q);
+} // end single
+    }
+
+#pragma omp single
+{
+    exchange_vert_data_end(g, comm, q);
 } // end single
 
 
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
@@ -297,116 +315,105 @@ for (uint64_t cur_outer_iter = 0; cur_outer_iter < outer_iter; ++cur_outer_iter)
   for (uint64_t cur_ref_iter = 0; cur_ref_iter < refine_iter; ++cur_ref_iter)
   {
 
-#pragma omp for schedule(guided) reduction(+:num_swapped_2) nowait
-    for (uint64_t vert_index = 0; vert_index < g->n_local; ++vert_index)
+    for (int32_t sweep = 0; sweep < num_sweeps(comm); ++sweep)
     {
-      int32_t part = pulp->local_parts[vert_index];
-      for (int32_t p = 0; p < pulp->num_parts; ++p)
-        tp.part_counts[p] = 0.0;
-
-      uint64_t out_degree = out_degree(g, vert_index);
-      uint64_t* outs = out_vertices(g, vert_index);
-      for (uint64_t j = 0; j < out_degree; ++j)
-      {
-        uint64_t out_index = outs[j];
-        int32_t part_out = pulp->local_parts[out_index];
-        tp.part_counts[part_out] += 1.0;
-      }
-      
-      int32_t max_part = part;
-      double max_val = 0.0;
-      uint64_t num_max = 0;
-      for (int32_t p = 0; p < pulp->num_parts; ++p)
+      uint64_t begin = sweep_begin(g, comm, sweep);
+      uint64_t end = sweep_end(g, comm, sweep);
+#pragma omp for schedule(guided) reduction(+:num_swapped_2) nowait
+      for (uint64_t i = begin; i < end; ++i)
       {
-        if (tp.part_counts[p] == max_val)
-        {
-          tp.part_counts[num_max++] = (double)p;
-        }
-        else if (tp.part_counts[p] > max_val)
+        uint64_t vert_index = sweep_vert(comm, i);
+        int32_t part = pulp->local_parts[vert_index];
+        int64_t part_count = 0;
+        int64_t max_count = 0;
+        int32_t max_part = max_neighbor_part(g, pulp, &tp, vert_index, part,
+          &xs, &part_count, &max_count);
+        if (max_part != part)
         {
-          max_val = tp.part_counts[p];
-          max_part = p;
-          num_max = 0;
-          tp.part_counts[num_max++] = (double)p;
+          int64_t new_size = (int64_t)pulp->avg_vert_size;
+
+          pulp->part_vert_size_changes[max_part] + 1 < 0 ? 
+            new_size = pulp->part_vert_sizes[max_part] + pulp->part_vert_size_changes[max_part] + 1 :
+            new_size = (int64_t)((double)pulp->part_vert_sizes[max_part] + multiplier*(double)pulp->part_vert_size_changes[max_part] + 1.0);
+
+          if (new_size < (int64_t)(pulp->avg_vert_size*vert_balance))
+          {
+            ++num_swapped_2;
+        #pragma omp atomic
+            --pulp->part_vert_size_changes[part];
+        #pragma omp atomic
+            ++pulp->part_vert_size_changes[max_part];
+
+            pulp->local_parts[vert_index] = max_part;
+            if (sweep == 0)
+              add_vid_to_send(&tq, q, vert_index);
+            //add_vid_to_queue(&tq, q, vert_index);
+          }
         }
-      }      
-
-      if (num_max > 1)
-        max_part = 
-          (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
-      if (max_part != part)
-      {
-        int64_t new_size = (int64_t)pulp->avg_vert_size;
+      }  
 
-        pulp->part_vert_size_changes[max_part] + 1 < 0 ? 
-          new_size = pulp->part_vert_sizes[max_part] + pulp->part_vert_size_changes[max_part] + 1 :
-          new_size = (int64_t)((double)pulp->part_vert_sizes[max_part] + multiplier*(double)pulp->part_vert_size_changes[max_part] + 1.0);
-
-        if (new_size < (int64_t)(pulp->avg_vert_size*vert_balance))
-        {
-          ++num_swapped_2;
-      #pragma omp atomic
-          --pulp->part_vert_size_changes[part];
-      #pragma omp atomic
-          ++pulp->part_vert_size_changes[max_part];
-
-          pulp->local_parts[vert_index] = max_part;
-          add_vid_to_send(&tq, q, vert_index);
-          //add_vid_to_queue(&tq, q, vert_index);
-        }
-      }
-    }  
+      // Only boundary vertices have updates to send, the interior sweep
+      // runs while they are in flight
+      if (sweep > 0)
+        continue;
 
-    empty_send(&tq, q);
-    //empty_queue(&tq, q);
+      empty_send(&tq, q);
+      //empty_queue(&tq, q);
 #pragma omp barrier
 
-    for (int32_t i = 0; i < nprocs; ++i)
-      tc.sendcounts_thread[i] = 0;
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+        tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
-    for (uint64_t i = 0; i < q->send_size; ++i)
-    {
-      uint64_t vert_index = q->queue_send[i];
-      update_sendcounts_thread(g, &tc, vert_index);
-    }
+      for (uint64_t i = 0; i < q->send_size; ++i)
+      {
+        uint64_t vert_index = q->queue_send[i];
+        update_sendcounts_thread(g, &tc, comm, vert_index);
+      }
 
-    for (int32_t i = 0; i < nprocs; ++i)
-    {
+      for (int32_t n = 0; n < comm->num_dests; ++n)
+      {
+        int32_t i = comm->dests[n];
 #pragma omp atomic
-      comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
+        comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
-      tc.sendcounts_thread[i] = 0;
-    }
+        tc.sendcounts_thread[i] = 0;
+      }
 #pragma omp barrier
 
 #pragma omp single
 {
-    init_sendbuf_vid_data(comm);    
+      init_sendbuf_vid_data(comm);    
 }
 
 #pragma omp for schedule(guided) nowait
-    for (uint64_t i = 0; i < q->send_size; ++i)
-    {
-      uint64_t vert_index = q->queue_send[i];
-      update_vid_data_queues(g, &tc, comm,
-                             vert_index, pulp->local_parts[vert_index]);
-    }
+      for (uint64_t i = 0; i < q->send_size; ++i)
+      {
+        uint64_t vert_index = q->queue_send[i];
+        update_vid_data_queues(g, &tc, comm,
+                               vert_index, pulp->local_parts[vert_index]);
+      }
 
-    empty_vid_data(&tc, comm);
+      empty_vid_data(&tc, comm);
 #pragma omp barrier
 
 #pragma omp single
 {
-    exchange_vert_data(g, comm, q);
+      exchange_vert_data_begin(g, comm, q);
+} // end single
+    }
+
+#pragma omp single
+{
+    exchange_vert_data_end(g, comm, q);
 } // end single
 
 
 #pragma omp for
     for (uint64_t i = 0; i < comm->total_recv; ++i)
     {
-      uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-      pulp->local_parts[index] = comm->recvbuf_data[i];
+      uint64_t index = g->n_local + recv_vert(comm, i);
+      pulp->local_parts[index] = recv_data(comm, i);
     }
 
 #pragma omp single
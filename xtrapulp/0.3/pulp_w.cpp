@@ -71,6 +71,189 @@ extern float X, Y;
 extern int64_t batch_size;
 extern int64_t train_wid;
 
+// Starts the sum of this iteration's part size deltas, along with the cut
+// deltas when balancing the max cut, as one nonblocking reduction over the
+// contiguous size_changes block
+void begin_size_change_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request)
+{
+  if (pulp->sparse_sizes)
+  {
+    begin_sparse_size_reduction(g, pulp, with_cut, request);
+    return;
+  }
+
+  uint64_t num_changes = g->num_vert_weights*pulp->num_parts;
+  int64_t* changes = pulp->size_changes + pulp->num_parts;
+  if (with_cut)
+  {
+    changes = pulp->size_changes;
+    num_changes += pulp->num_parts;
+    changes[num_changes++] = pulp->cut_size_change;
+  }
+
+  MPI_Iallreduce(MPI_IN_PLACE, changes, (int)num_changes,
+                 MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD, request);
+}
+
+void end_size_change_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request)
+{
+  if (pulp->sparse_sizes)
+  {
+    end_sparse_size_reduction(g, pulp, with_cut, request);
+    return;
+  }
+
+  MPI_Wait(request, MPI_STATUS_IGNORE);
+
+  if (with_cut)
+    pulp->cut_size_change = 
+      pulp->size_changes[(g->num_vert_weights+1)*pulp->num_parts];
+}
+
+// Sends the deltas of each touched part to the task owning it, see
+// init_sparse_part_sizes()
+void begin_sparse_size_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request)
+{
+  int32_t record_size = (int32_t)g->num_vert_weights + 2;
+  int32_t* sendcounts = pulp->sparse_counts;
+  int32_t* sdispls = sendcounts + nprocs;
+  int32_t* recvcounts = sdispls + nprocs;
+  int32_t* rdispls = recvcounts + nprocs;
+
+  // The cut total rides along as the pseudo part num_parts
+  uint64_t num_send = pulp->num_touched;
+  if (with_cut)
+    pulp->touched_parts[num_send++] = pulp->num_parts;
+
+  for (int32_t i = 0; i < nprocs; ++i)
+    sendcounts[i] = 0;
+  for (uint64_t i = 0; i < num_send; ++i)
+    ++sendcounts[pulp->touched_parts[i] % nprocs];
+
+  sdispls[0] = 0;
+  for (int32_t i = 1; i < nprocs; ++i)
+    sdispls[i] = sdispls[i-1] + sendcounts[i-1];
+  for (int32_t i = 0; i < nprocs; ++i)
+    rdispls[i] = sdispls[i];
+
+  for (uint64_t i = 0; i < num_send; ++i)
+  {
+    int32_t p = pulp->touched_parts[i];
+    int64_t* record = 
+      pulp->sparse_sendbuf + (uint64_t)(rdispls[p % nprocs]++)*record_size;
+    record[0] = p;
+    if (p == pulp->num_parts)
+    {
+      record[1] = pulp->cut_size_change;
+      for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+        record[w+2] = 0;
+    }
+    else
+    {
+      record[1] = pulp->part_cut_size_changes[p];
+      for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+        record[w+2] = pulp->part_size_changes[w][p];
+    }
+  }
+
+  MPI_Alltoall(sendcounts, 1, MPI_INT32_T, 
+               recvcounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
+
+  rdispls[0] = 0;
+  for (int32_t i = 1; i < nprocs; ++i)
+    rdispls[i] = rdispls[i-1] + recvcounts[i-1];
+  for (int32_t i = 0; i < nprocs; ++i)
+  {
+    sendcounts[i] *= record_size;
+    sdispls[i] *= record_size;
+    recvcounts[i] *= record_size;
+    rdispls[i] *= record_size;
+  }
+
+  MPI_Ialltoallv(pulp->sparse_sendbuf, sendcounts, sdispls, MPI_INT64_T,
+                 pulp->sparse_recvbuf, recvcounts, rdispls, MPI_INT64_T,
+                 MPI_COMM_WORLD, request);
+}
+
+// Sums the records for owned parts, gathers the sums on every task, and
+// writes them over the local deltas of each changed part
+void end_sparse_size_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request)
+{
+  int32_t record_size = (int32_t)g->num_vert_weights + 2;
+  int32_t* recvcounts = pulp->sparse_counts + 2*nprocs;
+  int32_t* rdispls = recvcounts + nprocs;
+  int32_t* gathercounts = rdispls + nprocs;
+  int32_t* gatherdispls = gathercounts + nprocs;
+
+  MPI_Wait(request, MPI_STATUS_IGNORE);
+
+  uint64_t num_recv = 
+    (uint64_t)(rdispls[nprocs-1] + recvcounts[nprocs-1]) / record_size;
+  uint64_t num_owned = 0;
+  for (uint64_t i = 0; i < num_recv; ++i)
+  {
+    int64_t* record = pulp->sparse_recvbuf + i*record_size;
+    uint64_t index = (uint64_t)record[0] / nprocs;
+    int64_t* sums = pulp->owned_sums + index*(record_size-1);
+    if (!pulp->owned_seen[index])
+    {
+      pulp->owned_seen[index] = 1;
+      pulp->owned_parts[num_owned++] = (int32_t)record[0];
+      for (int32_t j = 0; j < record_size-1; ++j)
+        sums[j] = 0;
+    }
+    for (int32_t j = 0; j < record_size-1; ++j)
+      sums[j] += record[j+1];
+  }
+
+  for (uint64_t i = 0; i < num_owned; ++i)
+  {
+    uint64_t index = (uint64_t)pulp->owned_parts[i] / nprocs;
+    int64_t* record = pulp->sparse_sendbuf + i*record_size;
+    record[0] = pulp->owned_parts[i];
+    for (int32_t j = 0; j < record_size-1; ++j)
+      record[j+1] = pulp->owned_sums[index*(record_size-1) + j];
+    pulp->owned_seen[index] = 0;
+  }
+
+  int32_t send_size = (int32_t)num_owned*record_size;
+  MPI_Allgather(&send_size, 1, MPI_INT32_T, 
+                gathercounts, 1, MPI_INT32_T, MPI_COMM_WORLD);
+  gatherdispls[0] = 0;
+  for (int32_t i = 1; i < nprocs; ++i)
+    gatherdispls[i] = gatherdispls[i-1] + gathercounts[i-1];
+  MPI_Allgatherv(pulp->sparse_sendbuf, send_size, MPI_INT64_T,
+                 pulp->sparse_recvbuf, gathercounts, gatherdispls, MPI_INT64_T,
+                 MPI_COMM_WORLD);
+
+  for (uint64_t i = 0; i < pulp->num_touched; ++i)
+    pulp->part_touched[pulp->touched_parts[i]] = 0;
+  pulp->num_touched = 0;
+
+  uint64_t num_gathered = 
+    (uint64_t)(gatherdispls[nprocs-1] + gathercounts[nprocs-1]) / record_size;
+  pulp->num_changed = 0;
+  for (uint64_t i = 0; i < num_gathered; ++i)
+  {
+    int64_t* record = pulp->sparse_recvbuf + i*record_size;
+    int32_t p = (int32_t)record[0];
+    if (p == pulp->num_parts)
+    {
+      pulp->cut_size_change = record[1];
+      continue;
+    }
+
+    pulp->changed_parts[pulp->num_changed++] = p;
+    pulp->part_cut_size_changes[p] = record[1];
+    for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+      pulp->part_size_changes[w][p] = record[w+2];
+  }
+}
+
 int pulp_w(
     dist_graph_t *g, mpi_data_t *comm, queue_data_t *q, pulp_data_t *pulp,
     uint64_t outer_iter, uint64_t balance_iter, uint64_t refine_iter,
@@ -92,8 +275,8 @@ int pulp_w(
   q->send_size = 0;
   double max_imbalance = 0.0;
 
-  for (int32_t i = 0; i < nprocs; ++i)
-    comm->sendcounts_temp[i] = 0;
+  for (int32_t n = 0; n < comm->num_dests; ++n)
+    comm->sendcounts_temp[comm->dests[n]] = 0;
 
   update_pulp_data_weighted(g, pulp);
   int64_t train_num_max, train_num_min;
@@ -131,6 +314,8 @@ int pulp_w(
   uint64_t num_swapped_1 = 0;
   uint64_t num_swapped_2 = 0;
   comm->global_queue_size = 1;
+  MPI_Request size_request;
+  bool max_c_changed = false;
 
 #pragma omp parallel default(shared)
   {
@@ -158,9 +343,17 @@ int pulp_w(
       for (uint64_t cur_bal_iter = 0; cur_bal_iter < balance_iter; ++cur_bal_iter)
       {
 
-        for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+        // In sparse mode only the parts changed by the last reduction need
+        // new weights, unless max_c moved
+        bool refresh_all = 
+          (cur_bal_iter == 0 || !pulp->sparse_sizes || max_c_changed);
+        uint64_t num_refresh = 
+          refresh_all ? (uint64_t)pulp->num_parts : num_changed_parts(pulp);
+
+        for (uint64_t i = 0; i < num_refresh; ++i)
         {
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
+          int32_t p = refresh_all ? (int32_t)i : changed_part(pulp, i);
+          for (uint64_t w = 0; w < g->num_vert_weights; ++w)
           {
             tp.part_weights[w][p] =
                 constraints[w] * pulp->avg_sizes[w] /
@@ -172,292 +365,318 @@ int pulp_w(
         if (do_maxcut_balance)
         {
           pulp->avg_cut_size = (double)pulp->cut_size / (double)pulp->num_parts;
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
+          for (uint64_t i = 0; i < num_refresh; ++i)
           {
+            int32_t p = refresh_all ? (int32_t)i : changed_part(pulp, i);
             if ((double)pulp->part_cut_sizes[p] / pulp->avg_cut_size > pulp->max_c)
               pulp->max_c = (double)pulp->part_cut_sizes[p] / pulp->avg_cut_size;
             tp.part_cut_weights[p] = pulp->max_c * pulp->avg_cut_size / (double)pulp->part_cut_sizes[p] - 1.0;
           }
         }
 
-#pragma omp for schedule(guided) reduction(+ : num_swapped_1) nowait
-        for (uint64_t vert_index = 0; vert_index < g->n_local; ++vert_index)
+        for (int32_t sweep = 0; sweep < num_sweeps(comm); ++sweep)
         {
+          uint64_t begin = sweep_begin(g, comm, sweep);
+          uint64_t end = sweep_end(g, comm, sweep);
+#pragma omp for schedule(guided) reduction(+ : num_swapped_1) nowait
+          for (uint64_t i = begin; i < end; ++i)
+          {
+            uint64_t vert_index = sweep_vert(comm, i);
 
-          int32_t part = pulp->local_parts[vert_index];
-
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
-            tp.part_counts[p] = 0.0;
-          tp.part_counts[part] = 1.0;
+            int32_t part = pulp->local_parts[vert_index];
 
-          uint64_t out_degree = out_degree(g, vert_index);
-          uint64_t *outs = out_vertices(g, vert_index);
-          int32_t *weights = out_weights(g, vert_index);
-          for (uint64_t j = 0; j < out_degree; ++j)
-          {
-            uint64_t out_index = outs[j];
-            int32_t part_out = pulp->local_parts[out_index];
-            double weight_out = (double)weights[j];
-            tp.part_counts[part_out] += weight_out;
-          }
+            for (int32_t p = 0; p < pulp->num_parts; ++p)
+              tp.part_counts[p] = 0.0;
+            tp.part_counts[part] = 1.0;
 
-          int32_t max_part = part;
-          for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-          {
-            double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
-            double vert_weight =
-                (double)g->vert_weights[vert_index * g->num_vert_weights + w] /
-                (double)g->max_vert_weights[w];
-            double est_part_size =
-                (double)pulp->part_sizes[w][part] - vert_weight + (multiplier * (double)pulp->part_size_changes[w][part] * avg_weight);
-            if (est_part_size < 0.0)
-              est_part_size = 0.1;
-            tp.part_weights[w][part] =
-                (constraints[w] * pulp->avg_sizes[w]) / est_part_size - 1.0;
-          }
+            uint64_t out_degree = out_degree(g, vert_index);
+            lid_t *outs = out_vertices(g, vert_index);
+            int32_t *weights = out_weights(g, vert_index);
+            for (uint64_t j = 0; j < out_degree; ++j)
+            {
+              uint64_t out_index = outs[j];
+              int32_t part_out = pulp->local_parts[out_index];
+              double weight_out = (double)weights[j];
+              tp.part_counts[part_out] += weight_out;
+            }
 
-          double max_val = 0.0;
-          uint64_t num_max = 0;
-          int64_t max_count = 0;
-          int64_t part_count = (int64_t)tp.part_counts[part];
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
-          {
-            int64_t count_init = (int64_t)tp.part_counts[p];
-            double sum_gain = 0.0;
+            int32_t max_part = part;
             for (uint64_t w = 0; w < g->num_vert_weights; ++w)
             {
+              double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
               double vert_weight =
                   (double)g->vert_weights[vert_index * g->num_vert_weights + w] /
                   (double)g->max_vert_weights[w];
-              double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
               double est_part_size =
-                  (double)pulp->part_sizes[w][p] + vert_weight + (multiplier * (double)pulp->part_size_changes[w][p] * avg_weight);
+                  (double)pulp->part_sizes[w][part] - vert_weight + (multiplier * (double)pulp->part_size_changes[w][part] * avg_weight);
               if (est_part_size < 0.0)
                 est_part_size = 0.1;
-              tp.part_weights[w][p] =
+              tp.part_weights[w][part] =
                   (constraints[w] * pulp->avg_sizes[w]) / est_part_size - 1.0;
-
-              double diff = (tp.part_weights[w][p] - tp.part_weights[w][part]);
-              if (p == part)
-                diff = tp.part_weights[w][part];
-              double gain = diff * vert_weight * pulp->weight_exponents[w];
-              sum_gain += gain;
             }
 
-            if (sum_gain <= 0.0)
-              continue;
+            double max_val = 0.0;
+            uint64_t num_max = 0;
+            int64_t max_count = 0;
+            int64_t part_count = (int64_t)tp.part_counts[part];
+            for (int32_t p = 0; p < pulp->num_parts; ++p)
+            {
+              int64_t count_init = (int64_t)tp.part_counts[p];
+              double sum_gain = 0.0;
+              for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+              {
+                double vert_weight =
+                    (double)g->vert_weights[vert_index * g->num_vert_weights + w] /
+                    (double)g->max_vert_weights[w];
+                double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
+                double est_part_size =
+                    (double)pulp->part_sizes[w][p] + vert_weight + (multiplier * (double)pulp->part_size_changes[w][p] * avg_weight);
+                if (est_part_size < 0.0)
+                  est_part_size = 0.1;
+                tp.part_weights[w][p] =
+                    (constraints[w] * pulp->avg_sizes[w]) / est_part_size - 1.0;
+
+                double diff = (tp.part_weights[w][p] - tp.part_weights[w][part]);
+                if (p == part)
+                  diff = tp.part_weights[w][part];
+                double gain = diff * vert_weight * pulp->weight_exponents[w];
+                sum_gain += gain;
+              }
 
-            tp.part_counts[p] *= sum_gain;
-            if (do_maxcut_balance && tp.part_cut_weights[p] > 0.0)
-              tp.part_counts[p] *= tp.part_cut_weights[p];
+              if (sum_gain <= 0.0)
+                continue;
 
-            if (tp.part_counts[p] == max_val && tp.part_counts[p] != 0.0)
-            {
-              tp.part_counts[num_max++] = (double)p;
-            }
-            else if (tp.part_counts[p] > max_val)
-            {
-              max_val = tp.part_counts[p];
-              max_part = p;
-              num_max = 0;
-              max_count = count_init;
-              tp.part_counts[num_max++] = (double)p;
+              tp.part_counts[p] *= sum_gain;
+              if (do_maxcut_balance && tp.part_cut_weights[p] > 0.0)
+                tp.part_counts[p] *= tp.part_cut_weights[p];
+
+              if (tp.part_counts[p] == max_val && tp.part_counts[p] != 0.0)
+              {
+                tp.part_counts[num_max++] = (double)p;
+              }
+              else if (tp.part_counts[p] > max_val)
+              {
+                max_val = tp.part_counts[p];
+                max_part = p;
+                num_max = 0;
+                max_count = count_init;
+                tp.part_counts[num_max++] = (double)p;
+              }
             }
-          }
 
-          if (num_max > 1)
-            max_part =
-                (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
+            if (num_max > 1)
+              max_part =
+                  (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
 
-          if (max_part != part)
-          {
-            bool send = true;
-            if (g->vert_weights[vert_index * g->num_vert_weights + train_wid] > 0)
+            if (max_part != part)
             {
-#pragma omp critical
+              bool send = true;
+              if (g->vert_weights[vert_index * g->num_vert_weights + train_wid] > 0)
               {
-                train_sizes[max_part] += 1;
-                train_sizes[part] -= 1;
-                train_num_max = 0;
-                train_num_min = g->n_total;
-                for (int32_t p = 0; p < pulp->num_parts; ++p)
+#pragma omp critical
                 {
-                  if (train_sizes[p] > train_num_max)
+                  train_sizes[max_part] += 1;
+                  train_sizes[part] -= 1;
+                  train_num_max = 0;
+                  train_num_min = g->n_total;
+                  for (int32_t p = 0; p < pulp->num_parts; ++p)
                   {
-                    train_num_max = train_sizes[p];
-                    // train_max_pid = p;
+                    if (train_sizes[p] > train_num_max)
+                    {
+                      train_num_max = train_sizes[p];
+                      // train_max_pid = p;
+                    }
+                    if (train_sizes[p] < train_num_min)
+                    {
+                      train_num_min = train_sizes[p];
+                      // train_min_pid = p;
+                    }
                   }
-                  if (train_sizes[p] < train_num_min)
+                  if (train_num_max - train_num_min >= batch_size)
                   {
-                    train_num_min = train_sizes[p];
-                    // train_min_pid = p;
+                    send = false;
+                    train_sizes[max_part] -= 1;
+                    train_sizes[part] += 1;
                   }
+                  // printf("minpid%d minnum%ld maxpid%d maxnum%ld srcpid%d dstpid%d send%d\n", train_min_pid, train_num_min, train_max_pid, train_num_max, part, max_part, send);
                 }
-                if (train_num_max - train_num_min >= batch_size)
-                {
-                  send = false;
-                  train_sizes[max_part] -= 1;
-                  train_sizes[part] += 1;
-                }
-                // printf("minpid%d minnum%ld maxpid%d maxnum%ld srcpid%d dstpid%d send%d\n", train_min_pid, train_num_min, train_max_pid, train_num_max, part, max_part, send);
               }
-            }
 
-            if (send)
-            {
-              ++num_swapped_1;
-
-              if (do_maxcut_balance)
+              if (send)
               {
-                int64_t diff_part = 2 * part_count - (int64_t)out_degree;
-                int64_t diff_max_part = (int64_t)(out_degree)-2 * max_count;
-                int64_t diff_cut = part_count - max_count;
+                ++num_swapped_1;
+
+                if (do_maxcut_balance)
+                {
+                  int64_t diff_part = 2 * part_count - (int64_t)out_degree;
+                  int64_t diff_max_part = (int64_t)(out_degree)-2 * max_count;
+                  int64_t diff_cut = part_count - max_count;
 #pragma omp atomic
-                pulp->cut_size_change += diff_cut;
+                  pulp->cut_size_change += diff_cut;
 #pragma omp atomic
-                pulp->part_cut_size_changes[part] += diff_part;
+                  pulp->part_cut_size_changes[part] += diff_part;
 #pragma omp atomic
-                pulp->part_cut_size_changes[max_part] += diff_max_part;
-              }
+                  pulp->part_cut_size_changes[max_part] += diff_max_part;
+                }
 
-              for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-              {
-                int32_t vert_weight =
-                    g->vert_weights[vert_index * g->num_vert_weights + w];
+                for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+                {
+                  int32_t vert_weight =
+                      g->vert_weights[vert_index * g->num_vert_weights + w];
 #pragma omp atomic
-                pulp->part_size_changes[w][part] -= vert_weight;
+                  pulp->part_size_changes[w][part] -= vert_weight;
 #pragma omp atomic
-                pulp->part_size_changes[w][max_part] += vert_weight;
-              }
+                  pulp->part_size_changes[w][max_part] += vert_weight;
+                }
+                if (pulp->sparse_sizes)
+                {
+                  touch_part(pulp, part);
+                  touch_part(pulp, max_part);
+                }
 
-              for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-              {
-                double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
+                for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+                {
+                  double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
 
-                tp.part_weights[w][part] =
-                    constraints[w] * pulp->avg_sizes[w] /
-                        ((double)pulp->part_sizes[w][part] + multiplier * (double)pulp->part_size_changes[w][part] * avg_weight) -
-                    1.0;
+                  tp.part_weights[w][part] =
+                      constraints[w] * pulp->avg_sizes[w] /
+                          ((double)pulp->part_sizes[w][part] + multiplier * (double)pulp->part_size_changes[w][part] * avg_weight) -
+                      1.0;
 
-                tp.part_weights[w][max_part] =
-                    constraints[w] * pulp->avg_sizes[w] /
-                        ((double)pulp->part_sizes[w][max_part] + multiplier * (double)pulp->part_size_changes[w][max_part] * avg_weight) -
-                    1.0;
+                  tp.part_weights[w][max_part] =
+                      constraints[w] * pulp->avg_sizes[w] /
+                          ((double)pulp->part_sizes[w][max_part] + multiplier * (double)pulp->part_size_changes[w][max_part] * avg_weight) -
+                      1.0;
 
-                if (do_maxcut_balance)
-                {
-                  double avg_cut_size = (double)pulp->cut_size / (double)pulp->num_parts;
-                  tp.part_cut_weights[part] =
-                      pulp->max_c * avg_cut_size /
-                      ((double)pulp->part_cut_sizes[part] + multiplier * (double)pulp->part_cut_size_changes[part] * avg_weight);
-
-                  tp.part_cut_weights[max_part] =
-                      pulp->max_c * avg_cut_size /
-                      ((double)pulp->part_cut_sizes[max_part] + multiplier * (double)pulp->part_cut_size_changes[max_part] * avg_weight);
+                  if (do_maxcut_balance)
+                  {
+                    double avg_cut_size = (double)pulp->cut_size / (double)pulp->num_parts;
+                    tp.part_cut_weights[part] =
+                        pulp->max_c * avg_cut_size /
+                        ((double)pulp->part_cut_sizes[part] + multiplier * (double)pulp->part_cut_size_changes[part] * avg_weight);
+
+                    tp.part_cut_weights[max_part] =
+                        pulp->max_c * avg_cut_size /
+                        ((double)pulp->part_cut_sizes[max_part] + multiplier * (double)pulp->part_cut_size_changes[max_part] * avg_weight);
+                  }
                 }
-              }
 
-              pulp->local_parts[vert_index] = max_part;
-              add_vid_to_send(&tq, q, vert_index);
+                pulp->local_parts[vert_index] = max_part;
+                if (sweep == 0)
+                  add_vid_to_send(&tq, q, vert_index);
+              }
             }
           }
-        }
 
-        empty_send(&tq, q);
+          // Only boundary vertices have updates to send, the interior sweep
+          // runs while they are in flight
+          if (sweep > 0)
+            continue;
 
-        for (int32_t p = 0; p < pulp->num_parts; ++p)
-        {
-          for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-          {
-            double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
-
-            tp.part_weights[w][p] =
-                constraints[w] * pulp->avg_sizes[w] /
-                    ((double)pulp->part_sizes[w][p] + (multiplier *
-                                                       (double)pulp->part_size_changes[w][p] * avg_weight)) -
-                1.0;
+          empty_send(&tq, q);
+#pragma omp barrier
 
-            if (do_maxcut_balance)
+          // Parts nobody touched still hold the weights set before the sweep
+          for (uint64_t i = 0; i < num_touched_parts(pulp); ++i)
+          {
+            int32_t p = touched_part(pulp, i);
+            for (uint64_t w = 0; w < g->num_vert_weights; ++w)
             {
-              double avg_cut_size =
-                  (double)pulp->cut_size / (double)pulp->num_parts;
+              double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
 
-              tp.part_cut_weights[p] =
-                  pulp->max_c * avg_cut_size /
-                      ((double)pulp->part_cut_sizes[p] + (multiplier *
-                                                          (double)pulp->part_cut_size_changes[p] * avg_weight)) -
+              tp.part_weights[w][p] =
+                  constraints[w] * pulp->avg_sizes[w] /
+                      ((double)pulp->part_sizes[w][p] + (multiplier *
+                                                         (double)pulp->part_size_changes[w][p] * avg_weight)) -
                   1.0;
+
+              if (do_maxcut_balance)
+              {
+                double avg_cut_size =
+                    (double)pulp->cut_size / (double)pulp->num_parts;
+
+                tp.part_cut_weights[p] =
+                    pulp->max_c * avg_cut_size /
+                        ((double)pulp->part_cut_sizes[p] + (multiplier *
+                                                            (double)pulp->part_cut_size_changes[p] * avg_weight)) -
+                    1.0;
+              }
             }
           }
-        }
 
 #pragma omp barrier
 
-        for (int32_t i = 0; i < nprocs; ++i)
-          tc.sendcounts_thread[i] = 0;
+          for (int32_t n = 0; n < comm->num_dests; ++n)
+            tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
-        for (uint64_t i = 0; i < q->send_size; ++i)
-        {
-          uint64_t vert_index = q->queue_send[i];
-          update_sendcounts_thread(g, &tc, vert_index);
-        }
+          for (uint64_t i = 0; i < q->send_size; ++i)
+          {
+            uint64_t vert_index = q->queue_send[i];
+            update_sendcounts_thread(g, &tc, comm, vert_index);
+          }
 
-        for (int32_t i = 0; i < nprocs; ++i)
-        {
+          for (int32_t n = 0; n < comm->num_dests; ++n)
+          {
+            int32_t i = comm->dests[n];
 #pragma omp atomic
-          comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
+            comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
-          tc.sendcounts_thread[i] = 0;
-        }
+            tc.sendcounts_thread[i] = 0;
+          }
 #pragma omp barrier
 
 #pragma omp single
-        {
-          init_sendbuf_vid_data(comm);
-        }
+          {
+            init_sendbuf_vid_data(comm);
+          }
 
 #pragma omp for schedule(guided) nowait
-        for (uint64_t i = 0; i < q->send_size; ++i)
-        {
-          uint64_t vert_index = q->queue_send[i];
-          update_vid_data_queues(g, &tc, comm,
-                                 vert_index, pulp->local_parts[vert_index]);
-        }
+          for (uint64_t i = 0; i < q->send_size; ++i)
+          {
+            uint64_t vert_index = q->queue_send[i];
+            update_vid_data_queues(g, &tc, comm,
+                                   vert_index, pulp->local_parts[vert_index]);
+          }
 
-        empty_vid_data(&tc, comm);
+          empty_vid_data(&tc, comm);
 #pragma omp barrier
 
+#pragma omp single
+          {
+            exchange_vert_data_begin(g, comm, q);
+          } // end single
+        }
+
+        // Deltas are final once every thread finishes its sweeps, so their
+        // reduction goes out while the ghost exchange completes
+#pragma omp barrier
 #pragma omp single
         {
-          exchange_vert_data(g, comm, q);
+          begin_size_change_reduction(g, pulp, do_maxcut_balance, &size_request);
+          exchange_vert_data_end(g, comm, q);
         } // end single
 
 #pragma omp for
         for (uint64_t i = 0; i < comm->total_recv; ++i)
         {
-          uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-          pulp->local_parts[index] = comm->recvbuf_data[i];
+          uint64_t index = g->n_local + recv_vert(comm, i);
+          pulp->local_parts[index] = recv_data(comm, i);
         }
 
 #pragma omp single
         {
           clear_recvbuf_vid_data(comm);
+          end_size_change_reduction(g, pulp, do_maxcut_balance, &size_request);
 
-          for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-            MPI_Allreduce(MPI_IN_PLACE, pulp->part_size_changes[w], pulp->num_parts,
-                          MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
-
+          max_c_changed = false;
           if (do_maxcut_balance)
           {
-            MPI_Allreduce(MPI_IN_PLACE, pulp->part_cut_size_changes, pulp->num_parts,
-                          MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
-            MPI_Allreduce(MPI_IN_PLACE, &pulp->cut_size_change, 1,
-                          MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
-
+            double max_c = pulp->max_c;
             pulp->avg_cut_size = (double)pulp->cut_size / (double)pulp->num_parts;
-            for (int32_t p = 0; p < pulp->num_parts; ++p)
+            for (uint64_t i = 0; i < num_changed_parts(pulp); ++i)
             {
+              int32_t p = changed_part(pulp, i);
               pulp->part_cut_sizes[p] += pulp->part_cut_size_changes[p];
               pulp->part_cut_size_changes[p] = 0;
               if (do_maxcut_balance)
@@ -467,20 +686,31 @@ int pulp_w(
                 tp.part_cut_weights[p] = pulp->max_c * pulp->avg_cut_size / (double)pulp->part_cut_sizes[p] - 1.0;
               }
             }
+            max_c_changed = (pulp->max_c != max_c);
           }
 
           for (uint64_t w = 0; w < g->num_vert_weights; ++w)
           {
             // pulp->maxes[w] = 0.0;
-            for (int32_t p = 0; p < pulp->num_parts; ++p)
+            for (uint64_t i = 0; i < num_changed_parts(pulp); ++i)
             {
+              int32_t p = changed_part(pulp, i);
               pulp->part_sizes[w][p] += pulp->part_size_changes[w][p];
               pulp->part_size_changes[w][p] = 0;
-              if ((double)pulp->part_sizes[w][p] / pulp->avg_sizes[w] >
+              if (pulp->sparse_sizes)
+                update_part_size_tree(pulp, w, p);
+              else if ((double)pulp->part_sizes[w][p] / pulp->avg_sizes[w] >
                   pulp->maxes[w])
                 pulp->maxes[w] = (double)pulp->part_sizes[w][p] / pulp->avg_sizes[w];
             }
 
+            // The tree root is the largest part, changed this time or not
+            if (pulp->sparse_sizes &&
+                (double)max_part_size(pulp, w) / pulp->avg_sizes[w] > 
+                pulp->maxes[w])
+              pulp->maxes[w] = 
+                (double)max_part_size(pulp, w) / pulp->avg_sizes[w];
+
             pulp->weight_exponents[w] *= pulp->maxes[w] / constraints[w];
             if (pulp->maxes[w] <= constraints[w] * 1.01)
             {
@@ -519,193 +749,218 @@ int pulp_w(
       for (uint64_t cur_ref_iter = 0; cur_ref_iter < refine_iter; ++cur_ref_iter)
       {
 
-#pragma omp for schedule(guided) reduction(+ : num_swapped_2) nowait
-        for (uint64_t vert_index = 0; vert_index < g->n_local; ++vert_index)
+        for (int32_t sweep = 0; sweep < num_sweeps(comm); ++sweep)
         {
-          int32_t part = pulp->local_parts[vert_index];
-
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
-            tp.part_counts[p] = 0.0;
-          // tp.part_counts[part] = 0.0;
-
-          uint64_t out_degree = out_degree(g, vert_index);
-          uint64_t *outs = out_vertices(g, vert_index);
-          int32_t *weights = out_weights(g, vert_index);
-          for (uint64_t j = 0; j < out_degree; ++j)
+          uint64_t begin = sweep_begin(g, comm, sweep);
+          uint64_t end = sweep_end(g, comm, sweep);
+#pragma omp for schedule(guided) reduction(+ : num_swapped_2) nowait
+          for (uint64_t i = begin; i < end; ++i)
           {
-            uint64_t out_index = outs[j];
-            int32_t part_out = pulp->local_parts[out_index];
-            double weight_out = (double)weights[j];
-            tp.part_counts[part_out] += weight_out;
-          }
+            uint64_t vert_index = sweep_vert(comm, i);
+            int32_t part = pulp->local_parts[vert_index];
 
-          int32_t max_part = part;
-          double max_val = 0.0;
-          uint64_t num_max = 0;
-          for (int32_t p = 0; p < pulp->num_parts; ++p)
-          {
-            if (tp.part_counts[p] == max_val)
+            for (int32_t p = 0; p < pulp->num_parts; ++p)
+              tp.part_counts[p] = 0.0;
+            // tp.part_counts[part] = 0.0;
+
+            uint64_t out_degree = out_degree(g, vert_index);
+            lid_t *outs = out_vertices(g, vert_index);
+            int32_t *weights = out_weights(g, vert_index);
+            for (uint64_t j = 0; j < out_degree; ++j)
             {
-              tp.part_counts[num_max++] = (double)p;
+              uint64_t out_index = outs[j];
+              int32_t part_out = pulp->local_parts[out_index];
+              double weight_out = (double)weights[j];
+              tp.part_counts[part_out] += weight_out;
             }
-            else if (tp.part_counts[p] > max_val)
+
+            int32_t max_part = part;
+            double max_val = 0.0;
+            uint64_t num_max = 0;
+            for (int32_t p = 0; p < pulp->num_parts; ++p)
             {
-              max_val = tp.part_counts[p];
-              max_part = p;
-              num_max = 0;
-              tp.part_counts[num_max++] = (double)p;
+              if (tp.part_counts[p] == max_val)
+              {
+                tp.part_counts[num_max++] = (double)p;
+              }
+              else if (tp.part_counts[p] > max_val)
+              {
+                max_val = tp.part_counts[p];
+                max_part = p;
+                num_max = 0;
+                tp.part_counts[num_max++] = (double)p;
+              }
             }
-          }
-
-          if (num_max > 1)
-            max_part =
-                (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
 
-          if (max_part != part)
-          {
-            bool change = true;
+            if (num_max > 1)
+              max_part =
+                  (int32_t)tp.part_counts[(xs1024star_next(&xs) % num_max)];
 
-            for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+            if (max_part != part)
             {
-              double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
-              int32_t vert_weight =
-                  g->vert_weights[vert_index * g->num_vert_weights + w];
-              int64_t new_size = (int64_t)pulp->avg_sizes[w];
+              bool change = true;
 
-              new_size =
-                  pulp->part_size_changes[w][max_part] + (int64_t)vert_weight < 0 ? pulp->part_sizes[w][max_part] + pulp->part_size_changes[w][max_part] + (int64_t)vert_weight : (int64_t)((double)pulp->part_sizes[w][max_part] + fabs(multiplier * (double)pulp->part_size_changes[w][max_part] * avg_weight) + (double)vert_weight);
+              for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+              {
+                double avg_weight = (double)g->vert_weights_sums[w] / (double)g->n;
+                int32_t vert_weight =
+                    g->vert_weights[vert_index * g->num_vert_weights + w];
+                int64_t new_size = (int64_t)pulp->avg_sizes[w];
 
-              // if (new_size > (int64_t)(pulp->avg_sizes[w]*constraints[w]))
+                new_size =
+                    pulp->part_size_changes[w][max_part] + (int64_t)vert_weight < 0 ? pulp->part_sizes[w][max_part] + pulp->part_size_changes[w][max_part] + (int64_t)vert_weight : (int64_t)((double)pulp->part_sizes[w][max_part] + fabs(multiplier * (double)pulp->part_size_changes[w][max_part] * avg_weight) + (double)vert_weight);
 
-              double max_imb = pulp->maxes[w] > constraints[w] ? pulp->maxes[w] : constraints[w];
-              if (new_size > (int64_t)(pulp->avg_sizes[w] * max_imb))
-                change = false;
-            }
+                // if (new_size > (int64_t)(pulp->avg_sizes[w]*constraints[w]))
 
-            /*printf("%d %d - %lu to %d (%li + %li) from %d (%li + %li) -- %li %li\n",
-              procid, omp_get_thread_num(), g->local_unmap[vert_index], max_part, pulp->part_sizes[max_part], pulp->part_size_changes[max_part], part, pulp->part_sizes[part], pulp->part_size_changes[part], new_size, (int64_t)(pulp->avg_sizes[weight_index]*balance));*/
+                double max_imb = pulp->maxes[w] > constraints[w] ? pulp->maxes[w] : constraints[w];
+                if (new_size > (int64_t)(pulp->avg_sizes[w] * max_imb))
+                  change = false;
+              }
 
-            if (change)
-            {
-              bool send = true;
-              if (g->vert_weights[vert_index * g->num_vert_weights + train_wid] > 0)
+              /*printf("%d %d - %lu to %d (%li + %li) from %d (%li + %li) -- %li %li\n",
+                procid, omp_get_thread_num(), g->local_unmap[vert_index], max_part, pulp->part_sizes[max_part], pulp->part_size_changes[max_part], part, pulp->part_sizes[part], pulp->part_size_changes[part], new_size, (int64_t)(pulp->avg_sizes[weight_index]*balance));*/
+
+              if (change)
               {
-#pragma omp critical
+                bool send = true;
+                if (g->vert_weights[vert_index * g->num_vert_weights + train_wid] > 0)
                 {
-                  train_sizes[max_part] += 1;
-                  train_sizes[part] -= 1;
-                  train_num_max = 0;
-                  train_num_min = g->n_total;
-                  for (int32_t p = 0; p < pulp->num_parts; ++p)
+#pragma omp critical
                   {
-                    if (train_sizes[p] > train_num_max)
+                    train_sizes[max_part] += 1;
+                    train_sizes[part] -= 1;
+                    train_num_max = 0;
+                    train_num_min = g->n_total;
+                    for (int32_t p = 0; p < pulp->num_parts; ++p)
                     {
-                      train_num_max = train_sizes[p];
-                      // train_max_pid = p;
+                      if (train_sizes[p] > train_num_max)
+                      {
+                        train_num_max = train_sizes[p];
+                        // train_max_pid = p;
+                      }
+                      if (train_sizes[p] < train_num_min)
+                      {
+                        train_num_min = train_sizes[p];
+                        // train_min_pid = p;
+                      }
                     }
-                    if (train_sizes[p] < train_num_min)
+                    if (train_num_max - train_num_min >= batch_size)
                     {
-                      train_num_min = train_sizes[p];
-                      // train_min_pid = p;
+                      send = false;
+                      train_sizes[max_part] -= 1;
+                      train_sizes[part] += 1;
                     }
+                    // printf("minpid%d minnum%ld maxpid%d maxnum%ld srcpid%d dstpid%d send%d\n", train_min_pid, train_num_min, train_max_pid, train_num_max, part, max_part, send);
                   }
-                  if (train_num_max - train_num_min >= batch_size)
-                  {
-                    send = false;
-                    train_sizes[max_part] -= 1;
-                    train_sizes[part] += 1;
-                  }
-                  // printf("minpid%d minnum%ld maxpid%d maxnum%ld srcpid%d dstpid%d send%d\n", train_min_pid, train_num_min, train_max_pid, train_num_max, part, max_part, send);
                 }
-              }
 
-              if (send)
-              {
-                ++num_swapped_2;
-
-                for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+                if (send)
                 {
-                  int32_t vert_weight =
-                      g->vert_weights[vert_index * g->num_vert_weights + w];
+                  ++num_swapped_2;
+
+                  for (uint64_t w = 0; w < g->num_vert_weights; ++w)
+                  {
+                    int32_t vert_weight =
+                        g->vert_weights[vert_index * g->num_vert_weights + w];
 #pragma omp atomic
-                  pulp->part_size_changes[w][part] -= vert_weight;
+                    pulp->part_size_changes[w][part] -= vert_weight;
 #pragma omp atomic
-                  pulp->part_size_changes[w][max_part] += vert_weight;
-                }
+                    pulp->part_size_changes[w][max_part] += vert_weight;
+                  }
+                  if (pulp->sparse_sizes)
+                  {
+                    touch_part(pulp, part);
+                    touch_part(pulp, max_part);
+                  }
 
-                pulp->local_parts[vert_index] = max_part;
-                add_vid_to_send(&tq, q, vert_index);
-                // add_vid_to_queue(&tq, q, vert_index);
+                  pulp->local_parts[vert_index] = max_part;
+                  if (sweep == 0)
+                    add_vid_to_send(&tq, q, vert_index);
+                  // add_vid_to_queue(&tq, q, vert_index);
+                }
               }
             }
           }
-        }
 
-        empty_send(&tq, q);
-        // empty_queue(&tq, q);
+          // Only boundary vertices have updates to send, the interior sweep
+          // runs while they are in flight
+          if (sweep > 0)
+            continue;
+
+          empty_send(&tq, q);
+          // empty_queue(&tq, q);
 #pragma omp barrier
 
-        for (int32_t i = 0; i < nprocs; ++i)
-          tc.sendcounts_thread[i] = 0;
+          for (int32_t n = 0; n < comm->num_dests; ++n)
+            tc.sendcounts_thread[comm->dests[n]] = 0;
 
 #pragma omp for schedule(guided) nowait
-        for (uint64_t i = 0; i < q->send_size; ++i)
-        {
-          uint64_t vert_index = q->queue_send[i];
-          update_sendcounts_thread(g, &tc, vert_index);
-        }
+          for (uint64_t i = 0; i < q->send_size; ++i)
+          {
+            uint64_t vert_index = q->queue_send[i];
+            update_sendcounts_thread(g, &tc, comm, vert_index);
+          }
 
-        for (int32_t i = 0; i < nprocs; ++i)
-        {
+          for (int32_t n = 0; n < comm->num_dests; ++n)
+          {
+            int32_t i = comm->dests[n];
 #pragma omp atomic
-          comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
+            comm->sendcounts_temp[i] += tc.sendcounts_thread[i];
 
-          tc.sendcounts_thread[i] = 0;
-        }
+            tc.sendcounts_thread[i] = 0;
+          }
 #pragma omp barrier
 
 #pragma omp single
-        {
-          init_sendbuf_vid_data(comm);
-        }
+          {
+            init_sendbuf_vid_data(comm);
+          }
 
 #pragma omp for schedule(guided) nowait
-        for (uint64_t i = 0; i < q->send_size; ++i)
-        {
-          uint64_t vert_index = q->queue_send[i];
-          update_vid_data_queues(g, &tc, comm,
-                                 vert_index, pulp->local_parts[vert_index]);
-        }
+          for (uint64_t i = 0; i < q->send_size; ++i)
+          {
+            uint64_t vert_index = q->queue_send[i];
+            update_vid_data_queues(g, &tc, comm,
+                                   vert_index, pulp->local_parts[vert_index]);
+          }
 
-        empty_vid_data(&tc, comm);
+          empty_vid_data(&tc, comm);
 #pragma omp barrier
 
+#pragma omp single
+          {
+            exchange_vert_data_begin(g, comm, q);
+          } // end single
+        }
+
+#pragma omp barrier
 #pragma omp single
         {
-          exchange_vert_data(g, comm, q);
+          begin_size_change_reduction(g, pulp, false, &size_request);
+          exchange_vert_data_end(g, comm, q);
         } // end single
 
 #pragma omp for
         for (uint64_t i = 0; i < comm->total_recv; ++i)
         {
-          uint64_t index = get_value(g->map, comm->recvbuf_vert[i]);
-          pulp->local_parts[index] = comm->recvbuf_data[i];
+          uint64_t index = g->n_local + recv_vert(comm, i);
+          pulp->local_parts[index] = recv_data(comm, i);
         }
 
 #pragma omp single
         {
           clear_recvbuf_vid_data(comm);
-
-          for (uint64_t w = 0; w < g->num_vert_weights; ++w)
-            MPI_Allreduce(MPI_IN_PLACE, pulp->part_size_changes[w], pulp->num_parts,
-                          MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+          end_size_change_reduction(g, pulp, false, &size_request);
 
           for (uint64_t w = 0; w < g->num_vert_weights; ++w)
           {
-            for (int32_t p = 0; p < pulp->num_parts; ++p)
+            for (uint64_t i = 0; i < num_changed_parts(pulp); ++i)
             {
+              int32_t p = changed_part(pulp, i);
               pulp->part_sizes[w][p] += pulp->part_size_changes[w][p];
               pulp->part_size_changes[w][p] = 0;
+              if (pulp->sparse_sizes)
+                update_part_size_tree(pulp, w, p);
             }
           }
 
@@ -7,4 +7,16 @@ int pulp_w(
   uint64_t outer_iter, uint64_t balance_iter, uint64_t refine_iter, 
   double* constraints, bool do_maxcut_balance);
 
+void begin_size_change_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request);
+
+void end_size_change_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request);
+
+void begin_sparse_size_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request);
+
+void end_sparse_size_reduction(dist_graph_t* g, pulp_data_t* pulp,
+  bool with_cut, MPI_Request* request);
+
 #endif
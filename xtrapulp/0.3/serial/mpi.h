@@ -0,0 +1,519 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//  XtraPuLP: Xtreme-Scale Graph Partitioning using Label Propagation
+//              Copyright (2016) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions?  Contact  George M. Slota   (gmslota@sandia.gov)
+//                      Siva Rajamanickam (srajama@sandia.gov)
+//                      Kamesh Madduri    (madduri@cse.psu.edu)
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#ifndef _SERIAL_MPI_H_
+#define _SERIAL_MPI_H_
+
+// Single task stand-in for the MPI calls XtraPuLP makes, used by the
+// serial build (make serial) in place of the real mpi.h. The one task is
+// rank 0 of every communicator: collectives copy its own block, neighbor
+// collectives copy only when it was given itself as a neighbor, and
+// windows and files are plain memory and POSIX files.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MPI_VERSION 3
+#define MPI_SUBVERSION 1
+
+#define MPI_SUCCESS 0
+#define MPI_ERR_OTHER 15
+#define MPI_UNDEFINED (-32766)
+
+typedef int64_t MPI_Aint;
+typedef int64_t MPI_Offset;
+typedef int64_t MPI_Count;
+
+typedef int MPI_Comm;
+#define MPI_COMM_NULL 0
+#define MPI_COMM_WORLD 1
+#define MPI_COMM_SELF 1
+#define SERIAL_COMM_NO_NEIGHBORS 2
+#define SERIAL_COMM_SELF_NEIGHBOR 3
+#define MPI_COMM_TYPE_SHARED 1
+
+typedef int MPI_Op;
+#define MPI_SUM 1
+#define MPI_MAX 2
+#define MPI_MIN 3
+#define MPI_REPLACE 4
+#define MPI_NO_OP 5
+
+typedef int MPI_Info;
+#define MPI_INFO_NULL 0
+
+typedef int MPI_Request;
+#define MPI_REQUEST_NULL 0
+
+typedef struct { int MPI_ERROR; } MPI_Status;
+#define MPI_STATUS_IGNORE ((MPI_Status*)0)
+#define MPI_STATUSES_IGNORE ((MPI_Status*)0)
+
+#define MPI_IN_PLACE ((void*)1)
+#define MPI_UNWEIGHTED ((int*)1)
+
+#define MPI_MODE_NOCHECK 1024
+#define MPI_MODE_RDONLY 2
+#define MPI_MODE_RDWR 8
+#define MPI_MODE_WRONLY 4
+#define MPI_MODE_CREATE 1
+
+// Datatypes are contiguous, size bytes starting lb bytes into the buffer
+typedef struct {
+  MPI_Aint size;
+  MPI_Aint lb;
+} MPI_Datatype;
+
+const MPI_Datatype MPI_DATATYPE_NULL = {0, 0};
+const MPI_Datatype MPI_BYTE = {1, 0};
+const MPI_Datatype MPI_CHAR = {1, 0};
+const MPI_Datatype MPI_INT = {sizeof(int), 0};
+const MPI_Datatype MPI_INT32_T = {4, 0};
+const MPI_Datatype MPI_UINT32_T = {4, 0};
+const MPI_Datatype MPI_INT64_T = {8, 0};
+const MPI_Datatype MPI_UINT64_T = {8, 0};
+const MPI_Datatype MPI_DOUBLE = {8, 0};
+
+struct serial_win_t {
+  char* base;
+  int disp_unit;
+};
+typedef serial_win_t* MPI_Win;
+#define MPI_WIN_NULL ((MPI_Win)0)
+
+typedef int MPI_File;
+#define MPI_FILE_NULL (-1)
+
+
+inline void serial_copy(const void* sendbuf, MPI_Aint sdisp, 
+                        MPI_Datatype sendtype, void* recvbuf, 
+                        MPI_Aint rdisp, MPI_Datatype recvtype, 
+                        MPI_Aint count)
+{
+  if (sendbuf == MPI_IN_PLACE || count == 0)
+    return;
+
+  memmove((char*)recvbuf + rdisp + recvtype.lb, 
+          (const char*)sendbuf + sdisp + sendtype.lb, 
+          count*sendtype.size);
+}
+
+// Only the integer ops the one-sided exchange uses
+inline void serial_apply(const void* origin, void* target, 
+                         MPI_Datatype type, MPI_Aint count, MPI_Op op)
+{
+  if (op == MPI_NO_OP)
+    return;
+  if (op == MPI_REPLACE || type.size != 8) 
+  {
+    memcpy(target, origin, count*type.size);
+    return;
+  }
+
+  for (MPI_Aint i = 0; i < count; ++i)
+  {
+    int64_t value = ((const int64_t*)origin)[i];
+    int64_t* dest = (int64_t*)target + i;
+    if (op == MPI_SUM)
+      *dest += value;
+    else if (op == MPI_MAX && value > *dest)
+      *dest = value;
+    else if (op == MPI_MIN && value < *dest)
+      *dest = value;
+  }
+}
+
+
+inline int MPI_Init(int* argc, char*** argv) { return MPI_SUCCESS; }
+inline int MPI_Finalize() { return MPI_SUCCESS; }
+inline int MPI_Abort(MPI_Comm comm, int errorcode) { exit(errorcode); }
+
+inline int MPI_Comm_rank(MPI_Comm comm, int* rank)
+{
+  *rank = 0;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Comm_size(MPI_Comm comm, int* size)
+{
+  *size = 1;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Comm_split(MPI_Comm comm, int color, int key, 
+                          MPI_Comm* newcomm)
+{
+  *newcomm = (color == MPI_UNDEFINED) ? MPI_COMM_NULL : MPI_COMM_WORLD;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Comm_split_type(MPI_Comm comm, int split_type, int key, 
+                               MPI_Info info, MPI_Comm* newcomm)
+{
+  *newcomm = MPI_COMM_WORLD;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Comm_free(MPI_Comm* comm)
+{
+  *comm = MPI_COMM_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Dist_graph_create_adjacent(MPI_Comm comm, 
+  int indegree, const int sources[], const int sourceweights[], 
+  int outdegree, const int dests[], const int destweights[], 
+  MPI_Info info, int reorder, MPI_Comm* newcomm)
+{
+  *newcomm = (indegree > 0) ? 
+    SERIAL_COMM_SELF_NEIGHBOR : SERIAL_COMM_NO_NEIGHBORS;
+  return MPI_SUCCESS;
+}
+
+
+inline int MPI_Type_contiguous(int count, MPI_Datatype oldtype, 
+                               MPI_Datatype* newtype)
+{
+  newtype->size = count*oldtype.size;
+  newtype->lb = oldtype.lb;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_create_struct(int count, const int lengths[], 
+  const MPI_Aint displs[], const MPI_Datatype types[], 
+  MPI_Datatype* newtype)
+{
+  newtype->size = 0;
+  newtype->lb = (count > 0) ? displs[0] + types[0].lb : 0;
+  for (int i = 0; i < count; ++i)
+    newtype->size += lengths[i]*types[i].size;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_get_extent(MPI_Datatype type, MPI_Aint* lb, 
+                               MPI_Aint* extent)
+{
+  *lb = type.lb;
+  *extent = type.size;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_commit(MPI_Datatype* type) { return MPI_SUCCESS; }
+
+inline int MPI_Type_free(MPI_Datatype* type)
+{
+  *type = MPI_DATATYPE_NULL;
+  return MPI_SUCCESS;
+}
+
+
+inline int MPI_Wait(MPI_Request* request, MPI_Status* status)
+{
+  *request = MPI_REQUEST_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Waitall(int count, MPI_Request requests[], 
+                       MPI_Status statuses[])
+{
+  for (int i = 0; i < count; ++i)
+    requests[i] = MPI_REQUEST_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Barrier(MPI_Comm comm) { return MPI_SUCCESS; }
+
+inline int MPI_Bcast(void* buffer, int count, MPI_Datatype type, 
+                     int root, MPI_Comm comm) { return MPI_SUCCESS; }
+
+inline int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count, 
+                         MPI_Datatype type, MPI_Op op, MPI_Comm comm)
+{
+  serial_copy(sendbuf, 0, type, recvbuf, 0, type, count);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Iallreduce(const void* sendbuf, void* recvbuf, int count, 
+                          MPI_Datatype type, MPI_Op op, MPI_Comm comm,
+                          MPI_Request* request)
+{
+  *request = MPI_REQUEST_NULL;
+  return MPI_Allreduce(sendbuf, recvbuf, count, type, op, comm);
+}
+
+// The result on rank 0 is undefined, as in MPI
+inline int MPI_Exscan(const void* sendbuf, void* recvbuf, int count, 
+                      MPI_Datatype type, MPI_Op op, MPI_Comm comm)
+{ 
+  return MPI_SUCCESS; 
+}
+
+inline int MPI_Gather(const void* sendbuf, int sendcount, 
+                      MPI_Datatype sendtype, void* recvbuf, int recvcount, 
+                      MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+  serial_copy(sendbuf, 0, sendtype, recvbuf, 0, recvtype, sendcount);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Allgather(const void* sendbuf, int sendcount, 
+                         MPI_Datatype sendtype, void* recvbuf, int recvcount,
+                         MPI_Datatype recvtype, MPI_Comm comm)
+{
+  serial_copy(sendbuf, 0, sendtype, recvbuf, 0, recvtype, sendcount);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Allgatherv(const void* sendbuf, int sendcount, 
+                          MPI_Datatype sendtype, void* recvbuf, 
+                          const int recvcounts[], const int displs[],
+                          MPI_Datatype recvtype, MPI_Comm comm)
+{
+  serial_copy(sendbuf, 0, sendtype, 
+              recvbuf, displs[0]*recvtype.size, recvtype, sendcount);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Alltoall(const void* sendbuf, int sendcount, 
+                        MPI_Datatype sendtype, void* recvbuf, int recvcount,
+                        MPI_Datatype recvtype, MPI_Comm comm)
+{
+  serial_copy(sendbuf, 0, sendtype, recvbuf, 0, recvtype, sendcount);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Alltoallv(const void* sendbuf, const int sendcounts[], 
+                         const int sdispls[], MPI_Datatype sendtype, 
+                         void* recvbuf, const int recvcounts[], 
+                         const int rdispls[], MPI_Datatype recvtype, 
+                         MPI_Comm comm)
+{
+  serial_copy(sendbuf, sdispls[0]*sendtype.size, sendtype, 
+              recvbuf, rdispls[0]*recvtype.size, recvtype, sendcounts[0]);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Ialltoallv(const void* sendbuf, const int sendcounts[], 
+                          const int sdispls[], MPI_Datatype sendtype, 
+                          void* recvbuf, const int recvcounts[], 
+                          const int rdispls[], MPI_Datatype recvtype, 
+                          MPI_Comm comm, MPI_Request* request)
+{
+  *request = MPI_REQUEST_NULL;
+  return MPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, 
+                       recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+inline int MPI_Alltoallw(const void* sendbuf, const int sendcounts[], 
+                         const int sdispls[], const MPI_Datatype sendtypes[],
+                         void* recvbuf, const int recvcounts[], 
+                         const int rdispls[], const MPI_Datatype recvtypes[],
+                         MPI_Comm comm)
+{
+  serial_copy(sendbuf, sdispls[0], sendtypes[0], 
+              recvbuf, rdispls[0], recvtypes[0], sendcounts[0]);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Neighbor_alltoall(const void* sendbuf, int sendcount, 
+                                 MPI_Datatype sendtype, void* recvbuf, 
+                                 int recvcount, MPI_Datatype recvtype, 
+                                 MPI_Comm comm)
+{
+  if (comm == SERIAL_COMM_SELF_NEIGHBOR)
+    serial_copy(sendbuf, 0, sendtype, recvbuf, 0, recvtype, sendcount);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Ineighbor_alltoallv(const void* sendbuf, 
+  const int sendcounts[], const int sdispls[], MPI_Datatype sendtype, 
+  void* recvbuf, const int recvcounts[], const int rdispls[], 
+  MPI_Datatype recvtype, MPI_Comm comm, MPI_Request* request)
+{
+  *request = MPI_REQUEST_NULL;
+  if (comm == SERIAL_COMM_SELF_NEIGHBOR)
+    serial_copy(sendbuf, sdispls[0]*sendtype.size, sendtype, 
+                recvbuf, rdispls[0]*recvtype.size, recvtype, sendcounts[0]);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Ineighbor_alltoallw(const void* sendbuf, 
+  const int sendcounts[], const MPI_Aint sdispls[], 
+  const MPI_Datatype sendtypes[], void* recvbuf, const int recvcounts[], 
+  const MPI_Aint rdispls[], const MPI_Datatype recvtypes[], 
+  MPI_Comm comm, MPI_Request* request)
+{
+  *request = MPI_REQUEST_NULL;
+  if (comm == SERIAL_COMM_SELF_NEIGHBOR)
+    serial_copy(sendbuf, sdispls[0], sendtypes[0], 
+                recvbuf, rdispls[0], recvtypes[0], sendcounts[0]);
+  return MPI_SUCCESS;
+}
+
+
+inline int MPI_Win_allocate(MPI_Aint size, int disp_unit, MPI_Info info, 
+                            MPI_Comm comm, void* baseptr, MPI_Win* win)
+{
+  *win = (MPI_Win)malloc(sizeof(serial_win_t));
+  if (*win == NULL)
+    return MPI_ERR_OTHER;
+  (*win)->base = (char*)calloc(size > 0 ? size : 1, 1);
+  (*win)->disp_unit = disp_unit;
+  *(void**)baseptr = (*win)->base;
+  return (*win)->base == NULL ? MPI_ERR_OTHER : MPI_SUCCESS;
+}
+
+inline int MPI_Win_allocate_shared(MPI_Aint size, int disp_unit, 
+                                   MPI_Info info, MPI_Comm comm, 
+                                   void* baseptr, MPI_Win* win)
+{
+  return MPI_Win_allocate(size, disp_unit, info, comm, baseptr, win);
+}
+
+inline int MPI_Win_shared_query(MPI_Win win, int rank, MPI_Aint* size, 
+                                int* disp_unit, void* baseptr)
+{
+  *size = 0;
+  *disp_unit = win->disp_unit;
+  *(void**)baseptr = win->base;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Win_free(MPI_Win* win)
+{
+  free((*win)->base);
+  free(*win);
+  *win = MPI_WIN_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Win_lock_all(int assert, MPI_Win win) { return MPI_SUCCESS; }
+inline int MPI_Win_unlock_all(MPI_Win win) { return MPI_SUCCESS; }
+inline int MPI_Win_flush(int rank, MPI_Win win) { return MPI_SUCCESS; }
+inline int MPI_Win_flush_all(MPI_Win win) { return MPI_SUCCESS; }
+inline int MPI_Win_sync(MPI_Win win) { return MPI_SUCCESS; }
+
+inline int MPI_Put(const void* origin, int origin_count, 
+                   MPI_Datatype origin_type, int target_rank, 
+                   MPI_Aint target_disp, int target_count, 
+                   MPI_Datatype target_type, MPI_Win win)
+{
+  serial_copy(origin, 0, origin_type, 
+              win->base, target_disp*win->disp_unit, target_type, 
+              origin_count);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Accumulate(const void* origin, int origin_count, 
+                          MPI_Datatype origin_type, int target_rank, 
+                          MPI_Aint target_disp, int target_count, 
+                          MPI_Datatype target_type, MPI_Op op, MPI_Win win)
+{
+  serial_apply(origin, win->base + target_disp*win->disp_unit, 
+               origin_type, origin_count, op);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Fetch_and_op(const void* origin, void* result, 
+                            MPI_Datatype type, int target_rank, 
+                            MPI_Aint target_disp, MPI_Op op, MPI_Win win)
+{
+  char* target = win->base + target_disp*win->disp_unit;
+  memcpy(result, target, type.size);
+  serial_apply(origin, target, type, 1, op);
+  return MPI_SUCCESS;
+}
+
+
+inline int MPI_File_open(MPI_Comm comm, const char* filename, int amode, 
+                         MPI_Info info, MPI_File* fh)
+{
+  int flags = O_RDONLY;
+  if (amode & MPI_MODE_WRONLY)
+    flags = O_WRONLY;
+  else if (amode & MPI_MODE_RDWR)
+    flags = O_RDWR;
+  if (amode & MPI_MODE_CREATE)
+    flags |= O_CREAT;
+
+  *fh = open(filename, flags, 0644);
+  return (*fh < 0) ? MPI_ERR_OTHER : MPI_SUCCESS;
+}
+
+inline int MPI_File_set_size(MPI_File fh, MPI_Offset size)
+{
+  return ftruncate(fh, (off_t)size) == 0 ? MPI_SUCCESS : MPI_ERR_OTHER;
+}
+
+inline int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, 
+                                 const void* buf, int count, 
+                                 MPI_Datatype type, MPI_Status* status)
+{
+  const char* data = (const char*)buf + type.lb;
+  MPI_Aint remaining = count*type.size;
+  while (remaining > 0)
+  {
+    ssize_t written = pwrite(fh, data, remaining, (off_t)offset);
+    if (written <= 0)
+      return MPI_ERR_OTHER;
+    data += written;
+    offset += written;
+    remaining -= written;
+  }
+  return MPI_SUCCESS;
+}
+
+inline int MPI_File_close(MPI_File* fh)
+{
+  int ret = close(*fh);
+  *fh = MPI_FILE_NULL;
+  return (ret == 0) ? MPI_SUCCESS : MPI_ERR_OTHER;
+}
+
+#endif
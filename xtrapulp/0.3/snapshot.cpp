@@ -0,0 +1,463 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//  XtraPuLP: Xtreme-Scale Graph Partitioning using Label Propagation
+//              Copyright (2016) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions?  Contact  George M. Slota   (gmslota@sandia.gov)
+//                      Siva Rajamanickam (srajama@sandia.gov)
+//                      Kamesh Madduri    (madduri@cse.psu.edu)
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "xtrapulp.h"
+#include "dist_graph.h"
+#include "fast_map.h"
+#include "io_pp.h"
+#include "snapshot.h"
+#include "util.h"
+
+extern int procid, nprocs;
+extern bool verbose, debug, verify;
+
+inline uint64_t hash_bytes(uint64_t hash, const char* buf, uint64_t len)
+{
+  const uint64_t mult = 0x9E3779B97F4A7C15ULL;
+
+  uint64_t i = 0;
+  for (; i + 8 <= len; i += 8)
+  {
+    uint64_t word;
+    memcpy(&word, buf + i, sizeof(uint64_t));
+    hash = (hash ^ word) * mult;
+    hash ^= hash >> 32;
+  }
+  for (; i < len; ++i)
+  {
+    hash = (hash ^ (uint64_t)(uint8_t)buf[i]) * mult;
+    hash ^= hash >> 32;
+  }
+
+  return hash;
+}
+
+uint64_t hash_input_file(char* input_filename)
+{
+  if (debug) { printf("Task %d hash_input_file() start\n", procid); }
+
+  double elt = 0.0;
+  if (verbose) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  int fd = open(input_filename, O_RDONLY);
+  if (fd < 0)
+    throw_err("hash_input_file() unable to open input file", procid);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throw_err("hash_input_file() unable to stat input file", procid);
+  uint64_t file_size = (uint64_t)st.st_size;
+
+  // Every task hashes its own byte range, rank 0 folds them in task order
+  uint64_t begin = (file_size * (uint64_t)procid) / (uint64_t)nprocs;
+  uint64_t end = (file_size * (uint64_t)(procid + 1)) / (uint64_t)nprocs;
+  char* buf = (char*)malloc(SNAPSHOT_HASH_CHUNK);
+  if (buf == NULL)
+    throw_err("hash_input_file(), unable to allocate buffer", procid);
+
+  uint64_t hash = 0;
+  for (uint64_t pos = begin; pos < end; pos += SNAPSHOT_HASH_CHUNK)
+  {
+    uint64_t count = (end - pos) < SNAPSHOT_HASH_CHUNK ? 
+                     (end - pos) : SNAPSHOT_HASH_CHUNK;
+    if (pread_full(fd, buf, count, pos))
+      throw_err("hash_input_file(), unable to read input file", procid);
+    hash = hash_bytes(hash, buf, count);
+  }
+  free(buf);
+  close(fd);
+
+  uint64_t* task_hashes = (uint64_t*)malloc(nprocs*sizeof(uint64_t));
+  MPI_Gather(&hash, 1, MPI_UINT64_T, task_hashes, 1, MPI_UINT64_T, 
+             0, MPI_COMM_WORLD);
+  if (procid == 0) {
+    hash = hash_bytes(file_size, (char*)task_hashes, 
+                      nprocs*sizeof(uint64_t));
+  }
+  MPI_Bcast(&hash, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  free(task_hashes);
+
+  if (verbose) {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d hash_input_file() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug) { printf("Task %d hash_input_file() success\n", procid); }
+  return hash;
+}
+
+// Adjacency order is part of the match, a snapshot saved with or without -L
+// is rebuilt rather than handed to a run asking for the other order
+bool read_manifest(char* prefix, uint64_t input_hash, 
+                   int32_t input_format, bool offset_vids, bool sorted_adjs)
+{
+  int32_t valid = 0;
+  if (procid == 0)
+  {
+    char filename[1024];
+    snprintf(filename, 1024, "%s.manifest", prefix);
+    FILE* fp = fopen(filename, "r");
+    if (fp != NULL)
+    {
+      char magic[64];
+      char input_name[1024];
+      uint64_t version = 0;
+      uint64_t hash = 0;
+      int32_t tasks = 0;
+      int32_t format = -1;
+      int32_t offset = -1;
+      int32_t sorted = -1;
+      if (fscanf(fp, "%63s %lu\ninput %1023s\nhash %lx\nnprocs %d\n"
+                     "format %d\noffset_vids %d\nsorted_adjs %d\n",
+                 magic, &version, input_name, &hash, &tasks, 
+                 &format, &offset, &sorted) == 8 &&
+          strcmp(magic, SNAPSHOT_MAGIC) == 0 &&
+          version == SNAPSHOT_VERSION && hash == input_hash &&
+          tasks == nprocs && format == input_format &&
+          offset == (int32_t)offset_vids && sorted == (int32_t)sorted_adjs)
+        valid = 1;
+      fclose(fp);
+    }
+  }
+
+  MPI_Bcast(&valid, 1, MPI_INT32_T, 0, MPI_COMM_WORLD);
+
+  return (valid == 1);
+}
+
+bool load_graph_snapshot(char* prefix, uint64_t input_hash,
+                         int32_t input_format, bool offset_vids,
+                         bool sorted_adjs,
+                         dist_graph_t* g, graph_snapshot_t* snap)
+{
+  if (debug) { printf("Task %d load_graph_snapshot() start\n", procid); }
+
+  double elt = 0.0;
+  if (verbose) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  snap->map = NULL;
+  snap->size = 0;
+  if (!read_manifest(prefix, input_hash, input_format, offset_vids, 
+                     sorted_adjs))
+  {
+    if (procid == 0)
+      printf("No matching graph snapshot at %s\n", prefix);
+    return false;
+  }
+
+  char filename[1024];
+  snprintf(filename, 1024, "%s.%d", prefix, procid);
+
+  int32_t valid = 0;
+  char* map = (char*)MAP_FAILED;
+  uint64_t map_size = 0;
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+  if (fd >= 0 && fstat(fd, &st) == 0 && 
+      (uint64_t)st.st_size >= sizeof(snapshot_header_t))
+  {
+    // Private mapping, so pages are only copied if something writes them
+    map_size = (uint64_t)st.st_size;
+    map = (char*)mmap(NULL, map_size, PROT_READ | PROT_WRITE, 
+                      MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED)
+    {
+      snapshot_header_t* header = (snapshot_header_t*)map;
+      valid = (memcmp(header->magic, SNAPSHOT_MAGIC, 8) == 0 &&
+               header->version == SNAPSHOT_VERSION &&
+               header->input_hash == input_hash &&
+               header->procid == procid && header->nprocs == nprocs &&
+               header->index_bytes == sizeof(lid_t) &&
+               header->file_size == map_size);
+    }
+  }
+  if (fd >= 0)
+    close(fd);
+
+  MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT32_T, MPI_MIN, 
+                MPI_COMM_WORLD);
+  if (!valid)
+  {
+    if (map != MAP_FAILED)
+      munmap(map, map_size);
+    if (procid == 0)
+      printf("Graph snapshot at %s is incomplete, rebuilding\n", prefix);
+    return false;
+  }
+  madvise(map, map_size, MADV_WILLNEED);
+
+  snapshot_header_t* header = (snapshot_header_t*)map;
+  void* sections[SNAP_NUM_SECTIONS];
+  for (int32_t s = 0; s < SNAP_NUM_SECTIONS; ++s)
+    sections[s] = header->section_sizes[s] > 0 ? 
+                  map + header->section_starts[s] : NULL;
+
+  g->n = header->n;
+  g->m = header->m;
+  g->m_local = header->m_local;
+  g->n_local = header->n_local;
+  g->n_offset = header->n_offset;
+  g->n_ghost = header->n_ghost;
+  g->n_total = header->n_total;
+  g->max_degree_vert = header->max_degree_vert;
+  g->max_degree = header->max_degree;
+
+  g->out_edges = (lid_t*)sections[SNAP_OUT_EDGES];
+  g->global_out_edges = NULL;
+  g->caller_edges = false;
+  g->out_degree_list = (uint64_t*)sections[SNAP_OUT_DEGREE_LIST];
+  g->ghost_degrees = (uint64_t*)sections[SNAP_GHOST_DEGREES];
+  g->local_unmap = (uint64_t*)sections[SNAP_LOCAL_UNMAP];
+  g->ghost_unmap = (uint64_t*)sections[SNAP_GHOST_UNMAP];
+  g->ghost_tasks = (uint64_t*)sections[SNAP_GHOST_TASKS];
+
+  g->map = (struct fast_map*)malloc(sizeof(struct fast_map));
+  g->map->keys = (uint64_t*)sections[SNAP_MAP_SLOT_KEYS];
+  g->map->values = (uint64_t*)sections[SNAP_MAP_SLOT_VALUES];
+  g->map->unique_keys = (uint64_t*)sections[SNAP_MAP_KEYS];
+  g->map->unique_indexes = (uint64_t*)sections[SNAP_MAP_INDEXES];
+  set_map_capacity(g->map, header->map_capacity);
+  g->map->num_unique = header->map_num_unique;
+  g->map->hashing = (header->map_hashing != 0);
+
+  g->vert_weights = (int32_t*)sections[SNAP_VERT_WEIGHTS];
+  g->edge_weights = (int32_t*)sections[SNAP_EDGE_WEIGHTS];
+  g->vert_weights_sums = (int64_t*)sections[SNAP_VERT_WEIGHTS_SUMS];
+  g->edge_weights_sum = header->edge_weights_sum;
+  g->max_vert_weights = (int32_t*)sections[SNAP_MAX_VERT_WEIGHTS];
+  g->max_edge_weight = header->max_edge_weight;
+  g->num_vert_weights = header->num_vert_weights;
+  g->num_edge_weights = header->num_edge_weights;
+
+  snap->map = map;
+  snap->size = map_size;
+
+  if (verbose) {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d load_graph_snapshot() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug) { printf("Task %d load_graph_snapshot() success\n", procid); }
+  return true;
+}
+
+int pwrite_full(int fd, const char* buf, uint64_t count, uint64_t offset)
+{
+  while (count > 0)
+  {
+    ssize_t bytes = pwrite(fd, buf, count, (off_t)offset);
+    if (bytes < 0 && errno == EINTR)
+      continue;
+    if (bytes <= 0)
+      return 1;
+
+    buf += bytes;
+    count -= (uint64_t)bytes;
+    offset += (uint64_t)bytes;
+  }
+
+  return 0;
+}
+
+int write_graph_snapshot(char* prefix, char* input_filename,
+                         uint64_t input_hash, int32_t input_format,
+                         bool offset_vids, bool sorted_adjs, 
+                         dist_graph_t* g)
+{
+  if (debug) { printf("Task %d write_graph_snapshot() start\n", procid); }
+
+  double elt = 0.0;
+  if (verbose) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    elt = omp_get_wtime();
+  }
+
+  char filename[1024];
+  snprintf(filename, 1024, "%s.manifest", prefix);
+  if (procid == 0)
+    unlink(filename);
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  snapshot_header_t header;
+  memset(&header, 0, sizeof(snapshot_header_t));
+  memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+  header.version = SNAPSHOT_VERSION;
+  header.input_hash = input_hash;
+  header.procid = procid;
+  header.nprocs = nprocs;
+  header.n = g->n;
+  header.m = g->m;
+  header.m_local = g->m_local;
+  header.n_local = g->n_local;
+  header.n_offset = g->n_offset;
+  header.n_ghost = g->n_ghost;
+  header.n_total = g->n_total;
+  header.max_degree_vert = g->max_degree_vert;
+  header.max_degree = g->max_degree;
+  header.num_vert_weights = g->num_vert_weights;
+  header.num_edge_weights = g->num_edge_weights;
+  header.edge_weights_sum = g->edge_weights_sum;
+  header.max_edge_weight = g->max_edge_weight;
+  header.map_hashing = g->map->hashing ? 1 : 0;
+  header.map_capacity = g->map->capacity;
+  header.map_num_unique = g->map->num_unique;
+  header.index_bytes = sizeof(lid_t);
+
+  uint64_t nvw = g->num_vert_weights;
+  const void* sections[SNAP_NUM_SECTIONS] = {
+    g->out_edges, g->out_degree_list, g->ghost_degrees,
+    g->local_unmap, g->ghost_unmap, g->ghost_tasks,
+    g->map->keys, g->map->values, g->map->unique_keys, g->map->unique_indexes,
+    g->vert_weights, g->edge_weights, 
+    g->vert_weights_sums, g->max_vert_weights};
+  uint64_t sizes[SNAP_NUM_SECTIONS] = {
+    g->m_local*sizeof(lid_t), (g->n_local+1)*sizeof(uint64_t), 
+    g->n_ghost*sizeof(uint64_t),
+    g->n_local*sizeof(uint64_t), g->n_ghost*sizeof(uint64_t), 
+    g->n_ghost*sizeof(uint64_t),
+    g->map->capacity*sizeof(uint64_t), g->map->capacity*sizeof(uint64_t),
+    g->map->num_unique*sizeof(uint64_t), 
+    g->map->num_unique*sizeof(uint64_t),
+    g->n_local*nvw*sizeof(int32_t), g->m_local*sizeof(int32_t),
+    nvw*sizeof(int64_t), nvw*sizeof(int32_t)};
+
+  uint64_t offset = sizeof(snapshot_header_t);
+  for (int32_t s = 0; s < SNAP_NUM_SECTIONS; ++s)
+  {
+    if (sections[s] == NULL)
+      sizes[s] = 0;
+    offset = (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+    header.section_starts[s] = sizes[s] > 0 ? offset : 0;
+    header.section_sizes[s] = sizes[s];
+    offset += sizes[s];
+  }
+  header.file_size = offset;
+
+  snprintf(filename, 1024, "%s.%d", prefix, procid);
+  int32_t failed = 0;
+  int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    failed = 1;
+  else
+  {
+    for (int32_t s = 0; s < SNAP_NUM_SECTIONS; ++s)
+      if (sizes[s] > 0 && pwrite_full(fd, (const char*)sections[s], 
+                                      sizes[s], header.section_starts[s]))
+        failed = 1;
+    if (pwrite_full(fd, (const char*)&header, 
+                    sizeof(snapshot_header_t), 0) ||
+        ftruncate(fd, (off_t)header.file_size) != 0)
+      failed = 1;
+    close(fd);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT32_T, MPI_MAX, 
+                MPI_COMM_WORLD);
+  if (failed)
+  {
+    if (procid == 0)
+      fprintf(stderr, "Warning: unable to write graph snapshot %s\n", prefix);
+    return 1;
+  }
+
+  if (procid == 0)
+  {
+    char temp_name[1024];
+    snprintf(filename, 1024, "%s.manifest", prefix);
+    snprintf(temp_name, 1024, "%s.manifest.tmp", prefix);
+    FILE* fp = fopen(temp_name, "w");
+    if (fp != NULL)
+    {
+      fprintf(fp, "%s %d\n", SNAPSHOT_MAGIC, SNAPSHOT_VERSION);
+      fprintf(fp, "input %s\n", input_filename);
+      fprintf(fp, "hash %lx\n", input_hash);
+      fprintf(fp, "nprocs %d\n", nprocs);
+      fprintf(fp, "format %d\n", input_format);
+      fprintf(fp, "offset_vids %d\n", offset_vids ? 1 : 0);
+      fprintf(fp, "sorted_adjs %d\n", sorted_adjs ? 1 : 0);
+      fclose(fp);
+      rename(temp_name, filename);
+    }
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (verbose) {
+    elt = omp_get_wtime() - elt;
+    printf("Task %d write_graph_snapshot() %9.6f (s)\n", procid, elt);
+  }
+
+  if (debug) { printf("Task %d write_graph_snapshot() success\n", procid); }
+  return 0;
+}
+
+int clear_graph_snapshot(dist_graph_t* g, graph_snapshot_t* snap)
+{
+  if (snap->map != NULL)
+    munmap(snap->map, snap->size);
+  free(g->map);
+
+  snap->map = NULL;
+  snap->size = 0;
+
+  return 0;
+}
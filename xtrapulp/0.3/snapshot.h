@@ -0,0 +1,136 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//  XtraPuLP: Xtreme-Scale Graph Partitioning using Label Propagation
+//              Copyright (2016) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions?  Contact  George M. Slota   (gmslota@sandia.gov)
+//                      Siva Rajamanickam (srajama@sandia.gov)
+//                      Kamesh Madduri    (madduri@cse.psu.edu)
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include "xtrapulp.h"
+#include "dist_graph.h"
+
+// A snapshot is one binary file per task, <prefix>.<procid>, holding the
+// built dist_graph_t, plus <prefix>.manifest naming the input file hash,
+// format, and task count it was built for. The manifest is written last,
+// so a snapshot without one is never trusted.
+#define SNAPSHOT_MAGIC "XPSNAP1"
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_ALIGN 64
+#define SNAPSHOT_HASH_CHUNK 16777216
+
+#define SNAP_OUT_EDGES          0
+#define SNAP_OUT_DEGREE_LIST    1
+#define SNAP_GHOST_DEGREES      2
+#define SNAP_LOCAL_UNMAP        3
+#define SNAP_GHOST_UNMAP        4
+#define SNAP_GHOST_TASKS        5
+#define SNAP_MAP_SLOT_KEYS      6
+#define SNAP_MAP_SLOT_VALUES    7
+#define SNAP_MAP_KEYS           8
+#define SNAP_MAP_INDEXES        9
+#define SNAP_VERT_WEIGHTS       10
+#define SNAP_EDGE_WEIGHTS       11
+#define SNAP_VERT_WEIGHTS_SUMS  12
+#define SNAP_MAX_VERT_WEIGHTS   13
+#define SNAP_NUM_SECTIONS       14
+
+// Input formats recorded in the manifest
+#define INPUT_FORMAT_ADJ        0
+#define INPUT_FORMAT_CSR        1
+#define INPUT_FORMAT_EDGE_LIST  2
+#define INPUT_FORMAT_EDGE_TEXT  3
+
+struct snapshot_header_t {
+  char magic[8];
+  uint64_t version;
+  uint64_t input_hash;
+  int32_t procid;
+  int32_t nprocs;
+
+  uint64_t n;
+  uint64_t m;
+  uint64_t m_local;
+  uint64_t n_local;
+  uint64_t n_offset;
+  uint64_t n_ghost;
+  uint64_t n_total;
+  uint64_t max_degree_vert;
+  uint64_t max_degree;
+
+  uint64_t num_vert_weights;
+  uint64_t num_edge_weights;
+  int64_t  edge_weights_sum;
+  int32_t  max_edge_weight;
+  int32_t  map_hashing;
+  uint64_t map_capacity;
+  uint64_t map_num_unique;
+  uint64_t index_bytes;
+
+  uint64_t section_starts[SNAP_NUM_SECTIONS];
+  uint64_t section_sizes[SNAP_NUM_SECTIONS];
+  uint64_t file_size;
+};
+
+// Keeps the mapping alive for a graph loaded from a snapshot
+struct graph_snapshot_t {
+  char* map;
+  uint64_t size;
+};
+
+uint64_t hash_input_file(char* input_filename);
+
+bool load_graph_snapshot(char* prefix, uint64_t input_hash,
+                         int32_t input_format, bool offset_vids,
+                         bool sorted_adjs,
+                         dist_graph_t* g, graph_snapshot_t* snap);
+
+int write_graph_snapshot(char* prefix, char* input_filename,
+                         uint64_t input_hash, int32_t input_format,
+                         bool offset_vids, bool sorted_adjs, 
+                         dist_graph_t* g);
+
+int clear_graph_snapshot(dist_graph_t* g, graph_snapshot_t* snap);
+
+#endif
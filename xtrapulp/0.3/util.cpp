@@ -114,35 +114,6 @@ void quicksort_dec(double* arr1, uint64_t* arr2, int64_t left, int64_t right)
 }
 
 
-void quicksort_inc(uint64_t* arr1, int64_t left, int64_t right) 
-{
-  int64_t i = left;
-  int64_t j = right;
-  int64_t temp; 
-  uint64_t pivot = arr1[(left + right) / 2];
-
-  while (i <= j) 
-  {
-    while (arr1[i] < pivot) {i++;}
-    while (arr1[j] > pivot) {j--;}
-  
-    if (i <= j) 
-    {
-      temp = arr1[i];
-      arr1[i] = arr1[j];
-      arr1[j] = temp;
-      ++i;
-      --j;
-    }
-  }
-
-  if (j > left)
-    quicksort_inc(arr1, left, j);
-  if (i < right)
-    quicksort_inc(arr1, i, right);
-}
-
-
 uint64_t xs1024star_next(xs1024star_t* xs) 
 {
    const uint64_t s0 = xs->s[xs->p];
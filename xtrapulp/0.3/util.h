@@ -55,7 +55,70 @@ void throw_err(char const* err_message, int32_t task);
 void throw_err(char const* err_message, int32_t task, int32_t thread);
 
 void quicksort_dec(double* arr1, uint64_t* arr2, int64_t left, int64_t right);
-void quicksort_inc(uint64_t* arr1, int64_t left, int64_t right);
+
+// Sorts on the index type of the caller, so defined here
+template <typename T>
+void quicksort_inc(T* arr1, int64_t left, int64_t right) 
+{
+  int64_t i = left;
+  int64_t j = right;
+  T temp; 
+  T pivot = arr1[(left + right) / 2];
+
+  while (i <= j) 
+  {
+    while (arr1[i] < pivot) {i++;}
+    while (arr1[j] > pivot) {j--;}
+  
+    if (i <= j) 
+    {
+      temp = arr1[i];
+      arr1[i] = arr1[j];
+      arr1[j] = temp;
+      ++i;
+      --j;
+    }
+  }
+
+  if (j > left)
+    quicksort_inc(arr1, left, j);
+  if (i < right)
+    quicksort_inc(arr1, i, right);
+}
+
+
+template <typename T>
+void quicksort_inc(T* arr1, int32_t* arr2, int64_t left, int64_t right) 
+{
+  int64_t i = left;
+  int64_t j = right;
+  T temp; int32_t temp2;
+  T pivot = arr1[(left + right) / 2];
+
+  while (i <= j) 
+  {
+    while (arr1[i] < pivot) {i++;}
+    while (arr1[j] > pivot) {j--;}
+  
+    if (i <= j) 
+    {
+      temp = arr1[i];
+      arr1[i] = arr1[j];
+      arr1[j] = temp;
+      temp2 = arr2[i];
+      arr2[i] = arr2[j];
+      arr2[j] = temp2;
+      ++i;
+      --j;
+    }
+  }
+
+  if (j > left)
+    quicksort_inc(arr1, arr2, left, j);
+  if (i < right)
+    quicksort_inc(arr1, arr2, i, right);
+}
+
 
 struct xs1024star_t {
   uint64_t s[16];
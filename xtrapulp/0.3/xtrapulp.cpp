@@ -71,6 +71,19 @@ int64_t batch_size = 1000;
 int64_t train_wid = 0;
 float X, Y;
 
+// Same defaults as the command line: 10% vertex imbalance, BFS init,
+// cut-only refinement, and the default exchange
+extern "C" void init_pulp_part_control(pulp_part_control_t *ppc)
+{
+  memset(ppc, 0, sizeof(pulp_part_control_t));
+  ppc->vert_balance = 1.1;
+  ppc->edge_balance = 1.1;
+  ppc->constraints = NULL;
+  ppc->num_weights = 0;
+  ppc->do_bfs_init = true;
+  ppc->pulp_seed = rand();
+}
+
 extern "C" int xtrapulp_run(
     dist_graph_t *g, pulp_part_control_t *ppc,
     int *parts, int num_parts)
@@ -123,6 +136,23 @@ extern "C" int xtrapulp(dist_graph_t *g, pulp_part_control_t *ppc,
   int num_parts = (int)pulp->num_parts;
   seed = ppc->pulp_seed;
 
+  // Builds the ghost exchange plan the first time through
+  init_neighbor_comm(g, comm);
+  if (ppc->do_overlap_comm)
+    init_sweep_order(g, comm);
+  comm->overlap = ppc->do_overlap_comm;
+  if (ppc->do_node_exchange)
+    init_node_comm(g, comm);
+  comm->node_exchange = ppc->do_node_exchange;
+  if (ppc->do_rma_exchange)
+    init_rma_comm(g, comm);
+  comm->rma_exchange = ppc->do_rma_exchange;
+  set_label_wire_format(comm, num_parts);
+
+  // Exchange and per-thread buffers are reused until the call returns
+  init_comm_pools();
+  init_thread_pulp_pool(num_parts, g->num_vert_weights);
+
   Y = 0.25;
   X = 1.0;
   // Tighten up allowable exchange for small graphs,
@@ -234,6 +264,11 @@ extern "C" int xtrapulp(dist_graph_t *g, pulp_part_control_t *ppc,
   if (procid == 0 && verbose)
     printf("Partitioning finished: %9.6lf(s)\n", elt);
 
+  // Only part labels are narrowed
+  comm->wire_data_bytes = 4;
+  clear_comm_pools(comm);
+  clear_thread_pulp_pool();
+
   return 0;
 }
 
@@ -253,6 +288,26 @@ extern "C" int xtrapulp_weighted(
   int num_parts = (int)pulp->num_parts;
   seed = ppc->pulp_seed;
 
+  // Builds the ghost exchange plan the first time through
+  init_neighbor_comm(g, comm);
+  if (ppc->do_overlap_comm)
+    init_sweep_order(g, comm);
+  comm->overlap = ppc->do_overlap_comm;
+  if (ppc->do_node_exchange)
+    init_node_comm(g, comm);
+  comm->node_exchange = ppc->do_node_exchange;
+  if (ppc->do_rma_exchange)
+    init_rma_comm(g, comm);
+  comm->rma_exchange = ppc->do_rma_exchange;
+  if (ppc->do_sparse_part_sizes)
+    init_sparse_part_sizes(g, pulp);
+  pulp->sparse_sizes = ppc->do_sparse_part_sizes;
+  set_label_wire_format(comm, num_parts);
+
+  // Exchange and per-thread buffers are reused until the call returns
+  init_comm_pools();
+  init_thread_pulp_pool(num_parts, g->num_vert_weights);
+
   // Y = 0.25;
   // X = 1.0;
   X = 1.25;
@@ -325,6 +380,11 @@ extern "C" int xtrapulp_weighted(
   if (procid == 0 && verbose)
     printf("Partitioning finished: %9.6lf(s)\n", elt);
 
+  // Only part labels are narrowed
+  comm->wire_data_bytes = 4;
+  clear_comm_pools(comm);
+  clear_thread_pulp_pool();
+
   return 0;
 }
 
@@ -339,6 +399,7 @@ extern "C" int create_xtrapulp_dist_graph(
   MPI_Comm_rank(MPI_COMM_WORLD, &procid);
   MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
 
+  g->caller_edges = true;
   if (nprocs > 1)
   {
     create_graph(
@@ -50,11 +50,23 @@
 //typedef int64_t pulp_int;
 //typedef double pulp_real;
 
+// Local vertex indexes in the adjacency and queues. Built with
+// -DLOCAL_INDEX_32 they take half the space, for tasks with fewer than
+// 2^32 local plus ghost vertices. Edge offsets stay 64 bits either way.
+#ifdef LOCAL_INDEX_32
+typedef uint32_t lid_t;
+#else
+typedef uint64_t lid_t;
+#endif
+
 struct mpi_data_t;
 struct pulp_data_t;
 struct queue_data_t;
 struct fast_map;
 
+// Callers filling this in themselves should start from
+// init_pulp_part_control() or a zeroed struct. The exchange mode flags at
+// the end were added later, and garbage there would switch modes on.
 typedef struct {
   double vert_balance;
   double edge_balance;
@@ -70,6 +82,11 @@ typedef struct {
   bool verbose_output;
 
   int pulp_seed;
+
+  bool do_overlap_comm;
+  bool do_node_exchange;
+  bool do_rma_exchange;
+  bool do_sparse_part_sizes;
 } pulp_part_control_t;
 
 
@@ -86,10 +103,15 @@ struct dist_graph_t {
   uint64_t max_degree_vert;
   uint64_t max_degree;
 
-  uint64_t* out_edges;
+  lid_t* out_edges;
   uint64_t* out_degree_list;
   uint64_t* ghost_degrees;
 
+  // Adjacency by global id, from construction until relabel_edges()
+  uint64_t* global_out_edges;
+  // Adjacency came from the caller, see set_local_edges()
+  bool caller_edges;
+
   uint64_t* local_unmap;
   uint64_t* ghost_unmap;
   uint64_t* ghost_tasks;
@@ -110,6 +132,8 @@ struct dist_graph_t {
 #define out_weights(g, n) &g->edge_weights[g->out_degree_list[n]]
 
 
+extern "C" void init_pulp_part_control(pulp_part_control_t* ppc);
+
 extern "C" int xtrapulp_run(
   dist_graph_t* g, pulp_part_control_t* ppc, 
   int* parts, int num_parts);